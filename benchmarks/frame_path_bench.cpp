@@ -0,0 +1,226 @@
+/*
+file: benchmarks/frame_path_bench.cpp
+date: 2026/10/16
+*/
+#include <benchmark/benchmark.h>
+#include <SFML/Graphics/Texture.hpp>
+#include <json/json.h>
+#include <arpa/inet.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "core/network/server_registry.h"
+#include "core/video/video_frame.h"
+#include "gui/frame_handoff.h"
+#include "gui/texture_uploader.h"
+#include "utils/frame_queue.h"
+
+// 帧热路径：回调交付 -> 布局校验 -> 队列交接 -> 纹理上传，以及服务器发现的解析与去重
+// 各基准的参数固定，输出可用Google Benchmark的tools/compare.py在不同提交间对比
+
+namespace {
+
+// 与界面的帧队列容量相同
+constexpr size_t FRAME_QUEUE_CAPACITY = 8;
+
+// 解码输出的RGBA帧（GstBuffer，与appsink交付的内存布局一致）
+class RgbaBuffer {
+public:
+    RgbaBuffer(int width, int height, GstVideoFormat format = GST_VIDEO_FORMAT_RGBA) {
+        gst_init(nullptr, nullptr);
+        gst_video_info_set_format(&info_, format, width, height);
+        buffer_ = gst_buffer_new_allocate(nullptr, GST_VIDEO_INFO_SIZE(&info_), nullptr);
+        gst_buffer_memset(buffer_, 0, 0x80, GST_VIDEO_INFO_SIZE(&info_));
+    }
+    ~RgbaBuffer() { gst_buffer_unref(buffer_); }
+
+    RgbaBuffer(const RgbaBuffer&) = delete;
+    RgbaBuffer& operator=(const RgbaBuffer&) = delete;
+
+    VideoFrame frame() const { return VideoFrame::fromBuffer(buffer_, info_); }
+    size_t size() const { return GST_VIDEO_INFO_SIZE(&info_); }
+
+private:
+    GstVideoInfo info_;
+    GstBuffer* buffer_ = nullptr;
+};
+
+// 帧回调：映射buffer后只移动VideoFrame（像素在纹理上传时才拷贝）
+void BM_FrameCallbackMove(benchmark::State& state) {
+    RgbaBuffer source(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    for (auto _ : state) {
+        VideoFrame frame = source.frame();
+        VideoFrame delivered(std::move(frame));
+        benchmark::DoNotOptimize(delivered.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// pushVideoFrame中的RGBA布局校验（参数2为1时帧为RGB格式，校验失败）
+void BM_RgbaValidation(benchmark::State& state) {
+    const int width = static_cast<int>(state.range(0));
+    const int height = static_cast<int>(state.range(1));
+    RgbaBuffer source(width, height, state.range(2) ? GST_VIDEO_FORMAT_RGB : GST_VIDEO_FORMAT_RGBA);
+    VideoFrame frame = source.frame();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(frame.isPackedRgba());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// pushVideoFrame/updateStreamFrame的交接（handOffFrame/takeFrame）：
+// 每次迭代每路交付一帧，UI侧按路取出（参数为路数，单线程，只计交接本身的开销）
+void BM_PushUpdateHandoff(benchmark::State& state) {
+    const int streams = static_cast<int>(state.range(0));
+    RgbaBuffer source(640, 360);
+    std::vector<std::unique_ptr<FrameQueue<VideoFrame>>> queues;
+    for (int i = 0; i < streams; ++i) {
+        queues.push_back(std::make_unique<FrameQueue<VideoFrame>>(FRAME_QUEUE_CAPACITY));
+    }
+
+    uint64_t skipped = 0;
+    for (auto _ : state) {
+        for (int i = 0; i < streams; ++i) {
+            handOffFrame(*queues[i], source.frame());
+        }
+        for (int i = 0; i < streams; ++i) {
+            if (VideoFrame* frame = takeFrame(*queues[i], PresentMode::Mailbox, &skipped)) {
+                benchmark::DoNotOptimize(frame->data());
+                queues[i]->popFront();
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * streams);
+    state.counters["skipped"] = static_cast<double>(skipped);
+}
+
+// 跨线程交接：一个视频线程持续交付，计时循环内UI线程取帧（队列满时视频线程让出CPU）
+void BM_PushUpdateHandoffThreaded(benchmark::State& state) {
+    RgbaBuffer source(640, 360);
+    FrameQueue<VideoFrame> queue(FRAME_QUEUE_CAPACITY);
+    std::atomic<bool> running{true};
+    std::atomic<uint64_t> full{0};
+    std::thread producer([&]() {
+        while (running.load(std::memory_order_relaxed)) {
+            if (handOffFrame(queue, source.frame()) == HandoffResult::QueueFull) {
+                full.fetch_add(1, std::memory_order_relaxed);
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint64_t skipped = 0;
+    for (auto _ : state) {
+        VideoFrame* frame = nullptr;
+        while (!(frame = takeFrame(queue, PresentMode::Fifo, &skipped))) {
+        }
+        benchmark::DoNotOptimize(frame->data());
+        queue.popFront();
+    }
+
+    running.store(false);
+    producer.join();
+    state.SetItemsProcessed(state.iterations());
+    state.counters["queue_full"] = static_cast<double>(full.load());
+}
+
+// 发现消息（与服务器广播的格式相同）
+std::vector<std::string> discoveryMessages(int servers) {
+    std::vector<std::string> messages;
+    for (int i = 0; i < servers; ++i) {
+        Json::Value info;
+        info["name"] = "camera-server-" + std::to_string(i);
+        info["heartbeat_port"] = 8000 + i % 4;
+        info["cameras"] = 4;
+        messages.push_back(Json::FastWriter().write(info));
+    }
+    return messages;
+}
+
+// startDiscovery中每个数据报的处理（ServerRegistry::observeDatagram：解析JSON、哈希索引去重，重复广播不产生回调）
+// 参数为局域网中的服务器数量；每台服务器按周期重复广播，计时循环内处理一轮全部广播
+void BM_DiscoveryRegistry(benchmark::State& state) {
+    const int servers = static_cast<int>(state.range(0));
+    const std::vector<std::string> messages = discoveryMessages(servers);
+    std::vector<uint32_t> addresses(servers);
+    for (int i = 0; i < servers; ++i) {
+        addresses[i] = htonl(0xC0A80000u + static_cast<uint32_t>(i / 4) + 1);
+    }
+
+    ServerRegistry registry;
+    uint64_t deltas = 0;
+    registry.setDeltaCallback([&](const ServerRegistryDelta&) { deltas++; });
+    for (auto _ : state) {
+        for (int i = 0; i < servers; ++i) {
+            registry.observeDatagram(addresses[i], messages[i].data(), messages[i].size());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * servers);
+    state.counters["deltas"] = static_cast<double>(deltas);
+}
+
+// UI线程的纹理上传（sf::Texture::update，需要图形环境；没有时跳过）
+void BM_TextureUpdate(benchmark::State& state) {
+    const unsigned int width = static_cast<unsigned int>(state.range(0));
+    const unsigned int height = static_cast<unsigned int>(state.range(1));
+    sf::Texture texture;
+    if (!texture.create(width, height)) {
+        state.SkipWithError("无法创建纹理（没有可用的OpenGL上下文）");
+        return;
+    }
+    std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4, 0x80);
+    for (auto _ : state) {
+        texture.update(pixels.data(), width, height, 0, 0);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(pixels.size()));
+}
+
+// 经PBO轮流上传（参数2为PBO数量）；图形环境不支持PBO时跳过
+void BM_TextureUploadPbo(benchmark::State& state) {
+    const unsigned int width = static_cast<unsigned int>(state.range(0));
+    const unsigned int height = static_cast<unsigned int>(state.range(1));
+    sf::Texture texture;
+    if (!texture.create(width, height)) {
+        state.SkipWithError("无法创建纹理（没有可用的OpenGL上下文）");
+        return;
+    }
+    TextureUploader uploader(static_cast<unsigned int>(state.range(2)));
+    if (!uploader.init()) {
+        state.SkipWithError("不支持PBO");
+        return;
+    }
+    std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4, 0x80);
+    for (auto _ : state) {
+        uploader.upload(texture, pixels.data(), width, height);
+        uploader.flush();  // 与界面相同，每次呈现提交一次
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(pixels.size()));
+    state.counters["avg_upload_ms"] = uploader.stats().average_upload_ms;
+}
+
+void PboArgs(benchmark::internal::Benchmark* b) {
+    for (int buffers : {2, 3}) {
+        b->Args({1280, 720, buffers});
+        b->Args({1920, 1080, buffers});
+        b->Args({3840, 2160, buffers});
+    }
+}
+
+void ResolutionArgs(benchmark::internal::Benchmark* b) {
+    b->Args({640, 480});
+    b->Args({1280, 720});
+    b->Args({1920, 1080});
+    b->Args({3840, 2160});
+}
+
+} // namespace
+
+BENCHMARK(BM_FrameCallbackMove)->Apply(ResolutionArgs);
+BENCHMARK(BM_RgbaValidation)->Args({1920, 1080, 0})->Args({1920, 1080, 1});
+BENCHMARK(BM_PushUpdateHandoff)->Arg(1)->Arg(4)->Arg(9)->Arg(16);
+BENCHMARK(BM_PushUpdateHandoffThreaded)->UseRealTime();
+BENCHMARK(BM_DiscoveryRegistry)->Arg(4)->Arg(32)->Arg(256);
+BENCHMARK(BM_TextureUpdate)->Apply(ResolutionArgs)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_TextureUploadPbo)->Apply(PboArgs)->Unit(benchmark::kMicrosecond);
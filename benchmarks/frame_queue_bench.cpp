@@ -0,0 +1,93 @@
+/*
+file: benchmarks/frame_queue_bench.cpp
+date: 2026/10/16
+*/
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "utils/frame_queue.h"
+
+namespace {
+
+// 模拟帧对象：只携带一个句柄，与VideoFrame一样只移动不拷贝
+struct BenchFrame {
+    std::unique_ptr<uint64_t> handle;
+};
+
+// 原有路径：std::deque + std::mutex，容量上限10
+struct MutexDeque {
+    std::deque<BenchFrame> frames;
+    std::mutex mtx;
+
+    bool tryPush(BenchFrame&& f) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (frames.size() >= 10) return false;
+        frames.push_back(std::move(f));
+        return true;
+    }
+    bool tryPop(BenchFrame& out) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (frames.empty()) return false;
+        out = std::move(frames.front());
+        frames.pop_front();
+        return true;
+    }
+};
+
+struct SpscRing {
+    FrameQueue<BenchFrame> queue{8};
+
+    bool tryPush(BenchFrame&& f) { return queue.tryPush(std::move(f)); }
+    bool tryPop(BenchFrame& out) { return queue.tryPop(out); }
+};
+
+// 生产者线程持续推送，计时循环内消费者逐帧取出（解码线程 -> UI线程交接）
+template <typename Queue>
+void BM_FrameHandoff(benchmark::State& state) {
+    Queue queue;
+    std::atomic<bool> running{true};
+    std::thread producer([&]() {
+        uint64_t seq = 0;
+        BenchFrame frame;
+        while (running.load(std::memory_order_relaxed)) {
+            if (!frame.handle) frame.handle = std::make_unique<uint64_t>(seq++);
+            if (!queue.tryPush(std::move(frame))) std::this_thread::yield();
+        }
+    });
+
+    BenchFrame out;
+    for (auto _ : state) {
+        while (!queue.tryPop(out)) {
+            std::this_thread::yield();
+        }
+        benchmark::DoNotOptimize(out.handle);
+    }
+
+    running.store(false);
+    producer.join();
+    state.SetItemsProcessed(state.iterations());
+}
+
+// 无竞争时单线程push+pop的固定开销
+template <typename Queue>
+void BM_PushPopUncontended(benchmark::State& state) {
+    Queue queue;
+    BenchFrame frame{std::make_unique<uint64_t>(0)};
+    for (auto _ : state) {
+        queue.tryPush(std::move(frame));
+        queue.tryPop(frame);
+        benchmark::DoNotOptimize(frame.handle);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_FrameHandoff, MutexDeque)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_FrameHandoff, SpscRing)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_PushPopUncontended, MutexDeque);
+BENCHMARK_TEMPLATE(BM_PushPopUncontended, SpscRing);
@@ -0,0 +1,159 @@
+/*
+file: benchmarks/loss_recovery_bench.cpp
+date: 2026/10/16
+*/
+#include <benchmark/benchmark.h>
+#include <gst/gst.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include "core/video/gst_video_receiver.h"
+
+namespace {
+
+constexpr int CLIENT_PORT = 17000;        // RTP；RTCP为+1
+constexpr int SENDER_RTCP_PORT = 17100;   // 发送端接收NACK的端口
+constexpr auto RUN_TIME = std::chrono::seconds(6);
+constexpr auto RECOVERY_RUN_TIME = std::chrono::seconds(20);   // 覆盖两个自然关键帧间隔
+
+// 本地发送端：x264编码 -> RTP打包 -> rtprtxsend（缓存已发包，响应rtpbin上传的重传请求）
+// -> rtpbin（处理客户端的RTCP/NACK）-> identity按概率丢包 -> 回环
+// 关键帧间隔10秒，未恢复的丢包会一直影响到下一个IDR
+GstElement* createSender(double drop_probability) {
+    const std::string desc =
+        "rtpbin name=rtpbin rtp-profile=avpf "
+        "videotestsrc is-live=true pattern=ball ! video/x-raw,width=640,height=360,framerate=30/1 ! "
+        "x264enc tune=zerolatency speed-preset=ultrafast key-int-max=300 bitrate=2000 ! "
+        "rtph264pay pt=96 mtu=1200 config-interval=1 ! "
+        "rtprtxsend payload-type-map=\"application/x-rtp-pt-map,96=(uint)97\" max-size-time=1000 ! "
+        "rtpbin.send_rtp_sink_0 "
+        "rtpbin.send_rtp_src_0 ! identity drop-probability=" + std::to_string(drop_probability) + " ! "
+        "udpsink host=127.0.0.1 port=" + std::to_string(CLIENT_PORT) + " sync=false async=false "
+        "rtpbin.send_rtcp_src_0 ! udpsink host=127.0.0.1 port=" + std::to_string(CLIENT_PORT + 1) +
+        " sync=false async=false "
+        "udpsrc port=" + std::to_string(SENDER_RTCP_PORT) + " caps=application/x-rtcp ! rtpbin.recv_rtcp_sink_0";
+    GError* error = nullptr;
+    GstElement* pipeline = gst_parse_launch(desc.c_str(), &error);
+    if (error) {
+        g_error_free(error);
+        if (pipeline) gst_object_unref(pipeline);
+        return nullptr;
+    }
+    return pipeline;
+}
+
+// 参数：丢包率（千分比）、是否启用NACK重传
+// 报告接收端的重传请求、收到的重传包、恢复与未恢复的包数，以及实际交付帧率
+void BM_LossRecovery(benchmark::State& state) {
+    const double drop_probability = state.range(0) / 1000.0;
+    const bool retransmission = state.range(1) != 0;
+    gst_init(nullptr, nullptr);
+
+    ReceiverMetrics metrics;
+    double fps = 0.0;
+
+    for (auto _ : state) {
+        VideoPipelineConfig config;
+        config.latency_profile = LatencyProfile::Fixed;
+        config.jitter_latency_ms = 200;   // 留出一次往返的重传时间
+        config.retransmission = retransmission;
+        config.rtcp_host = "127.0.0.1";
+        config.rtcp_port = SENDER_RTCP_PORT;
+
+        std::atomic<uint64_t> frames{0};
+        GstVideoReceiver receiver;
+        receiver.setFrameCallback([&frames](VideoFrame&&) {
+            frames.fetch_add(1, std::memory_order_relaxed);
+        });
+        if (!receiver.initialize(CLIENT_PORT, config)) {
+            state.SkipWithError("无法创建接收管道");
+            return;
+        }
+        GstElement* sender = createSender(drop_probability);
+        if (!sender) {
+            state.SkipWithError("无法创建发送管道（需要x264enc与rtprtxsend）");
+            return;
+        }
+
+        receiver.start();
+        gst_element_set_state(sender, GST_STATE_PLAYING);
+        std::this_thread::sleep_for(RUN_TIME);
+        gst_element_set_state(sender, GST_STATE_NULL);
+        gst_object_unref(sender);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1100));  // 等待接收端下一次指标更新
+        metrics = receiver.getMetrics();
+        fps = frames.load() / std::chrono::duration<double>(RUN_TIME).count();
+        receiver.stop();
+    }
+
+    const double total = static_cast<double>(metrics.packets_received + metrics.packets_unrecovered);
+    state.counters["rtx_requests"] = static_cast<double>(metrics.rtx_requests);
+    state.counters["retransmitted"] = static_cast<double>(metrics.packets_retransmitted);
+    state.counters["recovered"] = static_cast<double>(metrics.packets_recovered);
+    state.counters["unrecovered"] = static_cast<double>(metrics.packets_unrecovered);
+    state.counters["unrecovered_percent"] = total > 0 ? 100.0 * metrics.packets_unrecovered / total : 0.0;
+    state.counters["fps"] = fps;
+}
+
+// 参数：是否请求关键帧
+// 1%丢包、不重传，每次丢包都使画面受损；不请求时要等发送端10秒一次的自然关键帧，
+// 请求时发送端rtpbin把PLI转为x264enc的强制关键帧。报告受损到恢复时间的分位数。
+void BM_KeyframeRecovery(benchmark::State& state) {
+    const bool request_keyframes = state.range(0) != 0;
+    gst_init(nullptr, nullptr);
+
+    KeyframeStats stats;
+    double p50_ms = 0.0, p99_ms = 0.0, max_ms = 0.0;
+
+    for (auto _ : state) {
+        VideoPipelineConfig config;
+        config.latency_profile = LatencyProfile::Fixed;
+        config.retransmission = false;
+        config.request_keyframes = request_keyframes;
+        config.rtcp_host = "127.0.0.1";
+        config.rtcp_port = SENDER_RTCP_PORT;
+
+        GstVideoReceiver receiver;
+        receiver.setFrameCallback([](VideoFrame&&) {});
+        if (!receiver.initialize(CLIENT_PORT, config)) {
+            state.SkipWithError("无法创建接收管道");
+            return;
+        }
+        GstElement* sender = createSender(0.01);
+        if (!sender) {
+            state.SkipWithError("无法创建发送管道（需要x264enc与rtprtxsend）");
+            return;
+        }
+
+        receiver.start();
+        gst_element_set_state(sender, GST_STATE_PLAYING);
+        std::this_thread::sleep_for(RECOVERY_RUN_TIME);
+        gst_element_set_state(sender, GST_STATE_NULL);
+        gst_object_unref(sender);
+
+        stats = receiver.getKeyframeStats();
+        const LatencyHistogram& histogram = receiver.getRecoveryHistogram();
+        p50_ms = histogram.percentile(0.50) / 1000.0;
+        p99_ms = histogram.percentile(0.99) / 1000.0;
+        max_ms = histogram.max() / 1000.0;
+        receiver.stop();
+    }
+
+    state.counters["requests"] = static_cast<double>(stats.requests);
+    state.counters["recoveries"] = static_cast<double>(stats.recoveries);
+    state.counters["recovery_p50_ms"] = p50_ms;
+    state.counters["recovery_p99_ms"] = p99_ms;
+    state.counters["recovery_max_ms"] = max_ms;
+}
+
+} // namespace
+
+BENCHMARK(BM_LossRecovery)
+    ->ArgsProduct({{0, 10, 50}, {0, 1}})
+    ->Iterations(1)->UseRealTime()->Unit(benchmark::kSecond);
+
+BENCHMARK(BM_KeyframeRecovery)
+    ->Arg(0)->Arg(1)
+    ->Iterations(1)->UseRealTime()->Unit(benchmark::kSecond);
@@ -0,0 +1,254 @@
+/*
+file: benchmarks/multi_stream_bench.cpp
+date: 2026/10/16
+*/
+#include <benchmark/benchmark.h>
+#include <gst/gst.h>
+#include <gst/app/gstappsink.h>
+#include <gst/app/gstappsrc.h>
+#include <sys/resource.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "core/video/gst_video_receiver.h"
+#include "utils/grid_layout.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// 每路码流参数：预先编码的片段循环发送（片段长度为关键帧间隔的整数倍）
+constexpr int STREAM_WIDTH = 640;
+constexpr int STREAM_HEIGHT = 360;
+constexpr int STREAM_FPS = 30;
+constexpr int CLIP_FRAMES = 150;
+constexpr int WARMUP_FRAMES = STREAM_FPS * 2;
+constexpr int MEASURE_FRAMES = STREAM_FPS * 5;
+constexpr GstClockTime FRAME_DURATION = GST_SECOND / STREAM_FPS;
+constexpr int BASE_PORT = 15000;
+
+// 与界面相同的显示区域，多路时按网格单元格约束
+constexpr int VIDEO_AREA_WIDTH = 860;
+constexpr int VIDEO_AREA_HEIGHT = 580;
+
+// 预先编码的H.264片段：发送端只做打包，测得的CPU几乎全部来自接收端
+struct Clip {
+    std::vector<GstBuffer*> frames;
+    GstCaps* caps = nullptr;
+
+    Clip() {
+        const std::string desc =
+            "videotestsrc num-buffers=" + std::to_string(CLIP_FRAMES) + " pattern=ball ! "
+            "video/x-raw,format=I420,width=" + std::to_string(STREAM_WIDTH) +
+            ",height=" + std::to_string(STREAM_HEIGHT) +
+            ",framerate=" + std::to_string(STREAM_FPS) + "/1 ! "
+            "x264enc tune=zerolatency speed-preset=ultrafast key-int-max=30 ! "
+            "h264parse ! video/x-h264,stream-format=byte-stream,alignment=au ! "
+            "appsink name=sink sync=false";
+
+        GError* error = nullptr;
+        GstElement* pipeline = gst_parse_launch(desc.c_str(), &error);
+        if (!pipeline || error) {
+            if (error) g_error_free(error);
+            if (pipeline) gst_object_unref(pipeline);
+            return;
+        }
+        GstElement* sink = gst_bin_get_by_name(GST_BIN(pipeline), "sink");
+        gst_element_set_state(pipeline, GST_STATE_PLAYING);
+        while (GstSample* sample = gst_app_sink_try_pull_sample(GST_APP_SINK(sink), 10 * GST_SECOND)) {
+            if (!caps) caps = gst_caps_ref(gst_sample_get_caps(sample));
+            frames.push_back(gst_buffer_ref(gst_sample_get_buffer(sample)));
+            gst_sample_unref(sample);
+        }
+        gst_element_set_state(pipeline, GST_STATE_NULL);
+        gst_object_unref(sink);
+        gst_object_unref(pipeline);
+    }
+
+    ~Clip() {
+        for (GstBuffer* buffer : frames) gst_buffer_unref(buffer);
+        if (caps) gst_caps_unref(caps);
+    }
+};
+
+// 单路发送端：appsrc ! h264parse ! rtph264pay ! udpsink，记录每帧的发送时刻
+struct Sender {
+    GstElement* pipeline = nullptr;
+    GstElement* src = nullptr;
+    std::unique_ptr<std::atomic<int64_t>[]> send_ns{new std::atomic<int64_t>[WARMUP_FRAMES + MEASURE_FRAMES]()};
+
+    Sender(int port, GstCaps* caps) {
+        const std::string desc =
+            "appsrc name=src is-live=true format=time ! h264parse ! "
+            "rtph264pay config-interval=1 pt=96 ! "
+            "udpsink host=127.0.0.1 port=" + std::to_string(port) + " sync=false async=false";
+        pipeline = gst_parse_launch(desc.c_str(), nullptr);
+        if (!pipeline) return;
+        src = gst_bin_get_by_name(GST_BIN(pipeline), "src");
+        gst_app_src_set_caps(GST_APP_SRC(src), caps);
+        gst_element_set_state(pipeline, GST_STATE_PLAYING);
+    }
+
+    ~Sender() {
+        if (!pipeline) return;
+        gst_element_set_state(pipeline, GST_STATE_NULL);
+        gst_object_unref(src);
+        gst_object_unref(pipeline);
+    }
+
+    void push(int index, GstBuffer* encoded) {
+        GstBuffer* buffer = gst_buffer_copy(encoded);  // 共享内存，只复制元数据
+        GST_BUFFER_PTS(buffer) = index * FRAME_DURATION;
+        GST_BUFFER_DTS(buffer) = index * FRAME_DURATION;
+        GST_BUFFER_DURATION(buffer) = FRAME_DURATION;
+        send_ns[index].store(Clock::now().time_since_epoch().count(), std::memory_order_release);
+        gst_app_src_push_buffer(GST_APP_SRC(src), buffer);
+    }
+};
+
+// 单路接收统计
+// 帧序号由解码输出PTS相对第一帧的偏移换算（接收端先于发送端启动，第一帧即第0帧）
+struct StreamStats {
+    std::mutex mutex;
+    GstClockTime first_pts = GST_CLOCK_TIME_NONE;
+    std::vector<double> latencies_ms;
+};
+
+double processCpuSeconds() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+           usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+double percentile(std::vector<double>& values, double p) {
+    if (values.empty()) return 0.0;
+    const size_t index = std::min(values.size() - 1, static_cast<size_t>(p * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+// 参数：同时接收的路数
+// 报告进程总CPU（单核百分比）、每路实际帧率和端到端延迟（发送 -> 转换后交付）
+void BM_MultiStreamReceive(benchmark::State& state) {
+    const int count = static_cast<int>(state.range(0));
+    gst_init(nullptr, nullptr);
+
+    static Clip clip;
+    if (clip.frames.empty() || !clip.caps) {
+        state.SkipWithError("无法编码测试片段（需要x264enc）");
+        return;
+    }
+
+    // 与NetworkManager相同的分路参数；固定延迟避免自适应调整引起的PTS跳变
+    VideoPipelineConfig config;
+    config.latency_profile = LatencyProfile::Fixed;
+    const GridLayout grid = gridLayoutFor(count);
+    config.max_width = VIDEO_AREA_WIDTH / grid.cols;
+    config.max_height = VIDEO_AREA_HEIGHT / grid.rows;
+    const unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+    config.decode_threads = static_cast<int>(std::max(1u, cores / static_cast<unsigned int>(count)));
+
+    double cpu_percent = 0.0, fps_per_stream = 0.0;
+    std::vector<double> latencies;
+
+    for (auto _ : state) {
+        // 声明顺序保证接收端（回调引用发送端和统计）最先析构
+        std::vector<std::unique_ptr<StreamStats>> stats;
+        std::vector<std::unique_ptr<Sender>> senders;
+        std::vector<std::unique_ptr<GstVideoReceiver>> receivers;
+
+        for (int i = 0; i < count; ++i) {
+            stats.push_back(std::make_unique<StreamStats>());
+            senders.push_back(std::make_unique<Sender>(BASE_PORT + 2 * i, clip.caps));
+            if (!senders.back()->pipeline) {
+                state.SkipWithError("无法创建发送管道");
+                return;
+            }
+        }
+
+        for (int i = 0; i < count; ++i) {
+            auto receiver = std::make_unique<GstVideoReceiver>();
+            StreamStats* stream_stats = stats[i].get();
+            Sender* sender = senders[i].get();
+            receiver->setFrameCallback([stream_stats, sender](VideoFrame&& frame) {
+                const int64_t now = Clock::now().time_since_epoch().count();
+                GstBuffer* buffer = frame.buffer();
+                if (!buffer || !GST_BUFFER_PTS_IS_VALID(buffer)) return;
+
+                std::lock_guard<std::mutex> lock(stream_stats->mutex);
+                if (stream_stats->first_pts == GST_CLOCK_TIME_NONE) {
+                    stream_stats->first_pts = GST_BUFFER_PTS(buffer);
+                }
+                const double offset = static_cast<double>(GST_BUFFER_PTS(buffer)) -
+                                      static_cast<double>(stream_stats->first_pts);
+                const long index = std::lround(offset / FRAME_DURATION);
+                if (index < WARMUP_FRAMES || index >= WARMUP_FRAMES + MEASURE_FRAMES) return;
+                const int64_t sent = sender->send_ns[index].load(std::memory_order_acquire);
+                if (sent > 0 && now >= sent) {
+                    stream_stats->latencies_ms.push_back((now - sent) / 1e6);
+                }
+            });
+            if (!receiver->initialize(BASE_PORT + 2 * i, config)) {
+                state.SkipWithError("无法创建接收管道");
+                return;
+            }
+            receiver->start();
+            receivers.push_back(std::move(receiver));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));  // 等待接收管道进入PLAYING
+
+        // 按帧率节拍发送，预热结束后开始计量
+        const auto interval = std::chrono::nanoseconds(FRAME_DURATION);
+        const auto start = Clock::now();
+        double cpu_begin = 0.0;
+        Clock::time_point wall_begin;
+        for (int k = 0; k < WARMUP_FRAMES + MEASURE_FRAMES; ++k) {
+            std::this_thread::sleep_until(start + k * interval);
+            if (k == WARMUP_FRAMES) {
+                cpu_begin = processCpuSeconds();
+                wall_begin = Clock::now();
+            }
+            for (auto& sender : senders) {
+                sender->push(k, clip.frames[k % clip.frames.size()]);
+            }
+        }
+        std::this_thread::sleep_until(start + (WARMUP_FRAMES + MEASURE_FRAMES) * interval);
+        const double cpu_seconds = processCpuSeconds() - cpu_begin;
+        const std::chrono::duration<double> wall = Clock::now() - wall_begin;
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));  // 接收在途帧
+        receivers.clear();
+        senders.clear();
+
+        cpu_percent = 100.0 * cpu_seconds / wall.count();
+        size_t frames = 0;
+        latencies.clear();
+        for (auto& stream_stats : stats) {
+            frames += stream_stats->latencies_ms.size();
+            latencies.insert(latencies.end(), stream_stats->latencies_ms.begin(),
+                             stream_stats->latencies_ms.end());
+        }
+        fps_per_stream = frames / wall.count() / count;
+    }
+
+    state.counters["cpu_percent"] = cpu_percent;
+    state.counters["cpu_percent_per_stream"] = cpu_percent / count;
+    state.counters["fps_per_stream"] = fps_per_stream;
+    state.counters["latency_p50_ms"] = percentile(latencies, 0.50);
+    state.counters["latency_p99_ms"] = percentile(latencies, 0.99);
+    state.counters["latency_max_ms"] = latencies.empty() ? 0.0 :
+        *std::max_element(latencies.begin(), latencies.end());
+}
+
+} // namespace
+
+BENCHMARK(BM_MultiStreamReceive)
+    ->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Arg(16)
+    ->Iterations(1)->UseRealTime()->Unit(benchmark::kSecond);
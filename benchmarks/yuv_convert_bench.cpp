@@ -0,0 +1,122 @@
+/*
+file: benchmarks/yuv_convert_bench.cpp
+date: 2026/10/16
+*/
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "utils/yuv_convert.h"
+
+namespace {
+
+// 随机内容的4:2:0源帧
+struct SourceFrame {
+    std::vector<uint8_t> y, u, v;
+    YuvImage image;
+
+    SourceFrame(int width, int height, YuvLayout layout) {
+        const int cw = (width + 1) / 2;
+        const int ch = (height + 1) / 2;
+        std::mt19937 rng(width * 31 + height);
+        y.resize(static_cast<size_t>(width) * height);
+        u.resize(static_cast<size_t>(cw) * ch * 2);
+        v.resize(static_cast<size_t>(cw) * ch);
+        for (auto& b : y) b = static_cast<uint8_t>(rng());
+        for (auto& b : u) b = static_cast<uint8_t>(rng());
+        for (auto& b : v) b = static_cast<uint8_t>(rng());
+
+        image.layout = layout;
+        image.width = width;
+        image.height = height;
+        image.planes[0] = y.data();
+        image.strides[0] = width;
+        image.planes[1] = u.data();
+        image.strides[1] = layout == YuvLayout::NV12 ? cw * 2 : cw;
+        image.planes[2] = v.data();
+        image.strides[2] = cw;
+    }
+};
+
+struct TargetFrame {
+    std::vector<uint8_t> pixels;
+    RgbaImage image;
+
+    TargetFrame(int width, int height) : pixels(static_cast<size_t>(width) * height * 4) {
+        image.data = pixels.data();
+        image.width = width;
+        image.height = height;
+        image.stride = width * 4;
+    }
+};
+
+// 参数：源宽、源高、目标宽、目标高、布局(0=I420,1=NV12)、指令集级别
+void BM_YuvToRgba(benchmark::State& state) {
+    const int src_w = static_cast<int>(state.range(0));
+    const int src_h = static_cast<int>(state.range(1));
+    const int dst_w = static_cast<int>(state.range(2));
+    const int dst_h = static_cast<int>(state.range(3));
+    const YuvLayout layout = state.range(4) ? YuvLayout::NV12 : YuvLayout::I420;
+    const auto level = static_cast<SimdLevel>(state.range(5));
+
+    if (level > detectSimdLevel()) {
+        state.SkipWithError("CPU不支持该指令集");
+        return;
+    }
+
+    SourceFrame src(src_w, src_h, layout);
+    TargetFrame dst(dst_w, dst_h);
+    TargetFrame expected(dst_w, dst_h);
+    YuvToRgbaConverter converter(level);
+
+    // 与参考实现逐位比对
+    convertYuvToRgbaReference(src.image, expected.image);
+    converter.convert(src.image, dst.image);
+    if (dst.pixels != expected.pixels) {
+        state.SkipWithError("结果与参考实现不一致");
+        return;
+    }
+
+    for (auto _ : state) {
+        converter.convert(src.image, dst.image);
+        benchmark::ClobberMemory();
+    }
+    state.SetLabel(simdLevelName(level));
+    state.SetItemsProcessed(state.iterations());  // 帧/秒
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(dst.pixels.size()));
+}
+
+void BM_YuvToRgbaReference(benchmark::State& state) {
+    SourceFrame src(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)), YuvLayout::I420);
+    TargetFrame dst(static_cast<int>(state.range(2)), static_cast<int>(state.range(3)));
+    for (auto _ : state) {
+        convertYuvToRgbaReference(src.image, dst.image);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// 常见源分辨率 -> 默认显示区域(860x580)以及1:1输出
+void ConvertArgs(benchmark::internal::Benchmark* b) {
+    const int sources[][2] = {{640, 480}, {1280, 720}, {1920, 1080}, {3840, 2160}};
+    for (const auto& src : sources) {
+        for (int layout = 0; layout <= 1; ++layout) {
+            for (int level = 0; level <= static_cast<int>(SimdLevel::Avx2); ++level) {
+                b->Args({src[0], src[1], 860, 580, layout, level});
+            }
+        }
+    }
+    for (int level = 0; level <= static_cast<int>(SimdLevel::Avx2); ++level) {
+        b->Args({1920, 1080, 1920, 1080, 0, level});
+    }
+}
+
+void ReferenceArgs(benchmark::internal::Benchmark* b) {
+    b->Args({1920, 1080, 860, 580});
+    b->Args({1920, 1080, 1920, 1080});
+}
+
+} // namespace
+
+BENCHMARK(BM_YuvToRgba)->Apply(ConvertArgs);
+BENCHMARK(BM_YuvToRgbaReference)->Apply(ReferenceArgs);
@@ -12,23 +12,95 @@ date: 2025-05-05
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#include <ifaddrs.h>
+#include <net/if.h>
 #include <unistd.h>
+#include <sys/stat.h>
+#include <cerrno>
+#include <ctime>
 #include <chrono>
+#include <algorithm>
+#include "utils/grid_layout.h"
 
-#define DISCOVERY_TIMEOUT 1
+#define DISCOVERY_TIMEOUT_MS 200   // 发现线程单次接收的等待上限（决定探测、老化和停止的响应延迟）
 
 using namespace std::chrono_literals;
 static constexpr auto HEARTBEAT_INTERVAL = 500ms;
 
+// 心跳回复中的接收指标
+static Json::Value metricsToJson(const ReceiverMetrics& metrics) {
+    Json::Value value;
+    value["packets_received"] = Json::UInt64(metrics.packets_received);
+    value["packets_lost"] = Json::UInt64(metrics.packets_lost);
+    value["packets_late"] = Json::UInt64(metrics.packets_late);
+    value["kernel_drops"] = Json::UInt64(metrics.kernel_drops);
+    value["rtx_requests"] = Json::UInt64(metrics.rtx_requests);
+    value["packets_retransmitted"] = Json::UInt64(metrics.packets_retransmitted);
+    value["packets_recovered"] = Json::UInt64(metrics.packets_recovered);
+    value["packets_unrecovered"] = Json::UInt64(metrics.packets_unrecovered);
+    value["keyframe_requests"] = Json::UInt64(metrics.keyframe_requests);
+    value["recovery_ms"] = metrics.recovery_ms;
+    value["late_recent"] = Json::UInt64(metrics.late_recent);
+    value["loss_rate"] = metrics.loss_rate;
+    value["jitter_ms"] = metrics.jitter_ms;
+    value["qos_jitter_ms"] = metrics.qos_jitter_ms;
+    value["latency_ms"] = metrics.latency_ms;
+    value["frames_decoded"] = Json::UInt64(metrics.frames_decoded);
+    value["frames_delivered"] = Json::UInt64(metrics.frames_delivered);
+    value["frames_dropped"] = Json::UInt64(metrics.frames_dropped);
+    value["decode_fps"] = metrics.decode_fps;
+    value["bitrate_kbps"] = metrics.bitrate_kbps;
+    value["queue_depth"] = metrics.queue_depth;
+    value["status"] = metrics.status;
+    return value;
+}
+
 NetworkManager::NetworkManager() {
     gst_init(nullptr, nullptr);
     discovery_running_.store(false);
     is_connected_.store(false);
+
+    // 后台探测解码器，不阻塞界面启动和连接；探测完成前各路使用默认的软件解码器
+    decoder_probe_thread_ = std::thread([this]() {
+        std::map<VideoCodec, DecoderChoice> choices = DecoderProbe::selectAll(&decoder_probe_cancel_);
+        std::lock_guard<std::mutex> lock(decoder_mutex_);
+        decoder_choices_ = std::move(choices);
+        decoder_probed_ = true;
+    });
 }
 
 NetworkManager::~NetworkManager() {
     disconnect();
     stopDiscovery();
+    decoder_probe_cancel_.store(true);
+    waitDecoderProbe();
+}
+
+// 发现探测：发往各网卡的广播地址，以及受限广播和本机（同机运行的服务器）
+static void sendDiscoveryProbe(int sock, int port) {
+    static const char PROBE[] = "{\"request\":\"discover\"}\n";
+    std::vector<in_addr_t> targets = {htonl(INADDR_BROADCAST), htonl(INADDR_LOOPBACK)};
+    ifaddrs* interfaces = nullptr;
+    if (getifaddrs(&interfaces) == 0) {
+        for (ifaddrs* ifa = interfaces; ifa; ifa = ifa->ifa_next) {
+            if (!ifa->ifa_addr || ifa->ifa_addr->sa_family != AF_INET || !ifa->ifa_broadaddr ||
+                !(ifa->ifa_flags & IFF_UP) || !(ifa->ifa_flags & IFF_BROADCAST)) {
+                continue;
+            }
+            const in_addr_t broadcast = reinterpret_cast<sockaddr_in*>(ifa->ifa_broadaddr)->sin_addr.s_addr;
+            if (std::find(targets.begin(), targets.end(), broadcast) == targets.end()) {
+                targets.push_back(broadcast);
+            }
+        }
+        freeifaddrs(interfaces);
+    }
+    for (in_addr_t target : targets) {
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = target;
+        sendto(sock, PROBE, sizeof(PROBE) - 1, 0, (sockaddr*)&addr, sizeof(addr));
+    }
 }
 
 // 服务发现模块
@@ -38,48 +110,66 @@ void NetworkManager::startDiscovery() {
 
     discovery_running_.store(true);
     discovery_thread_ = std::thread([this]() {
-        auto start_time = std::chrono::steady_clock::now();
+        const auto start_time = std::chrono::steady_clock::now();
         int sock = socket(AF_INET, SOCK_DGRAM, 0);
-        if (sock < 0) return;
+        if (sock < 0) {
+            discovery_running_.store(false);
+            return;
+        }
 
+        // 监听所有网卡；允许与同机的其他客户端共用端口（单播应答只到其中一个，见DISCOVERY_PROBE_PORT），并可发送广播探测
+        const int enable = 1;
+        setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+        setsockopt(sock, SOL_SOCKET, SO_BROADCAST, &enable, sizeof(enable));
         sockaddr_in addr{};
         addr.sin_family = AF_INET;
         addr.sin_port = htons(DISCOVERY_PORT);
         addr.sin_addr.s_addr = INADDR_ANY;
-        bind(sock, (sockaddr*)&addr, sizeof(addr));
+        if (bind(sock, (sockaddr*)&addr, sizeof(addr)) != 0) {
+            std::cerr << "服务发现: 无法绑定端口" << DISCOVERY_PORT << std::endl;
+        }
 
-        timeval tv{DISCOVERY_TIMEOUT, 0};
+        timeval tv{0, DISCOVERY_TIMEOUT_MS * 1000};
         setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
 
+        probe_requested_.store(true);
+        auto last_probe = start_time;
+        auto next_expire = start_time;
         char buffer[1024];
-        while (discovery_running_ && 
-            std::chrono::steady_clock::now() - start_time < DISCOVERY_DURATION) {
+        while (discovery_running_ && (continuous_discovery_.load() ||
+            std::chrono::steady_clock::now() - start_time < DISCOVERY_DURATION)) {
+            const auto now = std::chrono::steady_clock::now();
+            if (probe_requested_.exchange(false) || now - last_probe >= PROBE_INTERVAL) {
+                sendDiscoveryProbe(sock, DISCOVERY_PROBE_PORT);
+                last_probe = now;
+            }
+            if (now >= next_expire) {
+                server_registry_.expire(now - SERVER_TTL);
+                next_expire = now + std::chrono::seconds(1);
+            }
+
             sockaddr_in from{};
             socklen_t from_len = sizeof(from);
             int n = recvfrom(sock, buffer, sizeof(buffer), 0,
                            (sockaddr*)&from, &from_len);
 
             if (n > 0) {
+                // 按来源地址+heartbeat_port去重，有变化时注册表在锁外交付增量
                 Json::Value server_info;
-                if (Json::Reader().parse(buffer, buffer + n, server_info)) {
-                    server_info["ip"] = inet_ntoa(from.sin_addr);
-                    
-                    std::lock_guard<std::mutex> lock(servers_mutex_);
-                    if (std::none_of(servers_.begin(), servers_.end(),
-                        [&](const auto& s) {
-                            return s["ip"] == server_info["ip"] && 
-                                   s["heartbeat_port"] == server_info["heartbeat_port"];
-                        })) {
-                        servers_.push_back(server_info);
-                        if (server_list_callback_) {
-                            server_list_callback_(servers_);
-                        }
-                    }
+                const size_t known = server_registry_.size();
+                if (server_registry_.observeDatagram(from.sin_addr.s_addr, buffer, static_cast<size_t>(n),
+                                                     &server_info) &&
+                    server_registry_.size() > known) {
+                    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - last_probe).count();
+                    std::cout << "发现服务器 " << inet_ntoa(from.sin_addr) << ":"
+                              << server_info["heartbeat_port"].asInt()
+                              << "（距上次探测" << elapsed << "ms）" << std::endl;
                 }
             }
         }
 
-        discovery_running_.store(false); // 超时后停止
+        discovery_running_.store(false); // 非持续模式超时后停止
         close(sock);
     });
 }
@@ -183,15 +273,19 @@ void NetworkManager::connectToServer(const std::string& ip, int port) {
         }
 
         // std::vector<int> cameras;
-        for (const auto& cam : cam_list["cameras"]) {
-            cameras.push_back(cam.asInt());
-        }
+        parseCameraList(cam_list["cameras"], &cameras);
+
+        // 回收上一次连接遗留的线程（心跳超时等情况下线程已自行退出但未join）
+        releaseConnection();
 
         // 连接成功
+        {
+            std::lock_guard<std::mutex> lock(control_mutex_);
+            heartbeat_socket_ = sock;
+        }
         {
             std::lock_guard<std::mutex> lock(servers_mutex_);
             current_server_ip_ = ip;
-            heartbeat_socket_ = sock;
             is_connected_.store(true);
             success = true;
         }
@@ -201,9 +295,8 @@ void NetworkManager::connectToServer(const std::string& ip, int port) {
             camera_select_callback_(cameras);
         }
 
-        // 启动心跳和视频线程
+        // 启动心跳线程；视频流在选择摄像头后按路建立
         heartbeat_thread_ = std::thread(&NetworkManager::handleHeartbeat, this);
-        startVideoReception();
 
         message = "Connected to " + ip;
 
@@ -227,44 +320,520 @@ void NetworkManager::cancelConnect() {
     }
 }
 
-// 修改selectCamera方法
-void NetworkManager::selectCamera(int index) {
-    if (!is_connected_) return;
+// 选择摄像头：先按路建立接收管道，再把摄像头与端口的对应关系发给服务器
+// 消息保留camera_index/video_port两个字段（第一路），兼容只支持单路的服务器
+void NetworkManager::selectCameras(const std::vector<int>& indices) {
+    if (!is_connected_ || indices.empty()) return;
+
+    const size_t count = std::min(indices.size(), static_cast<size_t>(MAX_STREAMS));
+    const VideoPipelineConfig config = streamConfig(count);
+    std::string server_ip;
+    {
+        std::lock_guard<std::mutex> lock(servers_mutex_);
+        server_ip = current_server_ip_;
+    }
+    Json::Value stream_list(Json::arrayValue);
+    {
+        std::lock_guard<std::mutex> lock(gst_mutex_);
+        stopStreams();
+
+        std::vector<PortReservation> ports = allocateStreamPorts(count);
+        if (ports.size() < count) {
+            releasePorts(&ports);
+            if (connection_status_callback_) {
+                connection_status_callback_(true, "没有足够的可用视频端口");
+            }
+            return;
+        }
+
+        std::vector<VideoStream> streams;
+        for (size_t i = 0; i < count; ++i) {
+            const int slot = static_cast<int>(i);
+            VideoStream stream;
+            stream.camera_index = indices[i];
+            stream.port = ports[i].port;
+
+            // 用户指定解码器时只协商H.264；否则选择可实时解码的最省带宽格式
+            VideoPipelineConfig stream_config = config;
+            if (stream_config.decoder.empty()) {
+                stream_config.codec = chooseCodec(indices[i], count, config.max_fps);
+                stream.decoder = getDecoderChoice(stream_config.codec);
+                if (stream.decoder.element.empty()) {
+                    stream.decoder.codec = stream_config.codec;
+                    stream.decoder.element = codecInfo(stream_config.codec).default_decoder;
+                }
+                stream_config.decoder = stream.decoder.element;
+            } else {
+                stream_config.codec = VideoCodec::H264;
+                stream.decoder.element = stream_config.decoder;
+                stream.decoder.hardware = DecoderProbe::isHardware(stream_config.decoder);
+            }
 
-    Json::Value response;
-    response["camera_index"] = index;
-    std::string json_str = Json::FastWriter().write(response);
+            stream_config.rtcp_host = server_ip;
+            stream_config.rtcp_port = serverRtcpPort(indices[i], stream.port);
+
+            stream.receiver = std::make_unique<GstVideoReceiver>();
+            stream.receiver->setFrameCallback([this, slot](VideoFrame&& frame) {
+                if (frame_callback_) {
+                    frame_callback_(slot, std::move(frame));
+                }
+            });
+            stream.receiver->setErrorCallback([this, slot](const std::string& message, int type) {
+                if (connection_status_callback_) {
+                    const std::string prefix = "视频流" + std::to_string(slot + 1);
+                    connection_status_callback_(true, type == GST_VIDEO_ERROR_EOS ?
+                        prefix + ": " + message : prefix + "错误: " + message);
+                }
+            });
+            // RTCP PLI之外，经控制通道补发关键帧请求（不支持RTCP反馈的服务器也能响应）
+            stream.receiver->setKeyframeCallback([this, camera = stream.camera_index, port = stream.port](
+                                                     KeyframeReason reason) {
+                if (!is_connected_) return;
+                Json::Value request;
+                request["request"] = "keyframe";
+                request["camera_index"] = camera;
+                request["video_port"] = port;
+                request["reason"] = keyframeReasonName(reason);
+                sendControl(Json::FastWriter().write(request));
+            });
+            // 端口socket交给接收器（无论成功与否都由其关闭）
+            const bool initialized = stream.receiver->initialize(stream.port, stream_config,
+                                                                 ports[i].rtp_fd, ports[i].rtcp_fd);
+            ports[i].rtp_fd = -1;
+            ports[i].rtcp_fd = -1;
+            if (!initialized) {
+                // 整体放弃：各路的序号即网格单元格，跳过一路会让后续各路与单元格错位
+                for (auto& started : streams) {
+                    started.receiver->stop();
+                }
+                releasePorts(&ports);
+                if (connection_status_callback_) {
+                    connection_status_callback_(true, "视频管道创建失败: 端口" + std::to_string(stream.port));
+                }
+                return;
+            }
+            stream.receiver->start();
+            streams.push_back(std::move(stream));
+        }
+
+        for (const auto& stream : streams) {
+            Json::Value entry;
+            entry["camera_index"] = stream.camera_index;
+            entry["video_port"] = stream.port;
+            entry["codec"] = codecName(stream.decoder.codec);
+            entry["rtcp_port"] = stream.port + 1;
+            if (config.retransmission) {
+                entry["rtx_payload_type"] = config.rtx_payload_type;
+            }
+            if (config.fec_payload_type > 0) {
+                entry["fec_payload_type"] = config.fec_payload_type;
+            }
+            stream_list.append(entry);
+        }
+
+        std::lock_guard<std::mutex> streams_lock(streams_mutex_);
+        streams_ = std::move(streams);
+    }
+
+    Json::Value request;
+    request["camera_index"] = stream_list[0]["camera_index"];
+    request["video_port"] = stream_list[0]["video_port"];
+    request["codec"] = stream_list[0]["codec"];
+    request["streams"] = stream_list;
+
+    // 按单元格大小请求码流上限，服务器可据此降低分辨率和帧率
+    if (config.max_width > 0 && config.max_height > 0) {
+        request["max_width"] = config.max_width;
+        request["max_height"] = config.max_height;
+    }
+    if (config.max_fps > 0) {
+        request["max_fps"] = config.max_fps;
+    }
+    std::string json_str = Json::FastWriter().write(request);
     
-    if (send(heartbeat_socket_, json_str.c_str(), json_str.size(), 0) <= 0) {
+    if (!sendControl(json_str)) {
         connection_status_callback_(false, "摄像头选择发送失败");
         disconnect();
     } else {
         connection_status_callback_(true, "摄像头选择已提交");
     }
-    // disconnect();
+}
+
+size_t NetworkManager::getStreamCount() const {
+    std::lock_guard<std::mutex> lock(streams_mutex_);
+    return streams_.size();
+}
+
+// 每路的管道参数：显示约束按网格单元格划分，解码线程按路数分摊CPU核心
+VideoPipelineConfig NetworkManager::streamConfig(size_t count) {
+    VideoPipelineConfig config = getPipelineConfig();
+    if (count > 1) {
+        const GridLayout grid = gridLayoutFor(static_cast<int>(count));
+        config.max_width /= grid.cols;
+        config.max_height /= grid.rows;
+        const unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+        if (config.decode_threads == 0) {
+            config.decode_threads = static_cast<int>(std::max(1u, cores / static_cast<unsigned int>(count)));
+        }
+        if (config.convert_threads == 0) {
+            config.convert_threads = 1;
+        }
+    }
+    return config;
+}
+
+// 从VIDEO_PORT开始按偶数端口探测，跳过已被占用的端口
+// 分配的端口一直保持绑定，socket交给接收管道直接使用，避免探测与udpsrc绑定之间被其他进程占去
+std::vector<NetworkManager::PortReservation> NetworkManager::allocateStreamPorts(size_t count) const {
+    std::vector<PortReservation> ports;
+    for (int port = VIDEO_PORT; port < VIDEO_PORT + VIDEO_PORT_RANGE && ports.size() < count; port += 2) {
+        // RTP端口与其后的RTCP端口都须可用
+        int fds[2] = {-1, -1};
+        bool available = true;
+        for (int i = 0; i < 2 && available; ++i) {
+            fds[i] = socket(AF_INET, SOCK_DGRAM, 0);
+            if (fds[i] < 0) {
+                if (i == 1) close(fds[0]);
+                releasePorts(&ports);  // fd耗尽
+                return ports;
+            }
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons(port + i);
+            addr.sin_addr.s_addr = INADDR_ANY;
+            available = bind(fds[i], (sockaddr*)&addr, sizeof(addr)) == 0;
+        }
+        if (available) {
+            ports.push_back(PortReservation{port, fds[0], fds[1]});
+        } else {
+            for (int fd : fds) {
+                if (fd >= 0) close(fd);
+            }
+        }
+    }
+    return ports;
+}
+
+void NetworkManager::releasePorts(std::vector<PortReservation>* ports) {
+    for (auto& reservation : *ports) {
+        for (int* fd : {&reservation.rtp_fd, &reservation.rtcp_fd}) {
+            if (*fd >= 0) {
+                close(*fd);
+                *fd = -1;
+            }
+        }
+    }
+    ports->clear();
+}
+
+// 停止并销毁所有视频流（调用方持有gst_mutex_或处于析构流程）
+void NetworkManager::stopStreams() {
+    std::vector<VideoStream> streams;
+    {
+        std::lock_guard<std::mutex> lock(streams_mutex_);
+        streams.swap(streams_);
+    }
+    // 在锁外停止，状态查询不被管道关闭阻塞
+    for (auto& stream : streams) {
+        stream.receiver->stop();
+    }
+}
+
+void NetworkManager::setDisplayConstraints(int max_width, int max_height, int max_fps) {
+    std::lock_guard<std::mutex> lock(config_mutex_);
+    pipeline_config_.max_width = max_width;
+    pipeline_config_.max_height = max_height;
+    pipeline_config_.max_fps = max_fps;
+}
+
+void NetworkManager::setPipelineConfig(const VideoPipelineConfig& config) {
+    std::lock_guard<std::mutex> lock(config_mutex_);
+    pipeline_config_ = config;
+    present_mode_.store(config.present_mode);
+    latency_profile_.store(config.latency_profile);
+}
+
+void NetworkManager::setPresentMode(PresentMode mode) {
+    present_mode_.store(mode);
+    std::lock_guard<std::mutex> lock(streams_mutex_);
+    for (auto& stream : streams_) {
+        stream.receiver->setPresentMode(mode);
+    }
+}
+
+void NetworkManager::setLatencyProfile(LatencyProfile profile) {
+    latency_profile_.store(profile);
+    std::lock_guard<std::mutex> lock(streams_mutex_);
+    for (auto& stream : streams_) {
+        stream.receiver->setLatencyProfile(profile);
+    }
+}
+
+int NetworkManager::getLatencyMs() const {
+    std::lock_guard<std::mutex> lock(streams_mutex_);
+    int latency = 0;
+    for (const auto& stream : streams_) {
+        latency = std::max(latency, stream.receiver->getLatencyMs());
+    }
+    return latency;
+}
+
+double NetworkManager::getJitterMs() const {
+    std::lock_guard<std::mutex> lock(streams_mutex_);
+    double jitter = 0.0;
+    for (const auto& stream : streams_) {
+        jitter = std::max(jitter, stream.receiver->getJitterMs());
+    }
+    return jitter;
+}
+
+int NetworkManager::getReceiverStatus() const {
+    std::lock_guard<std::mutex> lock(streams_mutex_);
+    int status = 200;
+    for (const auto& stream : streams_) {
+        status = std::max(status, stream.receiver->getReceiverStatus());
+    }
+    return status;
+}
+
+ReceiverMetrics NetworkManager::getReceiverMetrics() const {
+    std::lock_guard<std::mutex> lock(streams_mutex_);
+    ReceiverMetrics total;
+    for (const auto& stream : streams_) {
+        const ReceiverMetrics metrics = stream.receiver->getMetrics();
+        total.packets_received += metrics.packets_received;
+        total.packets_lost += metrics.packets_lost;
+        total.packets_late += metrics.packets_late;
+        total.kernel_drops += metrics.kernel_drops;
+        total.rtx_requests += metrics.rtx_requests;
+        total.packets_retransmitted += metrics.packets_retransmitted;
+        total.packets_recovered += metrics.packets_recovered;
+        total.packets_unrecovered += metrics.packets_unrecovered;
+        total.keyframe_requests += metrics.keyframe_requests;
+        total.recovery_ms = std::max(total.recovery_ms, metrics.recovery_ms);
+        total.late_recent += metrics.late_recent;
+        total.frames_decoded += metrics.frames_decoded;
+        total.frames_delivered += metrics.frames_delivered;
+        total.frames_dropped += metrics.frames_dropped;
+        total.decode_fps += metrics.decode_fps;
+        total.bitrate_kbps += metrics.bitrate_kbps;
+        total.queue_depth += metrics.queue_depth;
+        total.loss_rate = std::max(total.loss_rate, metrics.loss_rate);
+        total.jitter_ms = std::max(total.jitter_ms, metrics.jitter_ms);
+        total.qos_jitter_ms = std::max(total.qos_jitter_ms, metrics.qos_jitter_ms);
+        total.latency_ms = std::max(total.latency_ms, metrics.latency_ms);
+        total.status = std::max(total.status, metrics.status);
+    }
+    return total;
+}
+
+TexturePoolStats NetworkManager::getTexturePoolStats() const {
+    std::lock_guard<std::mutex> lock(streams_mutex_);
+    TexturePoolStats total;
+    for (const auto& stream : streams_) {
+        const TexturePoolStats stats = stream.receiver->getTexturePoolStats();
+        total.hits += stats.hits;
+        total.misses += stats.misses;
+        total.pools += stats.pools;
+    }
+    return total;
+}
+
+bool NetworkManager::startRecording(const std::string& directory) {
+    if (mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) {
+        std::cerr << "无法创建录制目录: " << directory << std::endl;
+        return false;
+    }
+    // 录制支路默认不建立：第一次录制时开启并按当前选择重建各路管道（画面短暂中断），之后保持开启
+    bool rebuild = false;
+    {
+        std::lock_guard<std::mutex> lock(config_mutex_);
+        if (!pipeline_config_.record_branch) {
+            pipeline_config_.record_branch = true;
+            rebuild = true;
+        }
+    }
+    if (rebuild) {
+        std::vector<int> cameras;
+        {
+            std::lock_guard<std::mutex> lock(streams_mutex_);
+            for (const auto& stream : streams_) cameras.push_back(stream.camera_index);
+        }
+        std::cout << "开启录制支路，重建" << cameras.size() << "路接收管道" << std::endl;
+        selectCameras(cameras);
+    }
+    char started[32];
+    const std::time_t now = std::time(nullptr);
+    std::tm local{};
+    localtime_r(&now, &local);
+    std::strftime(started, sizeof(started), "%Y%m%d_%H%M%S", &local);
+
+    std::lock_guard<std::mutex> lock(streams_mutex_);
+    bool any = false;
+    for (auto& stream : streams_) {
+        const std::string prefix = directory + "/cam" + std::to_string(stream.camera_index) + "_" + started;
+        any = stream.receiver->startRecording(prefix) || any;
+    }
+    return any;
+}
+
+void NetworkManager::stopRecording() {
+    std::lock_guard<std::mutex> lock(streams_mutex_);
+    for (auto& stream : streams_) {
+        stream.receiver->stopRecording();
+    }
+}
+
+bool NetworkManager::isRecording() const {
+    std::lock_guard<std::mutex> lock(streams_mutex_);
+    for (const auto& stream : streams_) {
+        if (stream.receiver->isRecording()) return true;
+    }
+    return false;
+}
+
+DecoderChoice NetworkManager::getDecoderChoice(VideoCodec codec) const {
+    std::lock_guard<std::mutex> lock(decoder_mutex_);
+    auto it = decoder_choices_.find(codec);
+    if (!decoder_probed_ || it == decoder_choices_.end()) {
+        return DecoderChoice{codec, ""};
+    }
+    return it->second;
+}
+
+DecoderChoice NetworkManager::getStreamDecoder(int stream) const {
+    std::lock_guard<std::mutex> lock(streams_mutex_);
+    if (stream < 0 || stream >= static_cast<int>(streams_.size())) {
+        return DecoderChoice{VideoCodec::H264, ""};
+    }
+    return streams_[stream].decoder;
+}
+
+// 解析摄像头列表，兼容两种格式：
+//   旧格式 {"cameras": [0, 1]}，只支持H.264
+//   新格式 {"cameras": [{"index": 0, "codecs": ["H265", "H264"]}, ...]}
+void NetworkManager::parseCameraList(const Json::Value& cameras, std::vector<int>* ids) {
+    std::map<int, std::vector<VideoCodec>> codecs;
+    std::map<int, int> rtcp_ports;
+    for (const auto& cam : cameras) {
+        int id = 0;
+        std::vector<VideoCodec> supported;
+        if (cam.isObject()) {
+            id = cam["index"].asInt();
+            if (cam.isMember("rtcp_port")) {
+                rtcp_ports[id] = cam["rtcp_port"].asInt();
+            }
+            for (const auto& name : cam["codecs"]) {
+                VideoCodec codec;
+                if (codecFromName(name.asString(), &codec)) {
+                    supported.push_back(codec);
+                }
+            }
+        } else {
+            id = cam.asInt();
+        }
+        if (supported.empty()) {
+            supported.push_back(VideoCodec::H264);
+        }
+        ids->push_back(id);
+        codecs[id] = std::move(supported);
+    }
+
+    std::lock_guard<std::mutex> lock(camera_mutex_);
+    camera_codecs_ = std::move(codecs);
+    camera_rtcp_ports_ = std::move(rtcp_ports);
+}
+
+// 服务器接收RTCP（接收报告、NACK）的端口：摄像头列表未声明时按惯例与本地RTCP端口相同
+int NetworkManager::serverRtcpPort(int camera, int local_port) const {
+    std::lock_guard<std::mutex> lock(camera_mutex_);
+    auto it = camera_rtcp_ports_.find(camera);
+    return it != camera_rtcp_ports_.end() ? it->second : local_port + 1;
+}
+
+// 在摄像头支持的格式中选择带宽效率最高、且本机能实时解码的一个
+// 实时标准：所有路的单帧解码耗时之和不超过帧间隔的一半（基准码流为720p，
+// 不小于多路时的单元格分辨率，判断偏保守）。H.264作为兜底不要求基准结果。
+VideoCodec NetworkManager::chooseCodec(int camera, size_t stream_count, int max_fps) const {
+    std::vector<VideoCodec> supported{VideoCodec::H264};
+    {
+        std::lock_guard<std::mutex> lock(camera_mutex_);
+        auto it = camera_codecs_.find(camera);
+        if (it != camera_codecs_.end()) supported = it->second;
+    }
+
+    const double frame_interval_ms = 1000.0 / (max_fps > 0 ? max_fps : 30);
+    for (VideoCodec codec : codecsByEfficiency()) {
+        if (std::find(supported.begin(), supported.end(), codec) == supported.end()) continue;
+        const DecoderChoice choice = getDecoderChoice(codec);
+        if (choice.element.empty()) continue;
+        if (codec == VideoCodec::H264) return codec;
+        if (choice.ms_per_frame >= 0 &&
+            choice.ms_per_frame * stream_count <= frame_interval_ms * 0.5) {
+            return codec;
+        }
+    }
+    // 都不满足实时要求：优先H.264，否则用摄像头的第一个格式（软件解码器兜底）
+    if (std::find(supported.begin(), supported.end(), VideoCodec::H264) != supported.end()) {
+        return VideoCodec::H264;
+    }
+    return supported.front();
+}
+
+VideoPipelineConfig NetworkManager::getPipelineConfig() const {
+    std::lock_guard<std::mutex> lock(config_mutex_);
+    VideoPipelineConfig config = pipeline_config_;
+    config.present_mode = present_mode_.load();
+    config.latency_profile = latency_profile_.load();
+    return config;
 }
 
 void NetworkManager::disconnect() {
     is_connected_.store(false);
-    if (heartbeat_socket_ != -1) {
-        close(heartbeat_socket_);
-        heartbeat_socket_ = -1;
+    releaseConnection();
+}
+
+// 回收上一次连接的线程和套接字（须在is_connected_为false时调用）
+// 接收器线程的关键帧回调会经控制通道发送，因此先停止各路流，再关闭控制socket，
+// 否则正在运行的接收器可能向已关闭（甚至已被复用）的fd发送
+void NetworkManager::releaseConnection() {
+    {
+        std::lock_guard<std::mutex> lock(control_mutex_);
+        if (heartbeat_socket_ != -1) {
+            // shutdown唤醒阻塞在recv上的心跳线程（仅close不保证唤醒）
+            shutdown(heartbeat_socket_, SHUT_RDWR);
+        }
     }
     if (heartbeat_thread_.joinable()) {
         heartbeat_thread_.join();
     }
+    {
+        // 接收器每50ms检查一次停止标志，退出延迟有界
+        std::lock_guard<std::mutex> lock(gst_mutex_);
+        stopStreams();
+    }
+    std::lock_guard<std::mutex> lock(control_mutex_);
+    if (heartbeat_socket_ != -1) {
+        close(heartbeat_socket_);
+        heartbeat_socket_ = -1;
+    }
 }
 
 // 心跳维护模块
 void NetworkManager::handleHeartbeat() {
     char buffer[16];
+    int sock = -1;  // 本线程运行期间socket不会关闭（releaseConnection先join本线程）
+    {
+        std::lock_guard<std::mutex> lock(control_mutex_);
+        sock = heartbeat_socket_;
+    }
     last_heartbeat_ = std::chrono::steady_clock::now();
     while (is_connected_) {
         if (std::chrono::steady_clock::now() - last_heartbeat_ > 3s) {
             connection_status_callback_(false, "心跳超时");
             break;
         }
-        int bytes_received = recv(heartbeat_socket_, buffer, sizeof(buffer), 0);
+        int bytes_received = recv(sock, buffer, sizeof(buffer), 0);
         last_heartbeat_ = std::chrono::steady_clock::now();
         if (bytes_received <= 0) {
             if (connection_status_callback_) {
@@ -274,8 +843,23 @@ void NetworkManager::handleHeartbeat() {
             break;
         }
 
-        std::string status = std::to_string(receiver_status_.load());
-        if (send(heartbeat_socket_, status.c_str(), status.size(), 0) <= 0) {
+        // 回复接收指标：status保留原有的200/300语义，metrics为各路汇总，streams为逐路明细
+        Json::Value report;
+        const ReceiverMetrics total = getReceiverMetrics();
+        report["status"] = total.status;
+        report["metrics"] = metricsToJson(total);
+        report["streams"] = Json::Value(Json::arrayValue);
+        {
+            std::lock_guard<std::mutex> lock(streams_mutex_);
+            for (const auto& stream : streams_) {
+                Json::Value entry = metricsToJson(stream.receiver->getMetrics());
+                entry["camera_index"] = stream.camera_index;
+                entry["video_port"] = stream.port;
+                report["streams"].append(entry);
+            }
+        }
+        std::string status = Json::FastWriter().write(report);
+        if (!sendControl(status)) {
             if (connection_status_callback_) {
                 connection_status_callback_(false, "心跳发送失败");
             }
@@ -288,60 +872,18 @@ void NetworkManager::handleHeartbeat() {
     }
 }
 
-// 视频接收模块
-void NetworkManager::startVideoReception() {
-    std::lock_guard<std::mutex> lock(gst_mutex_);
-    video_thread_ = std::thread([this]() {
-        GstElement *pipeline = gst_parse_launch(
-            ("udpsrc port=" + std::to_string(VIDEO_PORT) + " ! "
-            "application/x-rtp,media=video,encoding-name=H264 ! "
-            "rtpjitterbuffer latency=100 ! "
-            "rtph264depay ! avdec_h264 ! videoconvert ! video/x-raw,format=RGBA ! appsink name=sink")
-            .c_str(), nullptr);
-
-        GstElement *sink = gst_bin_get_by_name(GST_BIN(pipeline), "sink");
-        gst_app_sink_set_emit_signals(GST_APP_SINK(sink), true);
-        gst_app_sink_set_drop(GST_APP_SINK(sink), true);
-        gst_app_sink_set_max_buffers(GST_APP_SINK(sink), 5);
-
-        GstBus *bus = gst_element_get_bus(pipeline);
-        gst_element_set_state(pipeline, GST_STATE_PLAYING);
-
-        while (is_connected_) {
-            GstSample *sample = gst_app_sink_pull_sample(GST_APP_SINK(sink));
-            if (sample && frame_callback_) {
-                GstBuffer *buffer = gst_sample_get_buffer(sample);
-                GstMapInfo map;
-                if (gst_buffer_map(buffer, &map, GST_MAP_READ)) {
-                    // 添加视频格式解析
-                    GstCaps* caps = gst_sample_get_caps(sample);
-                    GstVideoInfo info;
-                    gst_video_info_init(&info);
-                    if (gst_video_info_from_caps(&info, caps)) {
-                        VideoFrame frame {
-                            .width = info.width,
-                            .height = info.height,
-                            .data = map.data,
-                            .size = map.size,
-                            .format = info.finfo->format
-                        };
-                        frame_callback_(frame);
-                    }
-                    gst_buffer_unmap(buffer, &map);
-                }
-                gst_sample_unref(sample);
-            }
+// 控制通道发送：心跳、摄像头选择和关键帧请求可能来自不同线程
+bool NetworkManager::sendControl(const std::string& message) {
+    std::lock_guard<std::mutex> lock(control_mutex_);
+    if (heartbeat_socket_ == -1) return false;
+    return send(heartbeat_socket_, message.c_str(), message.size(), 0) > 0;
+}
 
-            // 处理总线消息
-            GstMessage *msg = gst_bus_pop_filtered(bus, 
-                static_cast<GstMessageType>(GST_MESSAGE_ERROR | GST_MESSAGE_EOS | GST_MESSAGE_QOS));
-            if (msg) {
-                // 处理错误和状态消息（同原逻辑）
-                gst_message_unref(msg);
-            }
+// 等待启动时的解码器探测结束；无论从哪个线程调用几次，只join一次
+void NetworkManager::waitDecoderProbe() {
+    std::call_once(decoder_probe_joined_, [this]() {
+        if (decoder_probe_thread_.joinable()) {
+            decoder_probe_thread_.join();
         }
-
-        gst_element_set_state(pipeline, GST_STATE_NULL);
-        gst_object_unref(pipeline);
     });
-}
\ No newline at end of file
+}
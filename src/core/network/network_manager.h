@@ -7,29 +7,29 @@ date: 2025-05-05
 #define NETWORK_MANAGER_H
 
 #include <functional>
+#include <memory>
 #include <vector>
 #include <string>
 #include <json/json.h>
+#include <map>
 #include <atomic>
 #include <mutex>
 #include <thread>
 #include <chrono>
 #include <gst/gst.h>
-#include <gst/app/gstappsink.h>
-#include <gst/video/video.h> 
-
-struct VideoFrame {
-    int width;
-    int height;
-    const uint8_t* data;
-    size_t size;
-    GstVideoFormat format;
-};
+#include "core/video/video_frame.h"
+#include "core/video/pipeline_config.h"
+#include "core/video/gst_video_receiver.h"
+#include "core/video/decoder_probe.h"
+#include "core/network/server_registry.h"
 
 class NetworkManager {
 public:
-    // 状态回调类型
-    using FrameCallback = std::function<void(const VideoFrame&)>;
+    // 同时接收的最大路数
+    static constexpr int MAX_STREAMS = 16;
+
+    // 状态回调类型（stream为路序号，即选择时摄像头列表中的位置）
+    using FrameCallback = std::function<void(int stream, VideoFrame&&)>;
     using StatusCallback = std::function<void(bool connected, const std::string& message)>;
     using CameraListCallback = std::function<void(const std::vector<int>& cameras)>;
 
@@ -37,33 +37,77 @@ public:
     ~NetworkManager();
 
     // 服务发现接口
+    // 持续模式（默认）下发现线程一直运行：监听所有网卡上的广播，超过SERVER_TTL未再出现的服务器移除；
+    // 启动、refreshServerList()时及每隔PROBE_INTERVAL向各网卡广播探测，支持探测的服务器立即应答。
+    // 关闭持续模式时与原来一样只监听DISCOVERY_DURATION。
     void startDiscovery();
     void stopDiscovery();
-    std::vector<Json::Value> getDiscoveredServers() const;
+    void setContinuousDiscovery(bool continuous) { continuous_discovery_.store(continuous); }
+    std::vector<ServerEntry> getDiscoveredServers() const { return server_registry_.snapshot(); }
+    size_t getDiscoveredServerCount() const { return server_registry_.size(); }
 
     // 连接管理接口
     void connectToServer(const std::string& ip, int port);
     void cancelConnect();
     void disconnect();
-    void selectCamera(int index);
+    void selectCamera(int index) { selectCameras({index}); }
+
+    // 同时查看多路摄像头：每路分配独立端口和接收管道，端口随选择消息告知服务器
+    void selectCameras(const std::vector<int>& indices);
+    size_t getStreamCount() const;
+
+    // 显示区域约束：选择摄像头时请求服务器按此上限编码，接收管道同样限制
+    // 多路时按网格单元格大小逐路约束
+    void setDisplayConstraints(int max_width, int max_height, int max_fps);
+
+    // 接收管道参数（解码/转换线程等），下次建立管道时生效
+    void setPipelineConfig(const VideoPipelineConfig& config);
+    VideoPipelineConfig getPipelineConfig() const;
+
+    // 呈现策略（运行中修改会同步到appsink）
+    void setPresentMode(PresentMode mode);
+    PresentMode getPresentMode() const { return present_mode_.load(); }
+
+    // jitterbuffer延迟策略（运行中修改立即生效）
+    void setLatencyProfile(LatencyProfile profile);
+    LatencyProfile getLatencyProfile() const { return latency_profile_.load(); }
+    // 以下统计在多路时取各路最差值（池统计为总和）
+    int getLatencyMs() const;
+    double getJitterMs() const;
+
+    // 录制当前各路（压缩码流直接封装，预录缓存中的画面一并写入）
+    // 文件位于directory下，按摄像头和开始时间命名；重新选择摄像头时录制随旧管道停止
+    // 管道未建立录制支路时先开启record_branch并重建当前各路，此后的管道都带录制支路
+    bool startRecording(const std::string& directory);
+    void stopRecording();
+    bool isRecording() const;
+
+    // 启动时探测并基准测试选出的解码器（探测未完成或没有该格式解码器时element为空）
+    DecoderChoice getDecoderChoice(VideoCodec codec = VideoCodec::H264) const;
+
+    // 第stream路实际使用的编码格式和解码器（该路不存在时element为空）
+    DecoderChoice getStreamDecoder(int stream) const;
 
     // 回调设置接口
     void setFrameCallback(FrameCallback callback) { frame_callback_ = callback; }
     void setStatusCallback(StatusCallback callback) { connection_status_callback_ = callback; }
     void setCameraListCallback(CameraListCallback callback) { camera_select_callback_ = callback; }
-    void setServerListCallback(std::function<void(std::vector<Json::Value>)> callback) { 
-        server_list_callback_ = callback; 
+    // 服务器列表的增量变化（在发现线程或调用refreshServerList的线程中、注册表锁外调用）
+    void setServerListCallback(ServerRegistry::DeltaCallback callback) {
+        server_registry_.setDeltaCallback(std::move(callback));
     }
 
-    int getReceiverStatus() const { 
-        return receiver_status_.load(); 
-    }
+    int getReceiverStatus() const;
+    // 各路接收指标汇总：计数和速率求和，丢包率、抖动、延迟和状态取最差值
+    ReceiverMetrics getReceiverMetrics() const;
+    TexturePoolStats getTexturePoolStats() const;
+    // 立即探测一次（不清空列表，失效的服务器按TTL移除，列表不会闪空）
     void refreshServerList() {
-        {
-            std::lock_guard<std::mutex> lock(servers_mutex_);
-            servers_.clear();  // 清空旧服务器列表
-        } 
-        startDiscovery(); 
+        if (discovery_running_.load()) {
+            probe_requested_.store(true);
+        } else {
+            startDiscovery();
+        }
     }
     bool isDiscovering() const { 
         return discovery_running_.load(); 
@@ -71,27 +115,63 @@ public:
     CameraListCallback getCameraListCallback() const { return camera_select_callback_; }
 
 private:
+    // 一路视频流：摄像头、本地端口及其独立的接收管道
+    struct VideoStream {
+        int camera_index = -1;
+        int port = 0;
+        DecoderChoice decoder;
+        std::unique_ptr<GstVideoReceiver> receiver;
+    };
+
     void handleHeartbeat();
-    void startVideoReception();
+    bool sendControl(const std::string& message);
+    void releaseConnection();
+    void waitDecoderProbe();
+    // 为一路预留的RTP/RTCP端口：两个socket保持绑定，直到交给接收管道
+    struct PortReservation {
+        int port = 0;
+        int rtp_fd = -1;
+        int rtcp_fd = -1;
+    };
+
+    void stopStreams();
+    std::vector<PortReservation> allocateStreamPorts(size_t count) const;
+    static void releasePorts(std::vector<PortReservation>* ports);
+    VideoPipelineConfig streamConfig(size_t count);
+    void parseCameraList(const Json::Value& cameras, std::vector<int>* ids);
+    VideoCodec chooseCodec(int camera, size_t stream_count, int max_fps) const;
+    int serverRtcpPort(int camera, int local_port) const;
 
     // 网络状态
-    mutable std::mutex servers_mutex_;
-    std::vector<Json::Value> servers_;
+    mutable std::mutex servers_mutex_;           // 保护当前连接（current_server_ip_）
+    ServerRegistry server_registry_;
     std::atomic<bool> discovery_running_{false};
+    std::atomic<bool> continuous_discovery_{true};
+    std::atomic<bool> probe_requested_{false};
     std::atomic<bool> is_connected_{false};
-    std::atomic<int> receiver_status_{200};  // 200=正常，300=拥塞
     std::atomic<bool> camera_selected_{false}; 
+    std::atomic<PresentMode> present_mode_{PresentMode::Mailbox};
+    mutable std::mutex config_mutex_;
+    VideoPipelineConfig pipeline_config_;
+    std::atomic<LatencyProfile> latency_profile_{LatencyProfile::Adaptive};
     std::chrono::steady_clock::time_point last_heartbeat_;
-    static constexpr std::chrono::seconds DISCOVERY_DURATION{5};
+    static constexpr std::chrono::seconds DISCOVERY_DURATION{5};    // 非持续模式的监听时长
+    static constexpr std::chrono::seconds SERVER_TTL{10};           // 超过此时长未收到广播或应答即移除
+    static constexpr std::chrono::seconds PROBE_INTERVAL{3};        // 持续模式下定期探测的间隔
+    // 只应答探测、不定期广播的服务器靠探测续期，TTL内至少要探测两次，否则列表会周期性地删除再加回
+    static_assert(SERVER_TTL >= 2 * PROBE_INTERVAL, "SERVER_TTL必须覆盖至少两个探测周期");
 
     // 网络资源
     int heartbeat_socket_ = -1;
+    std::mutex control_mutex_;                   // 保护heartbeat_socket_的赋值与关闭，串行化控制通道上的发送（心跳、选择、关键帧请求）
     std::string current_server_ip_;
 
     // 线程管理
     std::thread discovery_thread_;
     std::thread heartbeat_thread_;
-    std::thread video_thread_;
+    std::thread decoder_probe_thread_;
+    std::once_flag decoder_probe_joined_;
+    std::atomic<bool> decoder_probe_cancel_{false};  // 析构时中止尚未完成的探测
     std::atomic<bool> is_connecting_{false};
     std::atomic<bool> cancel_connect_{false};
 
@@ -99,12 +179,26 @@ private:
     FrameCallback frame_callback_;
     StatusCallback connection_status_callback_;
     CameraListCallback camera_select_callback_;
-    std::function<void(std::vector<Json::Value>)> server_list_callback_;
 
     // GStreamer参数
     static constexpr int DISCOVERY_PORT = 37020;
-    static constexpr int VIDEO_PORT = 5000;
-    std::mutex gst_mutex_;
+    static constexpr int DISCOVERY_PROBE_PORT = 37021;  // 服务器接收探测的端口，应答发往探测的来源端口（DISCOVERY_PORT）
+    // 两个端口都以SO_REUSEADDR共用：广播会交给同机的每个套接字，但发往单播地址（包括127.0.0.1）的
+    // 探测和应答只会交给其中一个进程。同机运行多个客户端时只有一个能收到探测应答，其余客户端
+    // 依赖服务器的定期广播；同机多台服务器时发往本机的单播探测也只有一台应答，其余靠广播探测或定期广播。
+    static constexpr int VIDEO_PORT = 5000;      // 第一路端口，后续各路依次+2（奇数端口留给RTCP）
+    static constexpr int VIDEO_PORT_RANGE = 200; // 端口探测范围
+    std::mutex gst_mutex_;                       // 串行化流的创建与销毁
+    mutable std::mutex streams_mutex_;           // 保护streams_
+    std::vector<VideoStream> streams_;
+    mutable std::mutex decoder_mutex_;
+    bool decoder_probed_ = false;
+    std::map<VideoCodec, DecoderChoice> decoder_choices_;  // 仅包含有可用解码器的格式
+
+    // 各摄像头声明支持的编码格式和服务器端RTCP端口（连接时从摄像头列表中取得）
+    mutable std::mutex camera_mutex_;
+    std::map<int, std::vector<VideoCodec>> camera_codecs_;
+    std::map<int, int> camera_rtcp_ports_;
 };
 
 #endif // NETWORK_MANAGER_H
\ No newline at end of file
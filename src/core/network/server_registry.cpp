@@ -0,0 +1,141 @@
+/*
+file: src/core/network/server_registry.cpp
+date: 2026/10/16
+*/
+#include "core/network/server_registry.h"
+#include <arpa/inet.h>
+#include <algorithm>
+
+// 广播中的摄像头数量：整数，或摄像头数组
+static int beaconCameraCount(const Json::Value& beacon) {
+    const Json::Value& cameras = beacon["cameras"];
+    if (cameras.isIntegral()) return cameras.asInt();
+    if (cameras.isArray()) return static_cast<int>(cameras.size());
+    return -1;
+}
+
+void ServerRegistry::setDeltaCallback(DeltaCallback callback) {
+    std::lock_guard<std::mutex> lock(delivery_mutex_);
+    callback_ = std::move(callback);
+}
+
+bool ServerRegistry::observeDatagram(uint32_t address, const char* data, size_t length, Json::Value* beacon,
+                                     std::chrono::steady_clock::time_point now) {
+    Json::Value parsed;
+    Json::Value& value = beacon ? *beacon : parsed;
+    if (!Json::Reader().parse(data, data + length, value)) return false;
+    return observe(address, value, now);
+}
+
+bool ServerRegistry::observe(uint32_t address, const Json::Value& beacon,
+                             std::chrono::steady_clock::time_point now) {
+    const Json::Value& port_value = beacon["heartbeat_port"];
+    if (!beacon.isObject() || !port_value.isIntegral()) return false;
+    const int port = port_value.asInt();
+    if (port <= 0 || port > 65535) return false;
+    const std::string name = beacon["name"].isString() ? beacon["name"].asString() : std::string();
+    const int camera_count = beaconCameraCount(beacon);
+
+    std::lock_guard<std::mutex> delivery(delivery_mutex_);
+    ServerRegistryDelta delta;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(makeKey(address, port));
+        if (it == entries_.end()) {
+            ServerEntry entry;
+            char ip[INET_ADDRSTRLEN] = {0};
+            in_addr addr{};
+            addr.s_addr = address;
+            inet_ntop(AF_INET, &addr, ip, sizeof(ip));
+            entry.ip = ip;
+            entry.heartbeat_port = port;
+            entry.name = name;
+            entry.camera_count = camera_count;
+            entry.order = next_order_++;
+            entry.generation = ++generation_;
+            entry.last_seen = now;
+            delta.added.push_back(entry);
+            entries_.emplace(makeKey(address, port), std::move(entry));
+        } else {
+            ServerEntry& entry = it->second;
+            entry.last_seen = now;
+            if (entry.name == name && entry.camera_count == camera_count) {
+                return false;  // 重复广播
+            }
+            entry.name = name;
+            entry.camera_count = camera_count;
+            entry.generation = ++generation_;
+            delta.updated.push_back(entry);
+        }
+        delta.generation = generation_;
+    }
+    deliver(delta);
+    return true;
+}
+
+size_t ServerRegistry::expire(std::chrono::steady_clock::time_point cutoff) {
+    std::lock_guard<std::mutex> delivery(delivery_mutex_);
+    ServerRegistryDelta delta;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = entries_.begin(); it != entries_.end();) {
+            if (it->second.last_seen < cutoff) {
+                delta.removed.push_back(std::move(it->second));
+                it = entries_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        if (delta.removed.empty()) return 0;
+        delta.generation = ++generation_;
+    }
+    deliver(delta);
+    return delta.removed.size();
+}
+
+void ServerRegistry::clear() {
+    std::lock_guard<std::mutex> delivery(delivery_mutex_);
+    ServerRegistryDelta delta;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (entries_.empty()) return;
+        delta.removed.reserve(entries_.size());
+        for (auto& item : entries_) {
+            delta.removed.push_back(std::move(item.second));
+        }
+        entries_.clear();
+        delta.generation = ++generation_;
+    }
+    deliver(delta);
+}
+
+std::vector<ServerEntry> ServerRegistry::snapshot() const {
+    std::vector<ServerEntry> servers;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        servers.reserve(entries_.size());
+        for (const auto& item : entries_) {
+            servers.push_back(item.second);
+        }
+    }
+    std::sort(servers.begin(), servers.end(),
+              [](const ServerEntry& a, const ServerEntry& b) { return a.order < b.order; });
+    return servers;
+}
+
+size_t ServerRegistry::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+uint64_t ServerRegistry::generation() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return generation_;
+}
+
+// 调用时持有delivery_mutex_、不持有mutex_
+void ServerRegistry::deliver(const ServerRegistryDelta& delta) {
+    if (callback_ && !delta.empty()) {
+        callback_(delta);
+    }
+}
@@ -0,0 +1,91 @@
+/*
+file: src/core/network/server_registry.h
+date: 2026/10/16
+*/
+#ifndef SERVER_REGISTRY_H
+#define SERVER_REGISTRY_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <json/json.h>
+
+// 发现的服务器（以ip+heartbeat_port为键）
+struct ServerEntry {
+    std::string ip;                 // 广播的来源地址
+    int heartbeat_port = 0;         // 控制/心跳端口
+    std::string name;               // 广播中的name，未提供时为空
+    int camera_count = -1;          // 广播中的摄像头数量，未提供时为-1
+    uint64_t order = 0;             // 首次发现的顺序，列表按此排序以保持稳定
+    uint64_t generation = 0;        // 最近一次新增或内容变化时的注册表代数
+    std::chrono::steady_clock::time_point last_seen;
+
+    // 列表中显示的名称（没有name时用地址和端口）
+    std::string displayName() const {
+        return name.empty() ? ip + ":" + std::to_string(heartbeat_port) : name;
+    }
+};
+
+// 一次变化（按代数顺序交付）
+struct ServerRegistryDelta {
+    uint64_t generation = 0;        // 本次变化后的注册表代数
+    std::vector<ServerEntry> added;
+    std::vector<ServerEntry> updated;
+    std::vector<ServerEntry> removed;
+
+    bool empty() const { return added.empty() && updated.empty() && removed.empty(); }
+};
+
+// 服务器注册表
+// 以哈希表索引，每条广播O(1)查找去重；内容不变的重复广播只刷新last_seen，不产生回调。
+// 变化以增量回调交付：在注册表锁外调用（回调中可以读取注册表），各次变化按代数顺序串行交付；
+// 回调中不能再修改注册表。
+class ServerRegistry {
+public:
+    using DeltaCallback = std::function<void(const ServerRegistryDelta& delta)>;
+
+    ServerRegistry() = default;
+    ServerRegistry(const ServerRegistry&) = delete;
+    ServerRegistry& operator=(const ServerRegistry&) = delete;
+
+    void setDeltaCallback(DeltaCallback callback);
+
+    // 处理一条发现广播（address为网络字节序的IPv4来源地址），有新增或变化时返回true
+    bool observe(uint32_t address, const Json::Value& beacon,
+                 std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+
+    // 解析一条发现数据报（JSON）后交给observe()；解析失败或无变化时返回false，beacon非空时输出解析结果
+    bool observeDatagram(uint32_t address, const char* data, size_t length, Json::Value* beacon = nullptr,
+                         std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+
+    // 移除last_seen早于cutoff的条目（作为removed交付），返回移除的数量
+    size_t expire(std::chrono::steady_clock::time_point cutoff);
+
+    // 清空注册表，全部条目作为removed交付
+    void clear();
+
+    // 当前全部条目，按首次发现的顺序
+    std::vector<ServerEntry> snapshot() const;
+    size_t size() const;
+    uint64_t generation() const;
+
+private:
+    static uint64_t makeKey(uint32_t address, int heartbeat_port) {
+        return (static_cast<uint64_t>(address) << 16) | static_cast<uint16_t>(heartbeat_port);
+    }
+    void deliver(const ServerRegistryDelta& delta);
+
+    mutable std::mutex mutex_;                      // 保护以下成员
+    std::unordered_map<uint64_t, ServerEntry> entries_;
+    uint64_t generation_ = 0;
+    uint64_t next_order_ = 0;
+
+    std::mutex delivery_mutex_;                     // 串行化变化与交付（先于mutex_加锁）
+    DeltaCallback callback_;
+};
+
+#endif // SERVER_REGISTRY_H
@@ -0,0 +1,296 @@
+/*
+file: src/core/network/udp_batch_receiver.cpp
+date: 2026/10/16
+*/
+#include "core/network/udp_batch_receiver.h"
+#include <gst/app/gstappsrc.h>
+#include <gio/gio.h>
+#include <sys/socket.h>
+#include <linux/sock_diag.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <poll.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+
+#ifndef SOL_UDP
+#define SOL_UDP 17
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+#ifndef SO_MEMINFO
+#define SO_MEMINFO 55
+#endif
+
+// 无数据时的等待上限，决定stop()的响应延迟
+static constexpr int POLL_TIMEOUT_MS = 50;
+
+// 不启用GRO时每个接收槽容纳一个RTP包（路径MTU以内）
+static constexpr size_t PACKET_SLOT_SIZE = 2048;
+// GRO合并后的数据报最大长度
+static constexpr size_t GRO_SLOT_SIZE = 65536;
+
+// 每个数据报的控制消息：GRO段长(int) + SO_RXQ_OVFL丢包计数(uint32) + SO_TIMESTAMPNS到达时刻(timespec)
+static constexpr size_t CONTROL_SIZE =
+    CMSG_SPACE(sizeof(int)) + CMSG_SPACE(sizeof(uint32_t)) + CMSG_SPACE(sizeof(timespec));
+
+static int64_t toNanoseconds(const timespec& ts) {
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+// 把内核记录的到达时刻（CLOCK_REALTIME）换算为管道running time：
+// 以recvmmsg返回后同时读取的running time和系统时间为基准，减去数据报在接收队列中等待的时长
+static GstClockTime kernelArrival(const timespec& stamp, GstClockTime now_running, int64_t now_real_ns) {
+    if (!GST_CLOCK_TIME_IS_VALID(now_running)) return now_running;
+    const int64_t queued = now_real_ns - toNanoseconds(stamp);
+    if (queued <= 0) return now_running;
+    return static_cast<GstClockTime>(queued) < now_running ? now_running - queued : 0;
+}
+
+uint64_t readSocketKernelDrops(int fd) {
+    if (fd < 0) return 0;
+    // 与/proc/net/udp的drops列是同一个计数（sk_drops），但只读本socket，无需遍历全表
+    uint32_t meminfo[SK_MEMINFO_VARS] = {};
+    socklen_t length = sizeof(meminfo);
+    if (getsockopt(fd, SOL_SOCKET, SO_MEMINFO, meminfo, &length) != 0 ||
+        length < (SK_MEMINFO_DROPS + 1) * sizeof(uint32_t)) {
+        return 0;
+    }
+    return meminfo[SK_MEMINFO_DROPS];
+}
+
+int dupUdpSrcSocket(GstElement* udpsrc) {
+    if (!udpsrc) return -1;
+    GSocket* socket = nullptr;
+    g_object_get(udpsrc, "used-socket", &socket, nullptr);
+    if (!socket) return -1;
+    const int fd = dup(g_socket_get_fd(socket));
+    g_object_unref(socket);
+    return fd;
+}
+
+static GstBufferPool* createPool(size_t size, guint min_buffers) {
+    GstBufferPool* pool = gst_buffer_pool_new();
+    GstStructure* config = gst_buffer_pool_get_config(pool);
+    gst_buffer_pool_config_set_params(config, nullptr, static_cast<guint>(size), min_buffers, 0);
+    if (!gst_buffer_pool_set_config(pool, config) || !gst_buffer_pool_set_active(pool, TRUE)) {
+        gst_object_unref(pool);
+        return nullptr;
+    }
+    return pool;
+}
+
+UdpBatchReceiver::~UdpBatchReceiver() {
+    close();
+}
+
+bool UdpBatchReceiver::open(int port, int receive_buffer_bytes, int fd) {
+    close();
+
+    const bool adopted = fd >= 0;
+    fd_ = adopted ? fd : socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd_ < 0) {
+        std::cerr << "UDP批量接收: 创建socket失败: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    const int one = 1;
+    if (!adopted) {
+        setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    }
+
+    // CAP_NET_ADMIN时可越过net.core.rmem_max；内核返回的大小是设置值的两倍（含簿记开销）
+    if (receive_buffer_bytes > 0 &&
+        setsockopt(fd_, SOL_SOCKET, SO_RCVBUFFORCE, &receive_buffer_bytes, sizeof(receive_buffer_bytes)) != 0) {
+        setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &receive_buffer_bytes, sizeof(receive_buffer_bytes));
+    }
+    socklen_t length = sizeof(receive_buffer_bytes_);
+    getsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &receive_buffer_bytes_, &length);
+    if (receive_buffer_bytes_ / 2 < receive_buffer_bytes) {
+        std::cerr << "UDP批量接收: 接收缓冲仅" << receive_buffer_bytes_ / 2 << "字节（请求"
+                  << receive_buffer_bytes << "），可调大net.core.rmem_max" << std::endl;
+    }
+
+    setsockopt(fd_, SOL_SOCKET, SO_RXQ_OVFL, &one, sizeof(one));
+    setsockopt(fd_, SOL_SOCKET, SO_TIMESTAMPNS, &one, sizeof(one));
+    gro_ = setsockopt(fd_, SOL_UDP, UDP_GRO, &one, sizeof(one)) == 0;
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = INADDR_ANY;
+    if (!adopted && bind(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        std::cerr << "UDP批量接收: 绑定端口" << port << "失败: " << strerror(errno) << std::endl;
+        close();
+        return false;
+    }
+
+    // 未启用GRO时两批接收槽常驻（一批在途于管道，一批用于下一次recvmmsg）；
+    // GRO时接收槽拆包后立即归还，常驻一批即可
+    slot_size_ = gro_ ? GRO_SLOT_SIZE : PACKET_SLOT_SIZE;
+    slot_pool_ = createPool(slot_size_, gro_ ? BATCH_SIZE : 2 * BATCH_SIZE);
+    if (gro_) {
+        packet_pool_ = createPool(PACKET_SLOT_SIZE, 4 * BATCH_SIZE);
+    }
+    if (!slot_pool_ || (gro_ && !packet_pool_)) {
+        std::cerr << "UDP批量接收: 创建缓冲池失败" << std::endl;
+        close();
+        return false;
+    }
+
+    packets_.store(0);
+    batches_.store(0);
+    kernel_drops_.store(0);
+    return true;
+}
+
+void UdpBatchReceiver::close() {
+    stop();
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    for (GstBufferPool** pool : {&slot_pool_, &packet_pool_}) {
+        if (*pool) {
+            gst_buffer_pool_set_active(*pool, FALSE);
+            gst_object_unref(*pool);
+            *pool = nullptr;
+        }
+    }
+    gro_ = false;
+}
+
+void UdpBatchReceiver::start(GstElement* appsrc) {
+    if (running_ || fd_ < 0 || !appsrc) return;
+    appsrc_ = appsrc;
+    running_ = true;
+    thread_ = std::thread(&UdpBatchReceiver::run, this);
+}
+
+void UdpBatchReceiver::stop() {
+    running_ = false;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    appsrc_ = nullptr;
+}
+
+// 与udpsrc相同，以管道running time作为到达时刻（jitterbuffer按DTS计算抖动）；
+// 各数据报再按各自的内核时间戳往前修正，见kernelArrival
+GstClockTime UdpBatchReceiver::runningTime() const {
+    GstClock* clock = gst_element_get_clock(appsrc_);
+    if (!clock) return GST_CLOCK_TIME_NONE;
+    const GstClockTime now = gst_clock_get_time(clock);
+    gst_object_unref(clock);
+    const GstClockTime base = gst_element_get_base_time(appsrc_);
+    return now > base ? now - base : 0;
+}
+
+// 将一个数据报加入buffer list（接管buffer的所有权）
+// 未合并时buffer本身即一个RTP包，裁剪长度后零拷贝推送；GRO合并的数据报按段长拷贝到单包buffer
+void UdpBatchReceiver::addDatagram(GstBufferList* list, GstBuffer* buffer, size_t length,
+                                   int segment_size, GstClockTime arrival) {
+    if (segment_size <= 0 || length <= static_cast<size_t>(segment_size)) {
+        gst_buffer_resize(buffer, 0, length);
+        GST_BUFFER_PTS(buffer) = arrival;
+        GST_BUFFER_DTS(buffer) = arrival;
+        gst_buffer_list_add(list, buffer);
+        packets_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    GstMapInfo map;
+    if (!gst_buffer_map(buffer, &map, GST_MAP_READ)) {
+        gst_buffer_unref(buffer);
+        return;
+    }
+    for (size_t offset = 0; offset < length; offset += segment_size) {
+        const size_t size = std::min(length - offset, static_cast<size_t>(segment_size));
+        GstBuffer* packet = nullptr;
+        if (size > PACKET_SLOT_SIZE ||
+            gst_buffer_pool_acquire_buffer(packet_pool_, &packet, nullptr) != GST_FLOW_OK) {
+            packet = gst_buffer_new_allocate(nullptr, size, nullptr);
+        }
+        gst_buffer_fill(packet, 0, map.data + offset, size);
+        gst_buffer_set_size(packet, size);
+        GST_BUFFER_PTS(packet) = arrival;
+        GST_BUFFER_DTS(packet) = arrival;
+        gst_buffer_list_add(list, packet);
+        packets_.fetch_add(1, std::memory_order_relaxed);
+    }
+    gst_buffer_unmap(buffer, &map);
+    gst_buffer_unref(buffer);
+}
+
+void UdpBatchReceiver::run() {
+    mmsghdr messages[BATCH_SIZE];
+    iovec vectors[BATCH_SIZE];
+    GstBuffer* buffers[BATCH_SIZE];
+    GstMapInfo maps[BATCH_SIZE];
+    alignas(cmsghdr) char control[BATCH_SIZE][CONTROL_SIZE];
+
+    while (running_) {
+        pollfd fd{fd_, POLLIN, 0};
+        if (poll(&fd, 1, POLL_TIMEOUT_MS) <= 0) continue;
+
+        // 准备接收槽：直接收进缓冲池的内存
+        int prepared = 0;
+        for (; prepared < BATCH_SIZE; ++prepared) {
+            GstBuffer*& buffer = buffers[prepared];
+            if (gst_buffer_pool_acquire_buffer(slot_pool_, &buffer, nullptr) != GST_FLOW_OK) break;
+            if (!gst_buffer_map(buffer, &maps[prepared], GST_MAP_WRITE)) {
+                gst_buffer_unref(buffer);
+                break;
+            }
+            vectors[prepared] = {maps[prepared].data, maps[prepared].size};
+            messages[prepared] = {};
+            messages[prepared].msg_hdr.msg_iov = &vectors[prepared];
+            messages[prepared].msg_hdr.msg_iovlen = 1;
+            messages[prepared].msg_hdr.msg_control = control[prepared];
+            messages[prepared].msg_hdr.msg_controllen = CONTROL_SIZE;
+        }
+        if (prepared == 0) continue;
+
+        const int received = recvmmsg(fd_, messages, prepared, MSG_DONTWAIT, nullptr);
+        const GstClockTime now_running = runningTime();
+        timespec now_real{};
+        clock_gettime(CLOCK_REALTIME, &now_real);
+        GstBufferList* list = received > 0 ? gst_buffer_list_new_sized(received) : nullptr;
+
+        for (int i = 0; i < prepared; ++i) {
+            gst_buffer_unmap(buffers[i], &maps[i]);
+            if (i >= received) {
+                gst_buffer_unref(buffers[i]);  // 未用到的槽直接归还
+                continue;
+            }
+
+            int segment_size = 0;
+            GstClockTime arrival = now_running;  // 没有内核时间戳时退回批次的接收时刻
+            msghdr& header = messages[i].msg_hdr;
+            for (cmsghdr* cmsg = CMSG_FIRSTHDR(&header); cmsg; cmsg = CMSG_NXTHDR(&header, cmsg)) {
+                if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+                    memcpy(&segment_size, CMSG_DATA(cmsg), sizeof(segment_size));
+                } else if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_RXQ_OVFL) {
+                    uint32_t drops = 0;
+                    memcpy(&drops, CMSG_DATA(cmsg), sizeof(drops));
+                    kernel_drops_.store(drops, std::memory_order_relaxed);  // socket生命周期内的累计值
+                } else if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+                    timespec stamp{};
+                    memcpy(&stamp, CMSG_DATA(cmsg), sizeof(stamp));
+                    arrival = kernelArrival(stamp, now_running, toNanoseconds(now_real));
+                }
+            }
+            addDatagram(list, buffers[i], messages[i].msg_len, segment_size, arrival);
+        }
+
+        if (list) {
+            batches_.fetch_add(1, std::memory_order_relaxed);
+            // 管道停止或未进入PLAYING时推送失败，list已被appsrc接管
+            gst_app_src_push_buffer_list(GST_APP_SRC(appsrc_), list);
+        }
+    }
+}
@@ -0,0 +1,72 @@
+/*
+file: src/core/network/udp_batch_receiver.h
+date: 2026/10/16
+*/
+#ifndef UDP_BATCH_RECEIVER_H
+#define UDP_BATCH_RECEIVER_H
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <gst/gst.h>
+
+// 读取socket自身的内核丢包计数（接收缓冲溢出，SO_MEMINFO），读取失败返回0
+uint64_t readSocketKernelDrops(int fd);
+
+// 复制udpsrc正在使用的socket（进入READY后才有），失败返回-1；返回的fd由调用方关闭
+int dupUdpSrcSocket(GstElement* udpsrc);
+
+// 高吞吐UDP接收
+// 用recvmmsg一次系统调用收取最多BATCH_SIZE个数据报，直接写入缓冲池中的buffer，
+// 以buffer list经appsrc推入管道（代替udpsrc的逐包接收）。内核支持UDP GRO时
+// 合并后的数据报按段长拆回单个RTP包。内核丢包计数通过SO_RXQ_OVFL随数据报返回，
+// 每个数据报的PTS/DTS取自SO_TIMESTAMPNS记录的内核到达时刻，同一批内排队的包不会共用一个时间戳。
+class UdpBatchReceiver {
+public:
+    static constexpr int BATCH_SIZE = 64;
+
+    UdpBatchReceiver() = default;
+    ~UdpBatchReceiver();
+
+    UdpBatchReceiver(const UdpBatchReceiver&) = delete;
+    UdpBatchReceiver& operator=(const UdpBatchReceiver&) = delete;
+
+    // 绑定端口并设置接收缓冲（字节，先尝试SO_RCVBUFFORCE，再退回受rmem_max限制的SO_RCVBUF）
+    // fd >= 0时接管调用方已绑定到该端口的socket，不再重新绑定（失败时同样关闭它）
+    bool open(int port, int receive_buffer_bytes, int fd = -1);
+    void close();
+
+    // 启动接收线程，向appsrc推送；appsrc须在stop()之后才能销毁
+    void start(GstElement* appsrc);
+    void stop();
+
+    bool isOpen() const { return fd_ >= 0; }
+    bool groEnabled() const { return gro_; }
+    int receiveBufferBytes() const { return receive_buffer_bytes_; }  // 内核实际分配的大小
+
+    uint64_t packets() const { return packets_.load(std::memory_order_relaxed); }
+    uint64_t batches() const { return batches_.load(std::memory_order_relaxed); }
+    uint64_t kernelDrops() const { return kernel_drops_.load(std::memory_order_relaxed); }
+
+private:
+    void run();
+    GstClockTime runningTime() const;
+    void addDatagram(GstBufferList* list, GstBuffer* buffer, size_t length, int segment_size,
+                     GstClockTime arrival);
+
+    int fd_ = -1;
+    bool gro_ = false;
+    int receive_buffer_bytes_ = 0;
+    size_t slot_size_ = 0;                   // 每个接收槽的大小（GRO时为最大合并数据报）
+    GstBufferPool* slot_pool_ = nullptr;     // 接收槽
+    GstBufferPool* packet_pool_ = nullptr;   // GRO拆包后的单个RTP包（仅GRO时创建）
+    GstElement* appsrc_ = nullptr;
+
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> packets_{0};
+    std::atomic<uint64_t> batches_{0};
+    std::atomic<uint64_t> kernel_drops_{0};
+};
+
+#endif // UDP_BATCH_RECEIVER_H
@@ -0,0 +1,242 @@
+/*
+file: src/core/replay/replay_source.cpp
+date: 2026/10/16
+*/
+#include "core/replay/replay_source.h"
+#include <gst/rtp/gstrtpbuffer.h>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include "core/video/latency_tracker.h"
+
+// rtpdump文件头：文本行"#!rtpplay1.0 地址/端口\n"之后是16字节的二进制头
+// （开始时间秒/微秒、源地址、端口、填充），随后每个包前有8字节的包头（均为网络字节序）
+static const char RTPDUMP_MAGIC[] = "#!rtpplay1.0 ";
+static constexpr size_t RTPDUMP_FILE_HEADER = 16;
+static constexpr size_t RTPDUMP_PACKET_HEADER = 8;
+
+static uint16_t readBe16(const uint8_t* data) {
+    return static_cast<uint16_t>((data[0] << 8) | data[1]);
+}
+
+static uint32_t readBe32(const uint8_t* data) {
+    return (static_cast<uint32_t>(data[0]) << 24) | (static_cast<uint32_t>(data[1]) << 16) |
+           (static_cast<uint32_t>(data[2]) << 8) | data[3];
+}
+
+static bool endsWith(const std::string& text, const char* suffix) {
+    const size_t length = strlen(suffix);
+    return text.size() >= length && text.compare(text.size() - length, length, suffix) == 0;
+}
+
+bool replayFormatFromPath(const std::string& path, ReplayFormat* format) {
+    if (endsWith(path, ".h264") || endsWith(path, ".264")) {
+        *format = ReplayFormat::H264;
+        return true;
+    }
+    if (endsWith(path, ".rtpdump") || endsWith(path, ".rtp")) {
+        *format = ReplayFormat::RtpDump;
+        return true;
+    }
+    return false;
+}
+
+ReplaySource::~ReplaySource() {
+    close();
+}
+
+bool ReplaySource::open(const std::string& path, ReplayFormat format, double fps, int payload_type) {
+    close();
+    format_ = format;
+
+    if (format == ReplayFormat::RtpDump) {
+        file_ = fopen(path.c_str(), "rb");
+        if (!file_) {
+            std::cerr << "回放: 无法打开 " << path << std::endl;
+            return false;
+        }
+        char line[256];
+        uint8_t header[RTPDUMP_FILE_HEADER];
+        if (!fgets(line, sizeof(line), file_) || strncmp(line, RTPDUMP_MAGIC, strlen(RTPDUMP_MAGIC)) != 0 ||
+            fread(header, 1, sizeof(header), file_) != sizeof(header)) {
+            std::cerr << "回放: 不是rtpdump文件: " << path << std::endl;
+            close();
+            return false;
+        }
+        // 预读第一个包以取得负载类型
+        if (!nextRtpDump(&pending_, &pending_offset_ns_)) {
+            std::cerr << "回放: 文件中没有RTP包: " << path << std::endl;
+            close();
+            return false;
+        }
+        GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+        if (gst_rtp_buffer_map(pending_, GST_MAP_READ, &rtp)) {
+            payload_type_ = gst_rtp_buffer_get_payload_type(&rtp);
+            gst_rtp_buffer_unmap(&rtp);
+        }
+        return true;
+    }
+
+    // 裸流没有时间戳：按解码顺序以固定帧率打时间戳（假定没有B帧）
+    const std::string desc =
+        "filesrc name=file ! h264parse name=parse ! video/x-h264,stream-format=byte-stream,alignment=au ! "
+        "rtph264pay pt=" + std::to_string(payload_type) + " mtu=1200 config-interval=-1 ! "
+        "appsink name=out sync=false emit-signals=false max-buffers=256";
+    GError* error = nullptr;
+    packetizer_ = gst_parse_launch(desc.c_str(), &error);
+    if (error) {
+        std::cerr << "回放: 无法创建打包管道: " << error->message << std::endl;
+        g_error_free(error);
+        close();
+        return false;
+    }
+    GstElement* file = gst_bin_get_by_name(GST_BIN(packetizer_), "file");
+    g_object_set(file, "location", path.c_str(), nullptr);
+    gst_object_unref(file);
+
+    frame_duration_ = static_cast<GstClockTime>(GST_SECOND / (fps > 0 ? fps : 30.0));
+    frames_stamped_ = 0;
+    GstElement* parse = gst_bin_get_by_name(GST_BIN(packetizer_), "parse");
+    GstPad* pad = gst_element_get_static_pad(parse, "src");
+    gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, &ReplaySource::onParsedFrame, this, nullptr);
+    gst_object_unref(pad);
+    gst_object_unref(parse);
+
+    packetizer_sink_ = GST_APP_SINK(gst_bin_get_by_name(GST_BIN(packetizer_), "out"));
+    if (gst_element_set_state(packetizer_, GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE) {
+        std::cerr << "回放: 无法读取 " << path << std::endl;
+        close();
+        return false;
+    }
+    payload_type_ = payload_type;
+    return true;
+}
+
+void ReplaySource::close() {
+    if (file_) {
+        fclose(file_);
+        file_ = nullptr;
+    }
+    if (pending_) {
+        gst_buffer_unref(pending_);
+        pending_ = nullptr;
+    }
+    if (packetizer_) {
+        gst_element_set_state(packetizer_, GST_STATE_NULL);
+        if (packetizer_sink_) gst_object_unref(packetizer_sink_);
+        gst_object_unref(packetizer_);
+        packetizer_sink_ = nullptr;
+        packetizer_ = nullptr;
+    }
+    payload_type_ = -1;
+}
+
+uint64_t ReplaySource::run(ReplaySpeed speed, const PacketCallback& callback, const std::atomic<bool>& cancel) {
+    uint64_t delivered = 0;
+    GstBufferList* list = nullptr;
+    auto flush = [&]() {
+        if (!list) return true;
+        GstBufferList* batch = list;
+        list = nullptr;
+        return callback(batch);
+    };
+
+    const int64_t start_ns = steadyNowNs();
+    GstBuffer* packet = nullptr;
+    int64_t offset_ns = 0;
+    bool stopped = false;
+    while (!cancel.load(std::memory_order_relaxed) && next(&packet, &offset_ns)) {
+        if (speed == ReplaySpeed::Realtime) {
+            // 同一时刻到期的包合并为一批，先交付已攒下的包再等待
+            const int64_t wait_ns = start_ns + offset_ns - steadyNowNs();
+            if (wait_ns > 0) {
+                if (!flush()) {
+                    gst_buffer_unref(packet);
+                    stopped = true;
+                    break;
+                }
+                std::this_thread::sleep_for(std::chrono::nanoseconds(wait_ns));
+            }
+        }
+        if (!list) list = gst_buffer_list_new_sized(BATCH_SIZE);
+        gst_buffer_list_add(list, packet);
+        delivered++;
+        if (gst_buffer_list_length(list) >= BATCH_SIZE && !flush()) {
+            stopped = true;
+            break;
+        }
+    }
+    if (!stopped) {
+        flush();
+    } else if (list) {
+        gst_buffer_list_unref(list);
+    }
+    return delivered;
+}
+
+bool ReplaySource::next(GstBuffer** packet, int64_t* offset_ns) {
+    if (pending_) {
+        *packet = pending_;
+        *offset_ns = pending_offset_ns_;
+        pending_ = nullptr;
+        return true;
+    }
+    return format_ == ReplayFormat::RtpDump ? nextRtpDump(packet, offset_ns) : nextH264(packet, offset_ns);
+}
+
+// 读取下一个RTP包，跳过RTCP（plen为0）和截断的包
+bool ReplaySource::nextRtpDump(GstBuffer** packet, int64_t* offset_ns) {
+    if (!file_) return false;
+    uint8_t header[RTPDUMP_PACKET_HEADER];
+    while (fread(header, 1, sizeof(header), file_) == sizeof(header)) {
+        const uint16_t length = readBe16(header);
+        const uint16_t rtp_length = readBe16(header + 2);
+        const uint32_t offset_ms = readBe32(header + 4);
+        if (length < RTPDUMP_PACKET_HEADER) return false;
+        const size_t data_length = length - RTPDUMP_PACKET_HEADER;
+
+        if (rtp_length == 0 || rtp_length > data_length) {
+            if (fseek(file_, static_cast<long>(data_length), SEEK_CUR) != 0) return false;
+            continue;
+        }
+        GstBuffer* buffer = gst_buffer_new_allocate(nullptr, data_length, nullptr);
+        GstMapInfo map;
+        gst_buffer_map(buffer, &map, GST_MAP_WRITE);
+        const bool complete = fread(map.data, 1, data_length, file_) == data_length;
+        gst_buffer_unmap(buffer, &map);
+        if (!complete) {
+            gst_buffer_unref(buffer);
+            return false;
+        }
+        gst_buffer_set_size(buffer, rtp_length);
+        *packet = buffer;
+        *offset_ns = static_cast<int64_t>(offset_ms) * 1000000;
+        return true;
+    }
+    return false;
+}
+
+// 从打包管道取下一个RTP包，包的PTS即所属帧的回放时刻
+bool ReplaySource::nextH264(GstBuffer** packet, int64_t* offset_ns) {
+    if (!packetizer_sink_) return false;
+    GstSample* sample = gst_app_sink_pull_sample(packetizer_sink_);
+    if (!sample) return false;  // EOS或出错
+    GstBuffer* buffer = gst_buffer_ref(gst_sample_get_buffer(sample));
+    gst_sample_unref(sample);
+    const GstClockTime pts = GST_BUFFER_PTS(buffer);
+    *packet = buffer;
+    *offset_ns = GST_CLOCK_TIME_IS_VALID(pts) ? static_cast<int64_t>(pts) : 0;
+    return true;
+}
+
+GstPadProbeReturn ReplaySource::onParsedFrame(GstPad*, GstPadProbeInfo* info, gpointer user_data) {
+    auto* self = static_cast<ReplaySource*>(user_data);
+    GstBuffer* buffer = gst_buffer_make_writable(GST_PAD_PROBE_INFO_BUFFER(info));
+    const GstClockTime pts = self->frames_stamped_++ * self->frame_duration_;
+    GST_BUFFER_PTS(buffer) = pts;
+    GST_BUFFER_DTS(buffer) = pts;
+    GST_BUFFER_DURATION(buffer) = self->frame_duration_;
+    GST_PAD_PROBE_INFO_DATA(info) = buffer;
+    return GST_PAD_PROBE_OK;
+}
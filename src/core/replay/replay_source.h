@@ -0,0 +1,77 @@
+/*
+file: src/core/replay/replay_source.h
+date: 2026/10/16
+*/
+#ifndef REPLAY_SOURCE_H
+#define REPLAY_SOURCE_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <gst/gst.h>
+#include <gst/app/gstappsink.h>
+
+// 回放输入格式
+enum class ReplayFormat {
+    RtpDump,   // rtptools的rtpdump格式（Wireshark: RTP流 -> 另存为rtpdump）
+    H264       // H.264 Annex B裸流，按固定帧率打时间戳后经rtph264pay打包
+};
+
+// 回放速度
+enum class ReplaySpeed {
+    Realtime,  // 按录制时的包间隔（裸流按帧率）交付
+    Max        // 不等待，由接收管道的反压决定速度
+};
+
+// 按扩展名推断格式（.h264/.264为裸流，其余按rtpdump），未知时返回false
+bool replayFormatFromPath(const std::string& path, ReplayFormat* format);
+
+// 回放输入：把录制的RTP包按原有节奏（或尽快）以buffer list交给调用方
+class ReplaySource {
+public:
+    // 交付一批包（接管list），返回false时停止回放
+    using PacketCallback = std::function<bool(GstBufferList*)>;
+
+    static constexpr guint BATCH_SIZE = 64;
+
+    ReplaySource() = default;
+    ~ReplaySource();
+
+    ReplaySource(const ReplaySource&) = delete;
+    ReplaySource& operator=(const ReplaySource&) = delete;
+
+    // fps和payload_type仅用于H.264裸流
+    bool open(const std::string& path, ReplayFormat format, double fps, int payload_type);
+    void close();
+
+    // 在调用线程中回放全部输入，返回交付的包数；cancel置位时提前结束
+    uint64_t run(ReplaySpeed speed, const PacketCallback& callback, const std::atomic<bool>& cancel);
+
+    // 码流的RTP负载类型（rtpdump取第一个RTP包，未知时为-1）
+    int payloadType() const { return payload_type_; }
+
+private:
+    // 下一个RTP包及其相对回放起点的时刻，输入结束时返回false
+    bool next(GstBuffer** packet, int64_t* offset_ns);
+    bool nextRtpDump(GstBuffer** packet, int64_t* offset_ns);
+    bool nextH264(GstBuffer** packet, int64_t* offset_ns);
+    static GstPadProbeReturn onParsedFrame(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+
+    ReplayFormat format_ = ReplayFormat::RtpDump;
+    int payload_type_ = -1;
+
+    // rtpdump
+    FILE* file_ = nullptr;
+    GstBuffer* pending_ = nullptr;     // open()时为取得负载类型预读的第一个包
+    int64_t pending_offset_ns_ = 0;
+
+    // H.264裸流：filesrc ! h264parse ! rtph264pay ! appsink
+    GstElement* packetizer_ = nullptr;
+    GstAppSink* packetizer_sink_ = nullptr;
+    GstClockTime frame_duration_ = 0;
+    uint64_t frames_stamped_ = 0;      // 仅在打包管道的流线程中访问
+};
+
+#endif // REPLAY_SOURCE_H
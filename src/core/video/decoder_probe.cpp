@@ -0,0 +1,280 @@
+/*
+file: src/core/video/decoder_probe.cpp
+date: 2026/10/16
+*/
+#include "core/video/decoder_probe.h"
+#include <gst/app/gstappsrc.h>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+// 各编码格式的解码器与测试码流
+// 解码器按偏好顺序：硬件（NVDEC、VA-API、Intel Media SDK、V4L2 M2M）在前，软件在后
+enum class ClipFormat {
+    ByteStream,  // Annex B裸流，整段推入由解析器分帧
+    Ivf,         // IVF容器，逐帧推入
+    Jpeg         // 单帧JPEG（每帧独立编码，耗时只取决于纹理），重复推入CLIP_FRAMES次
+};
+
+struct CodecCandidates {
+    VideoCodec codec;
+    std::vector<const char*> decoders;
+    const char* clip;     // 预先编码的测试码流（res/decoder_clips/下，由tools/decoder_clips/make_clips.sh生成）
+    ClipFormat format;
+    const char* caps;     // 测试码流的caps（不含尺寸和帧率）
+};
+
+static const CodecCandidates CANDIDATES[] = {
+    {VideoCodec::H264,
+     {"nvh264dec", "vah264dec", "vaapih264dec", "msdkh264dec", "v4l2h264dec", "avdec_h264", "openh264dec"},
+     "clip.h264", ClipFormat::ByteStream, "video/x-h264,stream-format=byte-stream"},
+    {VideoCodec::H265,
+     {"nvh265dec", "vah265dec", "vaapih265dec", "msdkh265dec", "v4l2h265dec", "avdec_h265"},
+     "clip.h265", ClipFormat::ByteStream, "video/x-h265,stream-format=byte-stream"},
+    {VideoCodec::VP8,
+     {"nvvp8dec", "vavp8dec", "vaapivp8dec", "v4l2vp8dec", "vp8dec", "avdec_vp8"},
+     "clip.vp8.ivf", ClipFormat::Ivf, "video/x-vp8"},
+    {VideoCodec::VP9,
+     {"nvvp9dec", "vavp9dec", "vaapivp9dec", "msdkvp9dec", "v4l2vp9dec", "vp9dec", "avdec_vp9"},
+     "clip.vp9.ivf", ClipFormat::Ivf, "video/x-vp9"},
+    {VideoCodec::MJPEG,
+     {"nvjpegdec", "vajpegdec", "vaapijpegdec", "v4l2jpegdec", "jpegdec", "avdec_mjpeg"},
+     "clip.jpg", ClipFormat::Jpeg, "image/jpeg"},
+};
+
+static const char* const HARDWARE_PREFIXES[] = {"nv", "va", "msdk", "v4l2"};
+
+static const CodecCandidates& candidatesFor(VideoCodec codec) {
+    for (const auto& candidates : CANDIDATES) {
+        if (candidates.codec == codec) return candidates;
+    }
+    return CANDIDATES[0];
+}
+
+// 测试码流参数：720p、60帧的Mandelbrot缩放画面，每帧都有运动和细节，
+// 码率与720p摄像头码流相当（每个文件约0.5 MB），启动时不需要编码
+static const char* const CLIP_DIR = "res/decoder_clips/";
+static constexpr int CLIP_FRAMES = 60;
+static constexpr int CLIP_WIDTH = 1280;
+static constexpr int CLIP_HEIGHT = 720;
+static constexpr int CLIP_FPS = 30;
+static constexpr GstClockTime BENCH_TIMEOUT = 10 * GST_SECOND;
+
+// IVF：32字节文件头，之后每帧12字节帧头（4字节长度 + 8字节时间戳，小端）
+static constexpr size_t IVF_FILE_HEADER = 32;
+static constexpr size_t IVF_FRAME_HEADER = 12;
+
+// 解码器输出端的计时：第一帧输出之前的时间包含解码器打开、硬件上下文创建和预卷，不计入
+struct DecodeTiming {
+    int buffers = 0;
+    std::chrono::steady_clock::time_point first;
+    std::chrono::steady_clock::time_point last;
+};
+
+static GstPadProbeReturn onDecodedBuffer(GstPad*, GstPadProbeInfo*, gpointer user_data) {
+    auto* timing = static_cast<DecodeTiming*>(user_data);
+    const auto now = std::chrono::steady_clock::now();
+    if (timing->buffers++ == 0) timing->first = now;
+    timing->last = now;
+    return GST_PAD_PROBE_OK;
+}
+
+static uint32_t readLe32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static GstBuffer* wrapBytes(const uint8_t* data, size_t size, int index) {
+    GstBuffer* buffer = gst_buffer_new_allocate(nullptr, size, nullptr);
+    gst_buffer_fill(buffer, 0, data, size);
+    GST_BUFFER_PTS(buffer) = gst_util_uint64_scale_int(index, GST_SECOND, CLIP_FPS);
+    GST_BUFFER_DURATION(buffer) = gst_util_uint64_scale_int(1, GST_SECOND, CLIP_FPS);
+    return buffer;
+}
+
+std::vector<std::string> DecoderProbe::availableDecoders(VideoCodec codec) {
+    std::vector<std::string> result;
+    for (const char* name : candidatesFor(codec).decoders) {
+        GstElementFactory* factory = gst_element_factory_find(name);
+        if (factory) {
+            result.emplace_back(name);
+            gst_object_unref(factory);
+        }
+    }
+    return result;
+}
+
+bool DecoderProbe::isHardware(const std::string& element) {
+    for (const char* prefix : HARDWARE_PREFIXES) {
+        if (element.rfind(prefix, 0) == 0) return true;
+    }
+    return false;
+}
+
+std::vector<GstBuffer*> DecoderProbe::loadTestClip(VideoCodec codec, GstCaps** caps, int* frames) {
+    std::vector<GstBuffer*> stream;
+    *caps = nullptr;
+    *frames = 0;
+
+    const CodecCandidates& candidates = candidatesFor(codec);
+    const std::string path = std::string(CLIP_DIR) + candidates.clip;
+    std::ifstream file(path, std::ios::binary);
+    const std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (data.empty()) {
+        std::cerr << "未找到解码器测试码流: " << path << std::endl;
+        return stream;
+    }
+
+    switch (candidates.format) {
+        case ClipFormat::ByteStream:
+            // 整段推入，由解析器切分为帧并按caps中的帧率打时间戳
+            stream.push_back(wrapBytes(data.data(), data.size(), 0));
+            GST_BUFFER_PTS(stream.back()) = GST_CLOCK_TIME_NONE;
+            GST_BUFFER_DURATION(stream.back()) = GST_CLOCK_TIME_NONE;
+            *frames = CLIP_FRAMES;
+            break;
+        case ClipFormat::Ivf: {
+            size_t offset = IVF_FILE_HEADER;
+            while (data.size() >= IVF_FILE_HEADER && offset + IVF_FRAME_HEADER <= data.size()) {
+                const size_t size = readLe32(&data[offset]);
+                offset += IVF_FRAME_HEADER;
+                if (offset + size > data.size()) break;
+                stream.push_back(wrapBytes(&data[offset], size, static_cast<int>(stream.size())));
+                offset += size;
+            }
+            *frames = static_cast<int>(stream.size());
+            break;
+        }
+        case ClipFormat::Jpeg:
+            for (int i = 0; i < CLIP_FRAMES; ++i) {
+                stream.push_back(wrapBytes(data.data(), data.size(), i));
+            }
+            *frames = CLIP_FRAMES;
+            break;
+    }
+
+    if (stream.empty()) {
+        std::cerr << "解码器测试码流无效: " << path << std::endl;
+        return stream;
+    }
+    const std::string caps_str = std::string(candidates.caps) +
+        ",width=" + std::to_string(CLIP_WIDTH) + ",height=" + std::to_string(CLIP_HEIGHT) +
+        ",framerate=" + std::to_string(CLIP_FPS) + "/1";
+    *caps = gst_caps_from_string(caps_str.c_str());
+    return stream;
+}
+
+double DecoderProbe::benchmark(VideoCodec codec, const std::string& element,
+                               const std::vector<GstBuffer*>& stream, GstCaps* caps) {
+    const char* parser = codecInfo(codec).parser;
+    const std::string desc =
+        std::string("appsrc name=src format=time ! ") + (parser ? std::string(parser) + " ! " : "") +
+        element + " name=dec ! fakesink name=sink sync=false";
+
+    GError* error = nullptr;
+    GstElement* pipeline = gst_parse_launch(desc.c_str(), &error);
+    if (!pipeline || error) {
+        if (error) g_error_free(error);
+        if (pipeline) gst_object_unref(pipeline);
+        return -1.0;
+    }
+
+    GstElement* src = gst_bin_get_by_name(GST_BIN(pipeline), "src");
+    gst_app_src_set_caps(GST_APP_SRC(src), caps);
+    gst_app_src_set_max_bytes(GST_APP_SRC(src), 0);  // 一次性推入全部码流
+
+    // 从第一帧解码输出开始计时，按其后各帧的间隔求平均，不含解码器启动开销
+    DecodeTiming timing;
+    GstElement* decoder = gst_bin_get_by_name(GST_BIN(pipeline), "dec");
+    GstPad* decoder_src = decoder ? gst_element_get_static_pad(decoder, "src") : nullptr;
+    const bool probed = decoder_src != nullptr;
+    if (decoder_src) {
+        gst_pad_add_probe(decoder_src, GST_PAD_PROBE_TYPE_BUFFER, onDecodedBuffer, &timing, nullptr);
+        gst_object_unref(decoder_src);
+    }
+    if (decoder) gst_object_unref(decoder);
+
+    GstBus* bus = gst_element_get_bus(pipeline);
+    double result = -1.0;
+    if (probed && gst_element_set_state(pipeline, GST_STATE_PLAYING) != GST_STATE_CHANGE_FAILURE) {
+        for (GstBuffer* buffer : stream) {
+            gst_app_src_push_buffer(GST_APP_SRC(src), gst_buffer_ref(buffer));
+        }
+        gst_app_src_end_of_stream(GST_APP_SRC(src));
+
+        GstMessage* msg = gst_bus_timed_pop_filtered(bus, BENCH_TIMEOUT,
+            static_cast<GstMessageType>(GST_MESSAGE_EOS | GST_MESSAGE_ERROR));
+        // EOS在最后一帧经过探针之后才发出，此时读取timing是安全的
+        if (msg && GST_MESSAGE_TYPE(msg) == GST_MESSAGE_EOS && timing.buffers > 1) {
+            const std::chrono::duration<double, std::milli> elapsed = timing.last - timing.first;
+            result = elapsed.count() / (timing.buffers - 1);
+        }
+        if (msg) gst_message_unref(msg);
+    }
+
+    gst_element_set_state(pipeline, GST_STATE_NULL);
+    gst_object_unref(bus);
+    gst_object_unref(src);
+    gst_object_unref(pipeline);
+    return result;
+}
+
+static bool canceled(const std::atomic<bool>* cancel) {
+    return cancel && cancel->load();
+}
+
+DecoderChoice DecoderProbe::select(VideoCodec codec, const std::atomic<bool>* cancel) {
+    DecoderChoice choice;
+    choice.codec = codec;
+    choice.element = codecInfo(codec).default_decoder;
+    const std::vector<std::string> candidates = availableDecoders(codec);
+    if (candidates.empty()) {
+        std::cerr << "未找到可用的" << codecName(codec) << "解码器，使用默认 " << choice.element << std::endl;
+        return choice;
+    }
+
+    // 无法生成测试码流时按偏好顺序选择
+    choice.element = candidates.front();
+    choice.hardware = isHardware(choice.element);
+
+    GstCaps* caps = nullptr;
+    std::vector<GstBuffer*> stream;
+    int frames = 0;
+    if (!canceled(cancel)) {
+        stream = loadTestClip(codec, &caps, &frames);
+    }
+    if (!stream.empty() && caps && frames > 0) {
+        // 选择最快的；耗时相同时保留偏好顺序靠前的
+        double best = -1.0;
+        for (const auto& element : candidates) {
+            if (canceled(cancel)) break;
+            const double ms = benchmark(codec, element, stream, caps);
+            std::cout << "解码器基准: " << codecName(codec) << " " << element << " "
+                      << (ms < 0 ? std::string("失败") : std::to_string(ms) + " ms/帧") << std::endl;
+            if (ms >= 0 && (best < 0 || ms < best)) {
+                best = ms;
+                choice.element = element;
+                choice.ms_per_frame = ms;
+                choice.hardware = isHardware(element);
+            }
+        }
+    }
+
+    for (GstBuffer* buffer : stream) gst_buffer_unref(buffer);
+    if (caps) gst_caps_unref(caps);
+
+    std::cout << "选用" << codecName(codec) << "解码器: " << choice.element;
+    if (choice.ms_per_frame >= 0) std::cout << " (" << choice.ms_per_frame << " ms/帧)";
+    std::cout << std::endl;
+    return choice;
+}
+
+std::map<VideoCodec, DecoderChoice> DecoderProbe::selectAll(const std::atomic<bool>* cancel) {
+    std::map<VideoCodec, DecoderChoice> choices;
+    for (VideoCodec codec : codecsByEfficiency()) {
+        if (availableDecoders(codec).empty()) continue;
+        choices[codec] = select(codec, cancel);
+    }
+    return choices;
+}
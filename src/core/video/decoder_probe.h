@@ -0,0 +1,48 @@
+/*
+file: src/core/video/decoder_probe.h
+date: 2026/10/16
+*/
+#ifndef DECODER_PROBE_H
+#define DECODER_PROBE_H
+
+#include <atomic>
+#include <map>
+#include <string>
+#include <vector>
+#include <gst/gst.h>
+#include "core/video/video_codec.h"
+
+// 解码器选择结果
+struct DecoderChoice {
+    VideoCodec codec = VideoCodec::H264;
+    std::string element = "avdec_h264";  // GStreamer元素名
+    double ms_per_frame = -1.0;          // 基准测试的每帧解码耗时，-1表示未测量
+    bool hardware = false;
+};
+
+// 启动时探测各编码格式可用的解码器并按基准测试结果选择
+class DecoderProbe {
+public:
+    // 已安装的解码器，按偏好顺序排列（硬件优先）
+    static std::vector<std::string> availableDecoders(VideoCodec codec);
+
+    static bool isHardware(const std::string& element);
+
+    // 对候选解码器做基准测试，选出最快的一个；无法测试时按偏好顺序取第一个
+    // cancel置位后不再测试剩余的候选，直接按偏好顺序返回
+    static DecoderChoice select(VideoCodec codec = VideoCodec::H264,
+                                const std::atomic<bool>* cancel = nullptr);
+
+    // 探测所有编码格式，只返回至少有一个解码器的格式
+    static std::map<VideoCodec, DecoderChoice> selectAll(const std::atomic<bool>* cancel = nullptr);
+
+private:
+    // 读取预先编码的测试码流（res/decoder_clips/），frames为其中的帧数；文件缺失时返回空
+    static std::vector<GstBuffer*> loadTestClip(VideoCodec codec, GstCaps** caps, int* frames);
+
+    // 解码整段测试码流，返回第一帧输出之后每帧的平均解码耗时（毫秒），失败返回-1
+    static double benchmark(VideoCodec codec, const std::string& element,
+                            const std::vector<GstBuffer*>& stream, GstCaps* caps);
+};
+
+#endif // DECODER_PROBE_H
@@ -0,0 +1,56 @@
+/*
+file: src/core/video/frame_converter.cpp
+date: 2026/10/16
+*/
+#include "core/video/frame_converter.h"
+#include <iostream>
+
+VideoFrame FrameConverter::convert(const VideoFrame& src, TexturePool& pool, int dst_width, int dst_height) {
+    const GstVideoFrame* in = src.raw();
+    if (!in || !supports(src.format())) return VideoFrame();
+
+    if (dst_width <= 0 || dst_height <= 0) {
+        dst_width = src.width();
+        dst_height = src.height();
+    }
+
+    GstVideoInfo out_info;
+    gst_video_info_set_format(&out_info, GST_VIDEO_FORMAT_RGBA, dst_width, dst_height);
+
+    GstBuffer* buffer = pool.acquire(out_info);
+    if (!buffer) {
+        std::cerr << "无法从缓冲池获取输出帧: " << dst_width << "x" << dst_height << std::endl;
+        return VideoFrame();
+    }
+
+    // 保留时间戳，供延迟统计和按PTS排序使用
+    gst_buffer_copy_into(buffer, src.buffer(), GST_BUFFER_COPY_TIMESTAMPS, 0, -1);
+
+    YuvImage yuv;
+    yuv.layout = src.format() == GST_VIDEO_FORMAT_NV12 ? YuvLayout::NV12 : YuvLayout::I420;
+    yuv.width = GST_VIDEO_FRAME_WIDTH(in);
+    yuv.height = GST_VIDEO_FRAME_HEIGHT(in);
+    for (guint i = 0; i < GST_VIDEO_FRAME_N_PLANES(in) && i < 3; ++i) {
+        yuv.planes[i] = static_cast<const uint8_t*>(GST_VIDEO_FRAME_PLANE_DATA(in, i));
+        yuv.strides[i] = GST_VIDEO_FRAME_PLANE_STRIDE(in, i);
+    }
+
+    bool converted = false;
+    GstVideoFrame out;
+    if (gst_video_frame_map(&out, &out_info, buffer, GST_MAP_WRITE)) {
+        RgbaImage rgba;
+        rgba.data = static_cast<uint8_t*>(GST_VIDEO_FRAME_PLANE_DATA(&out, 0));
+        rgba.width = dst_width;
+        rgba.height = dst_height;
+        rgba.stride = GST_VIDEO_FRAME_PLANE_STRIDE(&out, 0);
+        converted = kernel_.convert(yuv, rgba);
+        gst_video_frame_unmap(&out);
+    }
+
+    VideoFrame result;
+    if (converted) {
+        result = VideoFrame::fromBuffer(buffer, out_info);
+    }
+    gst_buffer_unref(buffer);  // 结果帧持有自己的引用
+    return result;
+}
@@ -0,0 +1,34 @@
+/*
+file: src/core/video/frame_converter.h
+date: 2026/10/16
+*/
+#ifndef FRAME_CONVERTER_H
+#define FRAME_CONVERTER_H
+
+#include <gst/gst.h>
+#include <gst/video/video.h>
+#include "core/video/video_frame.h"
+#include "utils/texture_pool.h"
+#include "utils/yuv_convert.h"
+
+// 解码器原生I420/NV12帧 -> 显示尺寸RGBA帧
+// 替代管道中的videoconvert/videoscale两次遍历，输出写入缓冲池中的buffer。
+class FrameConverter {
+public:
+    FrameConverter() = default;
+
+    static bool supports(GstVideoFormat format) {
+        return format == GST_VIDEO_FORMAT_I420 || format == GST_VIDEO_FORMAT_NV12;
+    }
+
+    // 转换为dst_width x dst_height的RGBA帧（等比缩放居中，黑边填充）
+    // 尺寸为0时保持源尺寸；失败返回无效帧
+    VideoFrame convert(const VideoFrame& src, TexturePool& pool, int dst_width, int dst_height);
+
+    SimdLevel simdLevel() const { return kernel_.level(); }
+
+private:
+    YuvToRgbaConverter kernel_;
+};
+
+#endif // FRAME_CONVERTER_H
@@ -5,10 +5,24 @@ data: 2025/05/05
 */
 #include "gst_video_receiver.h"
 #include <gst/app/gstappsink.h>
+#include <gst/app/gstappsrc.h>
 #include <gst/video/video.h> 
+#include <gio/gio.h>
+#include <unistd.h>
 #include <iostream>
 #include <mutex>
 #include <atomic>
+#include <chrono>
+#include <algorithm>
+
+static constexpr auto JITTER_STATS_INTERVAL = std::chrono::seconds(1);
+
+// 每次等待样本/总线消息的上限：决定停止延迟、错误发现延迟和空闲唤醒频率
+static constexpr GstClockTime EVENT_WAIT_TIMEOUT = 50 * GST_MSECOND;
+
+// 拥塞判定：周期内丢包率超过1%、出现迟到包，或QoS报告帧迟到超过20ms
+static constexpr double CONGESTION_LOSS_RATE = 0.01;
+static constexpr int64_t CONGESTION_QOS_JITTER_NS = 20 * GST_MSECOND;
 
 GstVideoReceiver::GstVideoReceiver() 
     : pipeline_(nullptr), appsink_(nullptr), frame_callback_(nullptr),
@@ -20,17 +34,48 @@ GstVideoReceiver::~GstVideoReceiver() {
     stop();
 }
 
+static void closeFd(int& fd) {
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+// 把调用方预先绑定的socket交给udpsrc（接管fd），之后由udpsrc负责关闭
+static void adoptSocket(GstElement* pipeline, const char* name, int& fd) {
+    if (fd < 0) return;
+    GstElement* udpsrc = gst_bin_get_by_name(GST_BIN(pipeline), name);
+    if (!udpsrc) return;
+    GError* error = nullptr;
+    GSocket* socket = g_socket_new_from_fd(fd, &error);
+    if (socket) {
+        g_object_set(udpsrc, "socket", socket, "close-socket", TRUE, nullptr);
+        g_object_unref(socket);
+        fd = -1;
+    } else {
+        std::cerr << name << "无法接管socket: " << error->message << std::endl;
+        g_error_free(error);
+    }
+    gst_object_unref(udpsrc);
+}
+
 // 初始化GStreamer管道
-bool GstVideoReceiver::initialize(int port) {
+bool GstVideoReceiver::initialize(int port, const VideoPipelineConfig& config, int rtp_fd, int rtcp_fd) {
     std::lock_guard<std::mutex> lock(pipeline_mutex_);
+    config_ = config;
+
+    // 批量接收需要先占用端口；失败时（端口被占用、缓冲池不可用）退回udpsrc
+    // 调用方已占用端口时交给批量接收一份副本，失败时原fd留给udpsrc
+    if (config_.ingest == IngestMode::RecvMmsg) {
+        if (udp_receiver_.open(port, config_.socket_buffer_bytes, rtp_fd >= 0 ? dup(rtp_fd) : -1)) {
+            closeFd(rtp_fd);
+        } else {
+            std::cerr << "端口" << port << "批量接收不可用，改用udpsrc" << std::endl;
+            config_.ingest = IngestMode::UdpSrc;
+        }
+    }
     
-    const std::string pipeline_str = 
-        "udpsrc port=" + std::to_string(port) + " ! "
-        "application/x-rtp,media=video,encoding-name=H264 ! "
-        "rtpjitterbuffer latency=100 ! "
-        "rtph264depay ! avdec_h264 ! "
-        "videoconvert ! videoscale ! video/x-raw,format=RGBA ! "
-        "appsink name=sink emit-signals=true";
+    const std::string pipeline_str = buildReceivePipeline(port, config_);
 
     GError* error = nullptr;
     pipeline_ = gst_parse_launch(pipeline_str.c_str(), &error);
@@ -38,15 +83,71 @@ bool GstVideoReceiver::initialize(int port) {
     if (error) {
         std::cerr << "GStreamer初始化失败: " << error->message << std::endl;
         g_error_free(error);
+        if (pipeline_) {
+            gst_object_unref(pipeline_);  // 可恢复的解析错误时仍会返回部分管道
+            pipeline_ = nullptr;
+        }
+        udp_receiver_.close();
+        closeFd(rtp_fd);
+        closeFd(rtcp_fd);
         return false;
     }
 
+    // 端口在分配后一直由调用方持有，udpsrc直接使用这些socket，中间不会被其他进程占去
+    if (config_.ingest == IngestMode::UdpSrc) {
+        udpsrc_fd_ = rtp_fd >= 0 ? dup(rtp_fd) : -1;  // 保留一份用于读取内核丢包计数
+        adoptSocket(pipeline_, "src", rtp_fd);
+    }
+    if (config_.ingest != IngestMode::External) {
+        adoptSocket(pipeline_, "rtcp_src", rtcp_fd);
+    }
+    closeFd(rtp_fd);
+    closeFd(rtcp_fd);
+
+    if (config_.ingest != IngestMode::UdpSrc) {
+        appsrc_ = gst_bin_get_by_name(GST_BIN(pipeline_), "src");
+        GstCaps* caps = gst_caps_from_string(rtpCaps(config_).c_str());
+        gst_app_src_set_caps(GST_APP_SRC(appsrc_), caps);
+        gst_caps_unref(caps);
+    }
+
     appsink_ = GST_APP_SINK(gst_bin_get_by_name(GST_BIN(pipeline_), "sink"));
     
     // 配置appsink参数
-    gst_app_sink_set_emit_signals(appsink_, true);
-    gst_app_sink_set_drop(appsink_, true);
-    gst_app_sink_set_max_buffers(appsink_, 5);
+    gst_app_sink_set_emit_signals(appsink_, false);  // 工作线程直接拉取，无需new-sample信号
+    applySinkConfig(appsink_, config_);
+    texture_pool_.attach(GST_ELEMENT(appsink_));  // videoconvert直接输出到可复用的帧缓冲
+    latency_tracker_.attach(pipeline_);
+    keyframe_requester_.attach(pipeline_);
+    recorder_.attach(pipeline_, config_);
+
+    // jitterbuffer由rtpbin在首个包到达时创建，届时再按当前策略配置
+    jitter_controller_.configure(config_, nullptr);
+    latency_ms_.store(jitter_controller_.latencyMs());
+    rtp_session_.setJitterBufferCallback([this](GstElement* jitterbuffer) {
+        onNewJitterBuffer(jitterbuffer);
+    });
+    if (!rtp_session_.attach(pipeline_, config_)) {
+        std::cerr << "RTP会话创建失败" << std::endl;
+        releasePipeline();
+        return false;
+    }
+    decode_queue_ = gst_bin_get_by_name(GST_BIN(pipeline_), "decode_queue");
+    convert_queue_ = gst_bin_get_by_name(GST_BIN(pipeline_), "convert_queue");
+
+    // 重置指标
+    {
+        std::lock_guard<std::mutex> metrics_lock(metrics_mutex_);
+        metrics_ = ReceiverMetrics();
+    }
+    frames_delivered_.store(0);
+    last_jitter_stats_ = JitterStats();
+    last_frames_decoded_ = 0;
+    last_bytes_received_ = 0;
+    last_stats_time_ = std::chrono::steady_clock::now();
+    qos_dropped_.clear();
+    qos_max_jitter_ns_ = 0;
+    receiver_status_.store(200);
     
     return true;
 }
@@ -58,21 +159,39 @@ void GstVideoReceiver::start() {
     running_ = true;
     worker_thread_ = std::thread([this]() {
         gst_element_set_state(pipeline_, GST_STATE_PLAYING);
+        if (appsrc_ && config_.ingest == IngestMode::RecvMmsg) {
+            udp_receiver_.start(appsrc_);
+        }
         
         GstBus* bus = gst_element_get_bus(pipeline_);
+        auto last_stats_time = std::chrono::steady_clock::now();
         while (running_) {
-            // 处理视频帧
-            GstSample* sample = gst_app_sink_pull_sample(appsink_);
+            // 周期性读取抖动统计、调整延迟并更新接收指标
+            auto now = std::chrono::steady_clock::now();
+            if (now - last_stats_time >= JITTER_STATS_INTERVAL) {
+                last_stats_time = now;
+                updateStats();
+            }
+
+            // 处理视频帧（最多等待EVENT_WAIT_TIMEOUT，断流时不会无限阻塞）
+            GstSample* sample = gst_app_sink_try_pull_sample(appsink_, EVENT_WAIT_TIMEOUT);
             if (sample) {
                 processSample(sample);
                 gst_sample_unref(sample);
             }
             
-            // 处理总线消息
-            handleBusMessages(bus);
+            // 处理总线消息；appsink已EOS时不会再有样本，改为在总线上等待
+            handleBusMessages(bus, gst_app_sink_is_eos(appsink_) ? EVENT_WAIT_TIMEOUT : 0);
+
+            // 画面受损时请求关键帧（内部限速）
+            KeyframeReason reason;
+            if (config_.request_keyframes && keyframe_requester_.poll(&reason) && keyframe_callback_) {
+                keyframe_callback_(reason);
+            }
         }
         
-        // 清理资源
+        // 清理资源（先停止向appsrc推送）
+        udp_receiver_.stop();
         gst_element_set_state(pipeline_, GST_STATE_NULL);
         gst_object_unref(bus);
     });
@@ -86,67 +205,248 @@ void GstVideoReceiver::stop() {
     }
     
     std::lock_guard<std::mutex> lock(pipeline_mutex_);
+    releasePipeline();
+}
+
+// 释放管道及其中取得的元素引用（调用时须持有pipeline_mutex_，工作线程已退出）
+void GstVideoReceiver::releasePipeline() {
     if (pipeline_) {
         gst_object_unref(appsink_);
+        rtp_session_.detach();
+        keyframe_requester_.detach();
+        recorder_.detach();
+        if (appsrc_) gst_object_unref(appsrc_);
+        if (jitter_) gst_object_unref(jitter_);
+        if (decode_queue_) gst_object_unref(decode_queue_);
+        if (convert_queue_) gst_object_unref(convert_queue_);
         gst_object_unref(pipeline_);
+        appsink_ = nullptr;
+        appsrc_ = nullptr;
+        jitter_ = nullptr;
+        decode_queue_ = nullptr;
+        convert_queue_ = nullptr;
         pipeline_ = nullptr;
     }
+    udp_receiver_.close();
+    closeFd(udpsrc_fd_);
+    texture_pool_.clear();
+}
+
+bool GstVideoReceiver::pushPackets(GstBufferList* list) {
+    if (!appsrc_ || config_.ingest != IngestMode::External) {
+        gst_buffer_list_unref(list);
+        return false;
+    }
+    // 与udpsrc相同以running time作为到达时刻；管道尚无时钟时留空，由jitterbuffer自行取当前时间
+    GstClockTime arrival = GST_CLOCK_TIME_NONE;
+    if (GstClock* clock = gst_element_get_clock(appsrc_)) {
+        const GstClockTime now = gst_clock_get_time(clock);
+        const GstClockTime base = gst_element_get_base_time(appsrc_);
+        arrival = now > base ? now - base : 0;
+        gst_object_unref(clock);
+    }
+    list = gst_buffer_list_make_writable(list);
+    for (guint i = 0; i < gst_buffer_list_length(list); ++i) {
+        GstBuffer* buffer = gst_buffer_list_get_writable(list, i);
+        GST_BUFFER_PTS(buffer) = arrival;
+        GST_BUFFER_DTS(buffer) = arrival;
+    }
+    return gst_app_src_push_buffer_list(GST_APP_SRC(appsrc_), list) == GST_FLOW_OK;
+}
+
+void GstVideoReceiver::endOfStream() {
+    if (appsrc_) {
+        gst_app_src_end_of_stream(GST_APP_SRC(appsrc_));
+    }
+}
+
+// 切换呈现策略
+void GstVideoReceiver::setPresentMode(PresentMode mode) {
+    std::lock_guard<std::mutex> lock(pipeline_mutex_);
+    config_.present_mode = mode;
+    if (appsink_) {
+        applySinkConfig(appsink_, config_);
+    }
+}
+
+// 切换延迟策略
+void GstVideoReceiver::setLatencyProfile(LatencyProfile profile) {
+    std::lock_guard<std::mutex> lock(pipeline_mutex_);
+    config_.latency_profile = profile;
+    jitter_controller_.configure(config_, jitter_);
+    latency_ms_.store(jitter_controller_.latencyMs());
+    if (appsink_) {
+        applySinkConfig(appsink_, config_);
+    }
+}
+
+// rtpbin为新的SSRC创建了jitterbuffer（流线程中调用）：接管并按当前策略配置
+void GstVideoReceiver::onNewJitterBuffer(GstElement* jitterbuffer) {
+    std::lock_guard<std::mutex> lock(pipeline_mutex_);
+    if (jitter_) gst_object_unref(jitter_);
+    jitter_ = GST_ELEMENT(gst_object_ref(jitterbuffer));
+    jitter_controller_.configure(config_, jitter_);
+    latency_ms_.store(jitter_controller_.latencyMs());
+}
+
+ReceiverMetrics GstVideoReceiver::getMetrics() const {
+    std::lock_guard<std::mutex> lock(metrics_mutex_);
+    return metrics_;
+}
+
+int GstVideoReceiver::queueDepth() const {
+    int depth = 0;
+    for (GstElement* queue : {decode_queue_, convert_queue_}) {
+        if (!queue) continue;
+        guint level = 0;
+        g_object_get(queue, "current-level-buffers", &level, nullptr);
+        depth += static_cast<int>(level);
+    }
+    return depth;
+}
+
+// 读取jitterbuffer统计并调整延迟，汇总本周期的接收指标
+void GstVideoReceiver::updateStats() {
+    std::lock_guard<std::mutex> lock(pipeline_mutex_);
+    JitterStats stats = last_jitter_stats_;
+    jitter_controller_.tick(jitter_, &stats);
+    if (stats.pushed < last_jitter_stats_.pushed) {
+        last_jitter_stats_ = JitterStats();  // SSRC变化后换了新的jitterbuffer，统计从零开始
+    }
+    latency_ms_.store(jitter_controller_.latencyMs());
+    jitter_ms_.store(jitter_controller_.jitterMs());
+
+    const auto now = std::chrono::steady_clock::now();
+    const double seconds = std::chrono::duration<double>(now - last_stats_time_).count();
+    last_stats_time_ = now;
+
+    ReceiverMetrics metrics;
+    metrics.packets_received = stats.pushed;
+    metrics.packets_lost = stats.lost;
+    metrics.packets_late = stats.late;
+    const uint64_t pushed = stats.pushed - last_jitter_stats_.pushed;
+    const uint64_t lost = stats.lost - last_jitter_stats_.lost;
+    metrics.late_recent = stats.late - last_jitter_stats_.late;
+    metrics.loss_rate = pushed + lost > 0 ? static_cast<double>(lost) / (pushed + lost) : 0.0;
+    metrics.jitter_ms = jitter_controller_.jitterMs();
+    metrics.qos_jitter_ms = qos_max_jitter_ns_ / 1e6;
+    metrics.latency_ms = jitter_controller_.latencyMs();
+    const RecoveryStats recovery = rtp_session_.stats(stats);
+    metrics.rtx_requests = recovery.rtx_requests;
+    metrics.packets_retransmitted = recovery.retransmitted;
+    metrics.packets_recovered = recovery.recovered;
+    metrics.packets_unrecovered = recovery.unrecovered;
+    last_jitter_stats_ = stats;
+    const KeyframeStats keyframes = keyframe_requester_.stats();
+    metrics.keyframe_requests = keyframes.requests;
+    metrics.recovery_ms = keyframes.last_recovery_ms;
+
+    // 解码后未交付的帧即为管道内丢弃（leaky队列、appsink），另加上游QoS丢帧
+    const uint64_t decoded = latency_tracker_.framesDecoded();
+    const uint64_t delivered = frames_delivered_.load();
+    const uint64_t bytes = latency_tracker_.bytesReceived();
+    uint64_t qos_dropped = 0;
+    for (const auto& entry : qos_dropped_) {
+        qos_dropped += entry.second;
+    }
+    metrics.frames_decoded = decoded;
+    metrics.frames_delivered = delivered;
+    metrics.frames_dropped = qos_dropped + (decoded > delivered ? decoded - delivered : 0);
+    if (seconds > 0) {
+        metrics.decode_fps = (decoded - last_frames_decoded_) / seconds;
+        metrics.bitrate_kbps = (bytes - last_bytes_received_) * 8.0 / 1000.0 / seconds;
+    }
+    last_frames_decoded_ = decoded;
+    last_bytes_received_ = bytes;
+    metrics.queue_depth = queueDepth();
+    if (appsrc_) {
+        metrics.kernel_drops = udp_receiver_.kernelDrops();
+    } else {
+        if (udpsrc_fd_ < 0) {
+            // udpsrc自行绑定端口时，socket在进入READY后才可取得
+            GstElement* udpsrc = gst_bin_get_by_name(GST_BIN(pipeline_), "src");
+            udpsrc_fd_ = dupUdpSrcSocket(udpsrc);
+            if (udpsrc) gst_object_unref(udpsrc);
+        }
+        metrics.kernel_drops = readSocketKernelDrops(udpsrc_fd_);
+    }
+
+    const bool congested = metrics.loss_rate > CONGESTION_LOSS_RATE || metrics.late_recent > 0 ||
+                           qos_max_jitter_ns_ > CONGESTION_QOS_JITTER_NS;
+    metrics.status = congested ? 300 : 200;
+    receiver_status_.store(metrics.status);
+    qos_max_jitter_ns_ = 0;
+
+    std::lock_guard<std::mutex> metrics_lock(metrics_mutex_);
+    metrics_ = metrics;
 }
 
 // 处理视频采样数据
 void GstVideoReceiver::processSample(GstSample* sample) {
+    if (!frame_callback_) return;
+
+    // 不拷贝像素：帧对象持有buffer引用，由接收方决定何时释放
     GstBuffer* buffer = gst_sample_get_buffer(sample);
-    GstMapInfo map;
-    
-    if (gst_buffer_map(buffer, &map, GST_MAP_READ)) {
-        if (frame_callback_) {
-            VideoFrame frame {
-                .width = 0,
-                .height = 0,
-                .data = map.data,
-                .size = map.size,
-                .format = GST_VIDEO_FORMAT_UNKNOWN  // 先初始化为未知格式
-            };
-            
-            // 正确从 sample 的 caps 中提取视频格式
-            GstCaps* caps = gst_sample_get_caps(sample);
-            if (caps) {
-                GstVideoInfo info;
-                gst_video_info_init(&info);
-                if (gst_video_info_from_caps(&info, caps)) {
-                    frame.width = info.width;
-                    frame.height = info.height;
-                    frame.format = info.finfo->format;
-                }
-            }
-            
-            frame_callback_(frame);
-        }
-        gst_buffer_unmap(buffer, &map);
+    const GstClockTime pts = buffer ? GST_BUFFER_PTS(buffer) : GST_CLOCK_TIME_NONE;
+    VideoFrame frame = VideoFrame::fromSample(sample);
+    if (config_.fast_convert && FrameConverter::supports(frame.format())) {
+        frame = converter_.convert(frame, texture_pool_, config_.max_width, config_.max_height);
+    }
+    if (frame.valid()) {
+        latency_tracker_.complete(pts, &frame.timing());
+        frames_delivered_.fetch_add(1, std::memory_order_relaxed);
+        frame_callback_(std::move(frame));
     }
 }
 
-// 处理总线消息
-void GstVideoReceiver::handleBusMessages(GstBus* bus) {
-    GstMessage* msg = gst_bus_pop_filtered(bus, 
-        static_cast<GstMessageType>(GST_MESSAGE_ERROR | GST_MESSAGE_EOS | GST_MESSAGE_QOS));
-    
-    if (!msg) return;
+// 处理总线消息：最多等待wait取得第一条，随后取完所有积压消息
+void GstVideoReceiver::handleBusMessages(GstBus* bus, GstClockTime wait) {
+    const auto types = static_cast<GstMessageType>(GST_MESSAGE_ERROR | GST_MESSAGE_WARNING | GST_MESSAGE_EOS |
+                                                  GST_MESSAGE_QOS);
+    GstMessage* msg = gst_bus_timed_pop_filtered(bus, wait, types);
+    while (msg) {
+        handleBusMessage(msg);
+        gst_message_unref(msg);
+        msg = gst_bus_pop_filtered(bus, types);
+    }
+}
 
+void GstVideoReceiver::handleBusMessage(GstMessage* msg) {
     switch (GST_MESSAGE_TYPE(msg)) {
         case GST_MESSAGE_QOS: {
-            guint64 timestamp;
-            gst_message_parse_qos(msg, nullptr, nullptr, nullptr, &timestamp, nullptr);
-            
-            static guint64 last_timestamp = 0;
-            receiver_status_.store((timestamp - last_timestamp > 20000000) ? 300 : 200);
-            last_timestamp = timestamp;
+            // 按实例记录：本周期最大迟到时间，以及各元素的累计丢帧
+            gint64 jitter = 0;
+            gst_message_parse_qos_values(msg, &jitter, nullptr, nullptr);
+            qos_max_jitter_ns_ = std::max<int64_t>(qos_max_jitter_ns_, jitter);
+
+            GstFormat format = GST_FORMAT_UNDEFINED;
+            guint64 processed = 0;
+            guint64 dropped = 0;
+            gst_message_parse_qos_stats(msg, &format, &processed, &dropped);
+            if (format == GST_FORMAT_BUFFERS && dropped != static_cast<guint64>(-1)) {
+                qos_dropped_[GST_OBJECT_NAME(GST_MESSAGE_SRC(msg))] = dropped;
+            }
+            break;
+        }
+        case GST_MESSAGE_WARNING: {
+            // avdec等解码器遇到损坏数据时多以警告报告，之后的帧缺少参考直到下一个关键帧
+            GError* err = nullptr;
+            gchar* debug = nullptr;
+            gst_message_parse_warning(msg, &err, &debug);
+            if (g_error_matches(err, GST_STREAM_ERROR, GST_STREAM_ERROR_DECODE)) {
+                keyframe_requester_.markBroken(KeyframeReason::DecodeError);
+            }
+            g_error_free(err);
+            g_free(debug);
             break;
         }
         case GST_MESSAGE_ERROR: {
             GError* err = nullptr;
             gchar* debug = nullptr;
             gst_message_parse_error(msg, &err, &debug);
+            if (g_error_matches(err, GST_STREAM_ERROR, GST_STREAM_ERROR_DECODE)) {
+                keyframe_requester_.markBroken(KeyframeReason::DecodeError);
+            }
             
             if (error_callback_) {
                 error_callback_(err->message, GST_VIDEO_ERROR_DECODE);
@@ -164,6 +464,4 @@ void GstVideoReceiver::handleBusMessages(GstBus* bus) {
         default:
             break;
     }
-    
-    gst_message_unref(msg);
 }
\ No newline at end of file
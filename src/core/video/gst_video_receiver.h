@@ -6,13 +6,27 @@ data: 2025/05/05
 #ifndef GST_VIDEO_RECEIVER_H
 #define GST_VIDEO_RECEIVER_H
 
+#include <chrono>
 #include <functional>
+#include <map>
 #include <mutex>
+#include <string>
 #include <thread>
 #include <atomic> 
 #include <gst/gst.h>
 #include <gst/app/gstappsink.h> 
 #include <gst/video/video.h> 
+#include "core/video/video_frame.h"
+#include "core/video/pipeline_config.h"
+#include "core/video/frame_converter.h"
+#include "core/video/jitter_controller.h"
+#include "core/video/latency_tracker.h"
+#include "core/video/receiver_metrics.h"
+#include "core/video/rtp_session.h"
+#include "core/video/keyframe_requester.h"
+#include "core/video/stream_recorder.h"
+#include "core/network/udp_batch_receiver.h"
+#include "utils/texture_pool.h"
 
 enum VideoErrorType {
     GST_VIDEO_ERROR_DECODE,
@@ -20,51 +34,106 @@ enum VideoErrorType {
     GST_VIDEO_ERROR_EOS
 };
 
-struct VideoFrame {
-    int width;
-    int height;
-    const uint8_t* data;
-    size_t size;
-    GstVideoFormat format;
-};
-
 class GstVideoReceiver {
 public:
-    using FrameCallback = std::function<void(const VideoFrame&)>;
+    // 帧回调：帧的所有权转移给回调方，释放时才归还GstBuffer
+    using FrameCallback = std::function<void(VideoFrame&&)>;
     using ErrorCallback = std::function<void(const std::string&, int)>;
+    // 需要关键帧（已限速，接收线程中调用），供调用方经控制通道补发请求
+    using KeyframeCallback = std::function<void(KeyframeReason)>;
 
     GstVideoReceiver();
     ~GstVideoReceiver();
 
     // 初始化视频接收器
-    bool initialize(int port = 5000);
+    // rtp_fd/rtcp_fd为调用方已绑定到port/port+1的socket（可为-1），无论成功与否都由接收器接管
+    bool initialize(int port = 5000, const VideoPipelineConfig& config = VideoPipelineConfig(),
+                    int rtp_fd = -1, int rtcp_fd = -1);
     
     // 控制接口
     void start();
     void stop();
+
+    // 呈现策略（可在运行中切换）
+    void setPresentMode(PresentMode mode);
+
+    // jitterbuffer延迟策略（可在运行中切换）
+    void setLatencyProfile(LatencyProfile profile);
     
+    // IngestMode::External时由调用方推入RTP包（接管list；以推入时刻作为到达时间，appsrc满时阻塞）
+    bool pushPackets(GstBufferList* list);
+    // 输入结束：管道处理完剩余数据后经错误回调报告GST_VIDEO_ERROR_EOS
+    void endOfStream();
+
+    // 直通录制（见StreamRecorder），文件为path_prefix_00000.mkv起依次编号
+    bool startRecording(const std::string& path_prefix) { return recorder_.start(path_prefix); }
+    void stopRecording() { recorder_.stop(); }
+    bool isRecording() const { return recorder_.isRecording(); }
+    RecordingStats getRecordingStats() const { return recorder_.stats(); }
+
     // 状态获取
     int getReceiverStatus() const { return receiver_status_.load(); }
+    ReceiverMetrics getMetrics() const;
+    int getLatencyMs() const { return latency_ms_.load(); }
+    double getJitterMs() const { return jitter_ms_.load(); }
+    TexturePoolStats getTexturePoolStats() const { return texture_pool_.stats(); }
+    KeyframeStats getKeyframeStats() const { return keyframe_requester_.stats(); }
+    const LatencyHistogram& getRecoveryHistogram() const { return keyframe_requester_.recoveryHistogram(); }
     
     // 回调设置
     void setFrameCallback(FrameCallback callback) { frame_callback_ = callback; }
     void setErrorCallback(ErrorCallback callback) { error_callback_ = callback; }
+    void setKeyframeCallback(KeyframeCallback callback) { keyframe_callback_ = callback; }
 
 private:
+    void releasePipeline();
     void processSample(GstSample* sample);
-    void handleBusMessages(GstBus* bus);
+    void handleBusMessages(GstBus* bus, GstClockTime wait);
+    void handleBusMessage(GstMessage* msg);
+    void updateStats();
+    void onNewJitterBuffer(GstElement* jitterbuffer);
+    int queueDepth() const;
 
     GstElement* pipeline_;
     GstAppSink* appsink_;
+    GstElement* appsrc_ = nullptr;         // 批量接收时的输入（否则为空，使用udpsrc）
+    GstElement* jitter_ = nullptr;         // rtpbin当前使用的jitterbuffer（首个包到达后才有）
+    GstElement* decode_queue_ = nullptr;   // 流水线模式下的级间队列（否则为空）
+    GstElement* convert_queue_ = nullptr;
     
     std::mutex pipeline_mutex_;
     std::thread worker_thread_;
     std::atomic<bool> running_;
     std::atomic<int> receiver_status_; // 200=正常，300=拥塞
+    VideoPipelineConfig config_;
+    TexturePool texture_pool_;         // 帧缓冲池（须晚于管道销毁）
+    FrameConverter converter_;         // 仅在工作线程中使用
+    JitterController jitter_controller_;
+    LatencyTracker latency_tracker_;   // 管道内各阶段延迟探针
+    RtpSession rtp_session_;           // rtpbin：RTCP、重传与FEC
+    KeyframeRequester keyframe_requester_;
+    StreamRecorder recorder_;          // 录制支路（record_sink）的预录缓存与写盘
+    UdpBatchReceiver udp_receiver_;    // IngestMode::RecvMmsg时持有socket
+    int udpsrc_fd_ = -1;               // udpsrc所用socket的副本，仅用于读取内核丢包计数
+    std::atomic<int> latency_ms_{0};
+    std::atomic<double> jitter_ms_{0.0};
+
+    // 接收指标：metrics_由工作线程每周期整体替换
+    mutable std::mutex metrics_mutex_;
+    ReceiverMetrics metrics_;
+    std::atomic<uint64_t> frames_delivered_{0};
+    // 以下仅在工作线程中访问
+    JitterStats last_jitter_stats_;
+    uint64_t last_frames_decoded_ = 0;
+    uint64_t last_bytes_received_ = 0;
+    std::chrono::steady_clock::time_point last_stats_time_;
+    std::map<std::string, uint64_t> qos_dropped_;  // 各元素QoS报告的累计丢帧
+    int64_t qos_max_jitter_ns_ = 0;                // 本周期QoS报告的最大迟到时间
 
     // 回调函数
     FrameCallback frame_callback_;
     ErrorCallback error_callback_;
+    KeyframeCallback keyframe_callback_;
 };
 
 #endif // GST_VIDEO_RECEIVER_H
\ No newline at end of file
@@ -0,0 +1,91 @@
+/*
+file: src/core/video/jitter_controller.cpp
+date: 2026/10/16
+*/
+#include "core/video/jitter_controller.h"
+#include <algorithm>
+
+JitterController::JitterController(int min_ms, int max_ms, int initial_ms) {
+    reset(min_ms, max_ms, initial_ms);
+}
+
+void JitterController::reset(int min_ms, int max_ms, int initial_ms) {
+    min_ms_ = std::max(1, min_ms);
+    max_ms_ = std::max(min_ms_, max_ms);
+    latency_ms_ = std::clamp(initial_ms, min_ms_, max_ms_);
+    stable_periods_ = 0;
+    has_last_ = false;
+}
+
+void JitterController::configure(const VideoPipelineConfig& config, GstElement* jitterbuffer) {
+    reset(config.min_latency_ms, config.max_latency_ms, initialLatencyMs(config));
+    adaptive_ = config.latency_profile == LatencyProfile::Adaptive;
+    if (jitterbuffer) {
+        g_object_set(jitterbuffer,
+            "latency", static_cast<guint>(latency_ms_),
+            "drop-on-latency", config.latency_profile == LatencyProfile::UltraLow ? TRUE : FALSE,
+            nullptr);
+    }
+}
+
+int JitterController::update(const JitterStats& stats) {
+    jitter_ms_ = stats.avg_jitter_ns / 1e6;
+
+    // 首个周期只记录基准；统计被重置（管道重建）时同样重新开始
+    if (!has_last_ || stats.pushed < last_.pushed) {
+        last_ = stats;
+        has_last_ = true;
+        return latency_ms_;
+    }
+
+    const uint64_t late = stats.late - last_.late;
+    const uint64_t lost = stats.lost - last_.lost;
+    last_ = stats;
+
+    if (!adaptive_) return latency_ms_;
+
+    if (late > 0 || lost > 0) {
+        // 迟到或丢失：说明缓冲不足，按1.5倍快速增大
+        latency_ms_ = std::min(max_ms_, std::max(latency_ms_ * 3 / 2, latency_ms_ + DECREASE_STEP_MS));
+        stable_periods_ = 0;
+        return latency_ms_;
+    }
+
+    // 平稳：逐步回落到与实测抖动相称的水平
+    const int target = std::clamp(static_cast<int>(jitter_ms_ * JITTER_FACTOR) + MARGIN_MS, min_ms_, max_ms_);
+    if (++stable_periods_ >= STABLE_PERIODS && latency_ms_ > target) {
+        latency_ms_ = std::max(target, latency_ms_ - DECREASE_STEP_MS);
+    }
+    return latency_ms_;
+}
+
+bool JitterController::readStats(GstElement* jitterbuffer, JitterStats& stats) {
+    if (!jitterbuffer) return false;
+
+    GstStructure* s = nullptr;
+    g_object_get(jitterbuffer, "stats", &s, nullptr);
+    if (!s) return false;
+
+    guint64 value = 0;
+    if (gst_structure_get_uint64(s, "num-pushed", &value)) stats.pushed = value;
+    if (gst_structure_get_uint64(s, "num-lost", &value)) stats.lost = value;
+    if (gst_structure_get_uint64(s, "num-late", &value)) stats.late = value;
+    if (gst_structure_get_uint64(s, "avg-jitter", &value)) stats.avg_jitter_ns = value;
+    if (gst_structure_get_uint64(s, "rtx-count", &value)) stats.rtx_count = value;
+    if (gst_structure_get_uint64(s, "rtx-success-count", &value)) stats.rtx_success = value;
+    gst_structure_free(s);
+    return true;
+}
+
+bool JitterController::tick(GstElement* jitterbuffer, JitterStats* stats_out) {
+    JitterStats stats;
+    if (!readStats(jitterbuffer, stats)) return false;
+    if (stats_out) *stats_out = stats;
+
+    const int before = latency_ms_;
+    update(stats);
+    if (latency_ms_ == before) return false;
+
+    g_object_set(jitterbuffer, "latency", static_cast<guint>(latency_ms_), nullptr);
+    return true;
+}
@@ -0,0 +1,66 @@
+/*
+file: src/core/video/jitter_controller.h
+date: 2026/10/16
+*/
+#ifndef JITTER_CONTROLLER_H
+#define JITTER_CONTROLLER_H
+
+#include <cstdint>
+#include <gst/gst.h>
+#include "core/video/pipeline_config.h"
+
+// rtpjitterbuffer的"stats"属性（累计值）
+struct JitterStats {
+    uint64_t pushed = 0;
+    uint64_t lost = 0;
+    uint64_t late = 0;
+    uint64_t avg_jitter_ns = 0;
+    uint64_t rtx_count = 0;          // 发出的重传请求
+    uint64_t rtx_success = 0;        // 重传后按时到达的包
+};
+
+// 抖动自适应的jitterbuffer延迟控制
+// 周期性读取统计：出现迟到/丢失包时快速增大延迟；连续若干周期平稳后，
+// 再按实测抖动逐步回落，始终限制在[min, max]之间。
+class JitterController {
+public:
+    JitterController(int min_ms = 10, int max_ms = 400, int initial_ms = 100);
+
+    // 重新设定范围和当前值（切换配置时调用）
+    void reset(int min_ms, int max_ms, int initial_ms);
+
+    // 按管道配置重置范围和策略，并同步到jitterbuffer（可为空）
+    void configure(const VideoPipelineConfig& config, GstElement* jitterbuffer);
+
+    // 关闭自适应时只统计抖动，延迟保持不变
+    void setAdaptive(bool adaptive) { adaptive_ = adaptive; }
+
+    // 输入一个周期的累计统计，返回新的目标延迟（毫秒）
+    int update(const JitterStats& stats);
+
+    // 读取jitterbuffer统计、更新并写回latency属性；返回延迟是否变化
+    // stats非空时同时返回本次读到的累计统计
+    bool tick(GstElement* jitterbuffer, JitterStats* stats = nullptr);
+
+    int latencyMs() const { return latency_ms_; }
+    double jitterMs() const { return jitter_ms_; }
+
+    static bool readStats(GstElement* jitterbuffer, JitterStats& stats);
+
+private:
+    static constexpr int STABLE_PERIODS = 5;   // 平稳多少个周期后开始回落
+    static constexpr int DECREASE_STEP_MS = 10;
+    static constexpr int JITTER_FACTOR = 4;    // 目标延迟 = 抖动 x 4 + 余量
+    static constexpr int MARGIN_MS = 5;
+
+    int min_ms_;
+    int max_ms_;
+    int latency_ms_;
+    double jitter_ms_ = 0.0;
+    bool adaptive_ = true;
+    int stable_periods_ = 0;
+    bool has_last_ = false;
+    JitterStats last_;
+};
+
+#endif // JITTER_CONTROLLER_H
@@ -0,0 +1,147 @@
+/*
+file: src/core/video/keyframe_requester.cpp
+date: 2026/10/16
+*/
+#include "core/video/keyframe_requester.h"
+#include <gst/video/video.h>
+#include "core/video/latency_tracker.h"
+
+const char* keyframeReasonName(KeyframeReason reason) {
+    switch (reason) {
+        case KeyframeReason::StreamStart:  return "stream_start";
+        case KeyframeReason::PacketLoss:   return "packet_loss";
+        case KeyframeReason::CorruptFrame: return "corrupt_frame";
+        default:                           return "decode_error";
+    }
+}
+
+static void addProbe(GstElement* pipeline, const char* name, const char* pad_name, GstPadProbeType type,
+                     GstPadProbeCallback callback, gpointer user_data) {
+    GstElement* element = gst_bin_get_by_name(GST_BIN(pipeline), name);
+    if (!element) return;
+    GstPad* pad = gst_element_get_static_pad(element, pad_name);
+    if (pad) {
+        gst_pad_add_probe(pad, type, callback, user_data, nullptr);
+        gst_object_unref(pad);
+    }
+    gst_object_unref(element);
+}
+
+KeyframeRequester::~KeyframeRequester() {
+    detach();
+}
+
+void KeyframeRequester::attach(GstElement* pipeline) {
+    detach();
+    seen_first_.store(false);
+    generation_.store(0);
+    pending_.store(0);
+    broken_since_ns_.store(0);
+    last_request_ns_ = 0;
+    requests_.store(0);
+    suppressed_.store(0);
+    recoveries_.store(0);
+    last_recovery_us_.store(0);
+    recovery_.reset();
+
+    if (GstElement* depay = gst_bin_get_by_name(GST_BIN(pipeline), "depay")) {
+        depay_sink_ = gst_element_get_static_pad(depay, "sink");
+        gst_object_unref(depay);
+    }
+    addProbe(pipeline, "depay", "sink", GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM, &KeyframeRequester::onDepayEvent, this);
+    addProbe(pipeline, "depay", "src", GST_PAD_PROBE_TYPE_BUFFER, &KeyframeRequester::onDepayOutput, this);
+    addProbe(pipeline, "decoder", "src", GST_PAD_PROBE_TYPE_BUFFER, &KeyframeRequester::onDecoderOutput, this);
+}
+
+void KeyframeRequester::detach() {
+    if (depay_sink_) {
+        gst_object_unref(depay_sink_);
+        depay_sink_ = nullptr;
+    }
+}
+
+void KeyframeRequester::markBroken(KeyframeReason reason) {
+    int64_t expected = 0;
+    broken_since_ns_.compare_exchange_strong(expected, steadyNowNs(), std::memory_order_relaxed);
+    const uint64_t generation = generation_.fetch_add(1, std::memory_order_relaxed) + 1;
+    if (pending_.exchange(generation, std::memory_order_acq_rel) != 0) {
+        suppressed_.fetch_add(1, std::memory_order_relaxed);  // 已有待发请求，合并
+        return;
+    }
+    pending_reason_.store(static_cast<int>(reason), std::memory_order_relaxed);
+}
+
+void KeyframeRequester::markRecovered() {
+    uint64_t pending = pending_.load(std::memory_order_acquire);
+    const int64_t since = broken_since_ns_.exchange(0, std::memory_order_relaxed);
+    // 自然到来的关键帧同样满足请求；但只撤销此前的受损，期间新的markBroken（代数已变）保留待发
+    if (pending != 0 && !pending_.compare_exchange_strong(pending, 0, std::memory_order_acq_rel)) {
+        int64_t expected = 0;
+        broken_since_ns_.compare_exchange_strong(expected, steadyNowNs(), std::memory_order_relaxed);
+    }
+    if (since == 0) return;
+    const int64_t elapsed_us = (steadyNowNs() - since) / 1000;
+    recovery_.record(static_cast<uint64_t>(elapsed_us));
+    last_recovery_us_.store(elapsed_us, std::memory_order_relaxed);
+    recoveries_.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool KeyframeRequester::poll(KeyframeReason* reason) {
+    if (pending_.load(std::memory_order_acquire) == 0) return false;
+    const int64_t now = steadyNowNs();
+    if (last_request_ns_ != 0 &&
+        now - last_request_ns_ < std::chrono::duration_cast<std::chrono::nanoseconds>(MIN_INTERVAL).count()) {
+        return false;
+    }
+    if (pending_.exchange(0, std::memory_order_acq_rel) == 0) return false;
+    last_request_ns_ = now;
+
+    // 上游的force-key-unit事件经depay到达rtpbin，由rtpsession转为RTCP PLI（没有RTCP输出时被忽略）
+    if (depay_sink_) {
+        gst_pad_push_event(depay_sink_,
+            gst_video_event_new_upstream_force_key_unit(GST_CLOCK_TIME_NONE, TRUE, 0));
+    }
+    requests_.fetch_add(1, std::memory_order_relaxed);
+    if (reason) *reason = static_cast<KeyframeReason>(pending_reason_.load(std::memory_order_relaxed));
+    return true;
+}
+
+KeyframeStats KeyframeRequester::stats() const {
+    KeyframeStats stats;
+    stats.requests = requests_.load(std::memory_order_relaxed);
+    stats.suppressed = suppressed_.load(std::memory_order_relaxed);
+    stats.recoveries = recoveries_.load(std::memory_order_relaxed);
+    stats.last_recovery_ms = last_recovery_us_.load(std::memory_order_relaxed) / 1000.0;
+    return stats;
+}
+
+// jitterbuffer放弃等待的丢包以自定义下游事件通知depay
+GstPadProbeReturn KeyframeRequester::onDepayEvent(GstPad*, GstPadProbeInfo* info, gpointer user_data) {
+    GstEvent* event = GST_PAD_PROBE_INFO_EVENT(info);
+    if (GST_EVENT_TYPE(event) == GST_EVENT_CUSTOM_DOWNSTREAM &&
+        gst_event_has_name(event, "GstRTPPacketLost")) {
+        static_cast<KeyframeRequester*>(user_data)->markBroken(KeyframeReason::PacketLoss);
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+// 第一帧不是关键帧：从GOP中途加入，解码器要等到下一个IDR
+GstPadProbeReturn KeyframeRequester::onDepayOutput(GstPad*, GstPadProbeInfo* info, gpointer user_data) {
+    auto* self = static_cast<KeyframeRequester*>(user_data);
+    if (self->seen_first_.exchange(true, std::memory_order_relaxed)) return GST_PAD_PROBE_OK;
+    if (GST_BUFFER_FLAG_IS_SET(GST_PAD_PROBE_INFO_BUFFER(info), GST_BUFFER_FLAG_DELTA_UNIT)) {
+        self->markBroken(KeyframeReason::StreamStart);
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+GstPadProbeReturn KeyframeRequester::onDecoderOutput(GstPad*, GstPadProbeInfo* info, gpointer user_data) {
+    auto* self = static_cast<KeyframeRequester*>(user_data);
+    GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+    if (GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_CORRUPTED)) {
+        self->markBroken(KeyframeReason::CorruptFrame);
+    } else if (!GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_DELTA_UNIT)) {
+        self->markRecovered();
+    }
+    return GST_PAD_PROBE_OK;
+}
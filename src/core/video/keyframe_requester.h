@@ -0,0 +1,80 @@
+/*
+file: src/core/video/keyframe_requester.h
+date: 2026/10/16
+*/
+#ifndef KEYFRAME_REQUESTER_H
+#define KEYFRAME_REQUESTER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <gst/gst.h>
+#include "utils/latency_histogram.h"
+
+// 画面受损的原因
+enum class KeyframeReason {
+    StreamStart,    // 从GOP中途加入：depay输出的第一帧不是关键帧
+    PacketLoss,     // jitterbuffer放弃等待的丢包（重传/FEC均未恢复）
+    CorruptFrame,   // 解码器输出被标记为损坏（缺少参考帧等）
+    DecodeError     // 解码器在总线上报告解码错误
+};
+
+const char* keyframeReasonName(KeyframeReason reason);
+
+// 关键帧请求统计（累计值）
+struct KeyframeStats {
+    uint64_t requests = 0;          // 实际发出的请求
+    uint64_t suppressed = 0;        // 限速期间合并掉的触发
+    uint64_t recoveries = 0;        // 受损后解出完好关键帧的次数
+    double last_recovery_ms = 0.0;  // 最近一次从受损到恢复的时间
+};
+
+// 关键帧请求
+// depay与解码器上的探针、总线上的解码错误把流标记为受损；接收线程定期调用poll()，
+// 按最小间隔向上游发送force-key-unit事件——rtpbin将其转为RTCP PLI——并通知调用方
+// 经控制通道补发请求。解码器输出完好关键帧即视为恢复，受损到恢复的时间计入直方图。
+class KeyframeRequester {
+public:
+    static constexpr std::chrono::milliseconds MIN_INTERVAL{500};
+
+    KeyframeRequester() = default;
+    ~KeyframeRequester();
+
+    KeyframeRequester(const KeyframeRequester&) = delete;
+    KeyframeRequester& operator=(const KeyframeRequester&) = delete;
+
+    // 在名为depay/decoder的元素上安装探针并清零统计
+    void attach(GstElement* pipeline);
+    void detach();
+
+    // 标记受损（任意线程）
+    void markBroken(KeyframeReason reason);
+
+    // 接收线程调用：有待发请求且距上次请求超过MIN_INTERVAL时发出，返回true并给出原因
+    bool poll(KeyframeReason* reason);
+
+    KeyframeStats stats() const;
+    const LatencyHistogram& recoveryHistogram() const { return recovery_; }
+
+private:
+    static GstPadProbeReturn onDepayEvent(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+    static GstPadProbeReturn onDepayOutput(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+    static GstPadProbeReturn onDecoderOutput(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+    void markRecovered();
+
+    GstPad* depay_sink_ = nullptr;     // 上游请求从这里发出
+    std::atomic<bool> seen_first_{false};
+    std::atomic<uint64_t> generation_{0};       // 每次markBroken递增
+    std::atomic<uint64_t> pending_{0};          // 待发请求对应的受损代数，0表示没有
+    std::atomic<int> pending_reason_{0};
+    std::atomic<int64_t> broken_since_ns_{0};  // 0表示画面完好
+    int64_t last_request_ns_ = 0;              // 仅在接收线程中访问
+
+    std::atomic<uint64_t> requests_{0};
+    std::atomic<uint64_t> suppressed_{0};
+    std::atomic<uint64_t> recoveries_{0};
+    std::atomic<int64_t> last_recovery_us_{0};
+    LatencyHistogram recovery_;        // 受损到恢复的时间（微秒）
+};
+
+#endif // KEYFRAME_REQUESTER_H
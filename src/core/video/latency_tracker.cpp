@@ -0,0 +1,221 @@
+/*
+file: src/core/video/latency_tracker.cpp
+date: 2026/10/16
+*/
+#include "core/video/latency_tracker.h"
+#include <gst/rtp/gstrtpbuffer.h>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+const char* latencyStageName(LatencyStage stage) {
+    switch (stage) {
+        case LatencyStage::JitterBuffer: return "抖动缓冲";
+        case LatencyStage::Depay:        return "解包";
+        case LatencyStage::Decode:       return "解码";
+        case LatencyStage::Convert:      return "转换";
+        case LatencyStage::Queue:        return "队列";
+        case LatencyStage::Upload:       return "上传";
+        case LatencyStage::Display:      return "显示";
+        case LatencyStage::Total:        return "总计";
+        default:                         return "?";
+    }
+}
+
+int64_t steadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ---------------------------------------------------------------------------
+// LatencyStats
+// ---------------------------------------------------------------------------
+void LatencyStats::record(LatencyStage stage, int64_t begin_ns, int64_t end_ns) {
+    if (begin_ns <= 0 || end_ns <= 0 || end_ns < begin_ns) return;
+    histograms_[static_cast<int>(stage)].record(static_cast<uint64_t>(end_ns - begin_ns) / 1000);
+}
+
+void LatencyStats::reset() {
+    for (auto& histogram : histograms_) {
+        histogram.reset();
+    }
+}
+
+static std::string formatMs(uint64_t us) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.1f", us / 1000.0);
+    return text;
+}
+
+std::string LatencyStats::summary() const {
+    std::string text;
+    for (int i = 0; i < static_cast<int>(LatencyStage::Total); ++i) {
+        const LatencyHistogram& h = histograms_[i];
+        if (h.count() == 0) continue;
+        text += std::string(latencyStageName(static_cast<LatencyStage>(i))) + ":" +
+                formatMs(h.percentile(0.5)) + " ";
+    }
+    const LatencyHistogram& total = histogram(LatencyStage::Total);
+    text += std::string(latencyStageName(LatencyStage::Total)) + " p50/p99/max:" +
+            formatMs(total.percentile(0.5)) + "/" + formatMs(total.percentile(0.99)) + "/" +
+            formatMs(total.max()) + "ms";
+    return text;
+}
+
+bool LatencyStats::dumpToFile(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) return false;
+
+    out << "stage\tcount\tp50_ms\tp99_ms\tmax_ms\n";
+    for (int i = 0; i < static_cast<int>(LatencyStage::Count); ++i) {
+        const LatencyHistogram& h = histograms_[i];
+        out << latencyStageName(static_cast<LatencyStage>(i)) << "\t" << h.count() << "\t"
+            << formatMs(h.percentile(0.5)) << "\t" << formatMs(h.percentile(0.99)) << "\t"
+            << formatMs(h.max()) << "\n";
+    }
+    return static_cast<bool>(out);
+}
+
+LatencyStats& latencyStats() {
+    static LatencyStats stats;
+    return stats;
+}
+
+// ---------------------------------------------------------------------------
+// LatencyTracker
+// ---------------------------------------------------------------------------
+size_t LatencyTracker::slotIndex(uint64_t key) {
+    return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 56) & (SLOT_COUNT - 1);
+}
+
+bool LatencyTracker::rtpTimestamp(GstBuffer* buffer, uint32_t* timestamp) {
+    GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+    if (!gst_rtp_buffer_map(buffer, GST_MAP_READ, &rtp)) return false;
+    *timestamp = gst_rtp_buffer_get_timestamp(&rtp);
+    gst_rtp_buffer_unmap(&rtp);
+    return true;
+}
+
+void LatencyTracker::addProbe(GstElement* pipeline, const char* name, const char* pad_name, GstPadProbeType type,
+                              GstPadProbeCallback callback, gpointer user_data) {
+    GstElement* element = gst_bin_get_by_name(GST_BIN(pipeline), name);
+    if (!element) return;
+    GstPad* pad = gst_element_get_static_pad(element, pad_name);
+    if (pad) {
+        gst_pad_add_probe(pad, type, callback, user_data, nullptr);
+        gst_object_unref(pad);
+    }
+    gst_object_unref(element);
+}
+
+void LatencyTracker::attach(GstElement* pipeline) {
+    bytes_received_.store(0, std::memory_order_relaxed);
+    frames_decoded_.store(0, std::memory_order_relaxed);
+    const auto packets = static_cast<GstPadProbeType>(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST);
+    addProbe(pipeline, "src", "src", packets, &LatencyTracker::onArrival, this);
+    // jitterbuffer在rtpbin内部按SSRC创建，离开jitterbuffer即到达depay的sink pad
+    addProbe(pipeline, "depay", "sink", packets, &LatencyTracker::onJitter, this);
+    addProbe(pipeline, "depay", "src", GST_PAD_PROBE_TYPE_BUFFER, &LatencyTracker::onDepay, this);
+    addProbe(pipeline, "decoder", "src", GST_PAD_PROBE_TYPE_BUFFER, &LatencyTracker::onDecode, this);
+}
+
+// 每帧只记录首个包的到达时刻
+void LatencyTracker::markArrival(GstBuffer* buffer, int64_t now) {
+    bytes_received_.fetch_add(gst_buffer_get_size(buffer), std::memory_order_relaxed);
+    uint32_t timestamp = 0;
+    if (!rtpTimestamp(buffer, &timestamp)) return;
+    Slot& slot = arrivals_[slotIndex(timestamp)];
+    if (slot.key.load(std::memory_order_acquire) == timestamp) return;
+    slot.arrival.store(now, std::memory_order_relaxed);
+    slot.key.store(timestamp, std::memory_order_release);
+}
+
+// jitterbuffer输出时建立 RTP时间戳 -> PTS 的关联
+void LatencyTracker::markJitter(GstBuffer* buffer, int64_t now) {
+    const GstClockTime pts = GST_BUFFER_PTS(buffer);
+    uint32_t timestamp = 0;
+    if (!GST_CLOCK_TIME_IS_VALID(pts) || !rtpTimestamp(buffer, &timestamp)) return;
+
+    Slot& slot = frames_[slotIndex(pts)];
+    if (slot.key.load(std::memory_order_acquire) == pts) return;
+
+    int64_t arrival = 0;
+    const Slot& source = arrivals_[slotIndex(timestamp)];
+    if (source.key.load(std::memory_order_acquire) == timestamp) {
+        arrival = source.arrival.load(std::memory_order_relaxed);
+    }
+    slot.arrival.store(arrival, std::memory_order_relaxed);
+    slot.jitter.store(now, std::memory_order_relaxed);
+    slot.depay.store(0, std::memory_order_relaxed);
+    slot.decode.store(0, std::memory_order_relaxed);
+    slot.key.store(pts, std::memory_order_release);
+}
+
+LatencyTracker::Slot* LatencyTracker::frameSlot(GstClockTime pts) {
+    if (!GST_CLOCK_TIME_IS_VALID(pts)) return nullptr;
+    Slot& slot = frames_[slotIndex(pts)];
+    return slot.key.load(std::memory_order_acquire) == pts ? &slot : nullptr;
+}
+
+GstPadProbeReturn LatencyTracker::onArrival(GstPad*, GstPadProbeInfo* info, gpointer user_data) {
+    auto* self = static_cast<LatencyTracker*>(user_data);
+    const int64_t now = steadyNowNs();
+    if (info->type & GST_PAD_PROBE_TYPE_BUFFER) {
+        self->markArrival(GST_PAD_PROBE_INFO_BUFFER(info), now);
+    } else if (info->type & GST_PAD_PROBE_TYPE_BUFFER_LIST) {
+        GstBufferList* list = GST_PAD_PROBE_INFO_BUFFER_LIST(info);
+        for (guint i = 0; i < gst_buffer_list_length(list); ++i) {
+            self->markArrival(gst_buffer_list_get(list, i), now);
+        }
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+GstPadProbeReturn LatencyTracker::onJitter(GstPad*, GstPadProbeInfo* info, gpointer user_data) {
+    auto* self = static_cast<LatencyTracker*>(user_data);
+    const int64_t now = steadyNowNs();
+    if (info->type & GST_PAD_PROBE_TYPE_BUFFER) {
+        self->markJitter(GST_PAD_PROBE_INFO_BUFFER(info), now);
+    } else if (info->type & GST_PAD_PROBE_TYPE_BUFFER_LIST) {
+        GstBufferList* list = GST_PAD_PROBE_INFO_BUFFER_LIST(info);
+        for (guint i = 0; i < gst_buffer_list_length(list); ++i) {
+            self->markJitter(gst_buffer_list_get(list, i), now);
+        }
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+GstPadProbeReturn LatencyTracker::onDepay(GstPad*, GstPadProbeInfo* info, gpointer user_data) {
+    auto* self = static_cast<LatencyTracker*>(user_data);
+    if (Slot* slot = self->frameSlot(GST_BUFFER_PTS(GST_PAD_PROBE_INFO_BUFFER(info)))) {
+        int64_t expected = 0;
+        slot->depay.compare_exchange_strong(expected, steadyNowNs(), std::memory_order_relaxed);
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+GstPadProbeReturn LatencyTracker::onDecode(GstPad*, GstPadProbeInfo* info, gpointer user_data) {
+    auto* self = static_cast<LatencyTracker*>(user_data);
+    self->frames_decoded_.fetch_add(1, std::memory_order_relaxed);
+    if (Slot* slot = self->frameSlot(GST_BUFFER_PTS(GST_PAD_PROBE_INFO_BUFFER(info)))) {
+        int64_t expected = 0;
+        slot->decode.compare_exchange_strong(expected, steadyNowNs(), std::memory_order_relaxed);
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+void LatencyTracker::complete(GstClockTime pts, FrameTiming* timing) {
+    timing->ready_ns = steadyNowNs();
+    if (Slot* slot = frameSlot(pts)) {
+        timing->arrival_ns = slot->arrival.load(std::memory_order_relaxed);
+        timing->jitter_ns = slot->jitter.load(std::memory_order_relaxed);
+        timing->depay_ns = slot->depay.load(std::memory_order_relaxed);
+        timing->decode_ns = slot->decode.load(std::memory_order_relaxed);
+    }
+
+    LatencyStats& stats = latencyStats();
+    stats.record(LatencyStage::JitterBuffer, timing->arrival_ns, timing->jitter_ns);
+    stats.record(LatencyStage::Depay, timing->jitter_ns, timing->depay_ns);
+    stats.record(LatencyStage::Decode, timing->depay_ns, timing->decode_ns);
+    stats.record(LatencyStage::Convert, timing->decode_ns, timing->ready_ns);
+}
@@ -0,0 +1,109 @@
+/*
+file: src/core/video/latency_tracker.h
+date: 2026/10/16
+*/
+#ifndef LATENCY_TRACKER_H
+#define LATENCY_TRACKER_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <gst/gst.h>
+#include "core/video/video_frame.h"
+#include "utils/latency_histogram.h"
+
+// 延迟统计阶段：每项为相邻两个时刻之差，Total为到达至显示完成
+enum class LatencyStage {
+    JitterBuffer,  // 到达udpsrc -> 离开jitterbuffer
+    Depay,         // -> depay组帧完成
+    Decode,        // -> 解码完成
+    Convert,       // -> 转换/缩放完成（含appsink排队）
+    Queue,         // -> UI线程取出（帧队列等待）
+    Upload,        // 纹理上传耗时
+    Display,       // window.display()耗时
+    Total,         // 到达udpsrc -> display()返回
+    Count
+};
+
+const char* latencyStageName(LatencyStage stage);
+
+// steady_clock当前时刻（纳秒）
+int64_t steadyNowNs();
+
+// 各阶段延迟直方图（进程内所有路共用，可被任意线程记录）
+class LatencyStats {
+public:
+    // 记录[begin, end]区间，任一端未知（0）或区间为负时忽略
+    void record(LatencyStage stage, int64_t begin_ns, int64_t end_ns);
+
+    const LatencyHistogram& histogram(LatencyStage stage) const {
+        return histograms_[static_cast<int>(stage)];
+    }
+    void reset();
+
+    // 状态栏文本：各阶段p50，总计p50/p99/max（毫秒）
+    std::string summary() const;
+
+    // 写出各阶段的样本数与p50/p99/max
+    bool dumpToFile(const std::string& path) const;
+
+private:
+    LatencyHistogram histograms_[static_cast<int>(LatencyStage::Count)];
+};
+
+LatencyStats& latencyStats();
+
+// 管道内延迟探针
+// 在网络输入（src）、depay的sink/src pad和解码器的src pad上打时间戳：到达时刻按RTP时间戳
+// 关联，jitterbuffer之后按PTS关联到同一帧（同一帧的RTP包PTS相同）。
+// 各线程只写自己阶段的字段，槽位按哈希覆盖；冲突或乱序时该帧的部分阶段缺失，不影响其余统计。
+class LatencyTracker {
+public:
+    LatencyTracker() = default;
+
+    LatencyTracker(const LatencyTracker&) = delete;
+    LatencyTracker& operator=(const LatencyTracker&) = delete;
+
+    // 在管道中名为src/depay/decoder的元素上安装探针（缺少的元素跳过）
+    void attach(GstElement* pipeline);
+
+    // 工作线程在帧转换完成后调用：补全帧的各阶段时刻并记录管道内阶段
+    void complete(GstClockTime pts, FrameTiming* timing);
+
+    // 探针顺带统计的累计值（attach时清零），供接收指标使用
+    uint64_t bytesReceived() const { return bytes_received_.load(std::memory_order_relaxed); }
+    uint64_t framesDecoded() const { return frames_decoded_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t SLOT_COUNT = 256;
+    static constexpr uint64_t EMPTY_KEY = UINT64_MAX;
+
+    struct Slot {
+        std::atomic<uint64_t> key{EMPTY_KEY};
+        std::atomic<int64_t> arrival{0};
+        std::atomic<int64_t> jitter{0};
+        std::atomic<int64_t> depay{0};
+        std::atomic<int64_t> decode{0};
+    };
+
+    static size_t slotIndex(uint64_t key);
+    static bool rtpTimestamp(GstBuffer* buffer, uint32_t* timestamp);
+    static void addProbe(GstElement* pipeline, const char* name, const char* pad_name, GstPadProbeType type,
+                         GstPadProbeCallback callback, gpointer user_data);
+
+    static GstPadProbeReturn onArrival(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+    static GstPadProbeReturn onJitter(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+    static GstPadProbeReturn onDepay(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+    static GstPadProbeReturn onDecode(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+
+    void markArrival(GstBuffer* buffer, int64_t now);
+    void markJitter(GstBuffer* buffer, int64_t now);
+    Slot* frameSlot(GstClockTime pts);
+
+    Slot arrivals_[SLOT_COUNT];  // 按RTP时间戳
+    Slot frames_[SLOT_COUNT];    // 按PTS
+    std::atomic<uint64_t> bytes_received_{0};
+    std::atomic<uint64_t> frames_decoded_{0};
+};
+
+#endif // LATENCY_TRACKER_H
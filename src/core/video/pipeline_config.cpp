@@ -0,0 +1,111 @@
+/*
+file: src/core/video/pipeline_config.cpp
+date: 2026/10/16
+*/
+#include "core/video/pipeline_config.h"
+
+static std::string decoderElement(const VideoPipelineConfig& config) {
+    return config.decoder.empty() ? codecInfo(config.codec).default_decoder : config.decoder;
+}
+
+static bool isLibavDecoder(const std::string& element) {
+    return element.rfind("avdec_", 0) == 0;
+}
+
+// 解码阶段（解码器元素及libav的线程参数），命名为decoder供延迟探针使用
+static std::string decodeStage(const VideoPipelineConfig& config) {
+    const std::string element = decoderElement(config);
+    std::string stage = element + " name=decoder";
+    if (!isLibavDecoder(element)) {
+        return stage;
+    }
+    if (config.decode_threads > 0) {
+        stage += " max-threads=" + std::to_string(config.decode_threads);
+    }
+    switch (config.decode_threading) {
+        case DecodeThreading::Slice: stage += " thread-type=slice"; break;
+        case DecodeThreading::Frame: stage += " thread-type=frame"; break;
+        default: break;
+    }
+    return stage;
+}
+
+// 流水线级间队列
+// 解码前的队列不能丢弃（丢失压缩数据会花屏到下一个IDR），满时反压到jitterbuffer；
+// 解码后的队列丢弃最旧的原始帧，保证转换/显示跟不上时延迟不累积。
+static std::string stageQueue(const char* name, bool leaky, const VideoPipelineConfig& config) {
+    std::string queue = std::string("queue name=") + name +
+        " max-size-buffers=" + std::to_string(config.stage_queue_buffers) +
+        " max-size-bytes=0 max-size-time=0";
+    if (leaky) queue += " leaky=downstream";
+    return queue;
+}
+
+// 网络输入阶段，命名为src供延迟探针使用
+// 批量接收时socket由UdpBatchReceiver持有，appsrc只负责把buffer list送入管道
+// 外部推入时appsrc满后阻塞推送方，回放以最大速度进行也不会丢包
+static std::string sourceStage(int port, const VideoPipelineConfig& config) {
+    if (config.ingest != IngestMode::UdpSrc) {
+        return "appsrc name=src is-live=true format=time do-timestamp=false "
+               "max-bytes=" + std::to_string(config.socket_buffer_bytes) +
+               (config.ingest == IngestMode::External ? " block=true" : "");
+    }
+    return "udpsrc name=src port=" + std::to_string(port) +
+           " buffer-size=" + std::to_string(config.socket_buffer_bytes);
+}
+
+// RTP会话阶段：rtpbin及其输入输出支路
+// 重传接收、FEC解码器要在rtpbin创建会话时通过信号提供，而会话在申请请求pad时创建，
+// 因此这里各支路与rtpbin互不相连，由RtpSession::attach()连接信号后再申请pad完成连接。
+// jitterbuffer由rtpbin内部创建，初始延迟取自rtpbin，此后由JitterController调整。
+static std::string sessionStage(int port, const VideoPipelineConfig& config) {
+    std::string stage = "rtpbin name=rtpbin rtp-profile=avpf latency=" + std::to_string(initialLatencyMs(config));
+    stage += config.retransmission ? " do-retransmission=true" : " do-retransmission=false";
+    if (config.latency_profile == LatencyProfile::UltraLow) {
+        stage += " drop-on-latency=true";
+    }
+    stage += " " + sourceStage(port, config) + " ! capsfilter name=rtp_caps caps=\"" + rtpCaps(config) + "\"";
+    // 外部推入时没有对端，RTCP输入绑定任意空闲端口
+    const int rtcp_port = config.ingest == IngestMode::External ? 0 : port + 1;
+    stage += " udpsrc name=rtcp_src port=" + std::to_string(rtcp_port) + " caps=application/x-rtcp";
+    if (!config.rtcp_host.empty() && config.rtcp_port > 0) {
+        stage += " udpsink name=rtcp_sink host=" + config.rtcp_host +
+                 " port=" + std::to_string(config.rtcp_port) + " sync=false async=false";
+    }
+    return stage;
+}
+
+// 录制支路：tee分出的压缩帧经leaky队列交给record_sink，由StreamRecorder在该队列线程中取走。
+// 写盘再慢也只会让这条支路丢帧，不会反压到显示支路。
+static std::string recordStage() {
+    return "tee name=record_tee ! queue name=record_queue leaky=downstream "
+           "max-size-buffers=0 max-size-bytes=0 max-size-time=1000000000 ! "
+           "appsink name=record_sink sync=false async=false emit-signals=false record_tee. ! ";
+}
+
+std::string buildReceivePipeline(int port, const VideoPipelineConfig& config) {
+    const CodecInfo& codec = codecInfo(config.codec);
+    std::string pipeline =
+        sessionStage(port, config) + " " + codec.depayloader + " name=depay ! ";
+
+    // libav自行解析码流；硬件等其他解码器需要按帧对齐的输入。
+    // 录制同样需要按帧对齐并标出关键帧，且每个关键帧前都带参数集，录制可以从任一关键帧开始。
+    if (codec.parser && config.record_branch) {
+        pipeline += std::string(codec.parser) + " config-interval=-1 ! " + recordStage();
+    } else if (codec.parser && !isLibavDecoder(decoderElement(config))) {
+        pipeline += std::string(codec.parser) + " ! ";
+    } else if (config.record_branch) {
+        pipeline += recordStage();
+    }
+
+    if (config.pipelined) {
+        pipeline += stageQueue("decode_queue", false, config) + " ! " +
+                    decodeStage(config) + " ! " +
+                    stageQueue("convert_queue", true, config) + " ! ";
+    } else {
+        pipeline += decodeStage(config) + " ! ";
+    }
+
+    pipeline += convertStage(config) + " ! appsink name=sink";
+    return pipeline;
+}
@@ -0,0 +1,161 @@
+/*
+file: src/core/video/pipeline_config.h
+date: 2026/10/16
+*/
+#ifndef PIPELINE_CONFIG_H
+#define PIPELINE_CONFIG_H
+
+#include <string>
+#include <gst/gst.h>
+#include <gst/app/gstappsink.h>
+#include "core/video/video_codec.h"
+
+// 呈现策略
+enum class PresentMode {
+    Fifo,     // 按顺序逐帧显示，突发时延迟累积
+    Mailbox   // 总是显示最新帧，跳过的旧帧直接回收
+};
+
+inline const char* presentModeName(PresentMode mode) {
+    return mode == PresentMode::Mailbox ? "最新帧" : "顺序";
+}
+
+// jitterbuffer延迟策略
+enum class LatencyProfile {
+    Adaptive,   // 按实测抖动和迟到/丢包在[min, max]之间自动调整
+    Fixed,      // 固定为jitter_latency_ms
+    UltraLow    // 最低延迟：固定min_latency_ms，超时包直接丢弃，appsink不同步且只留一帧
+};
+
+// 解码器线程模型
+enum class DecodeThreading {
+    Auto,    // 由libav决定（与拆分流水线之前相同）
+    Slice,   // 按slice并行，不增加延迟（要求码流多slice编码，单slice码流只用一个线程）
+    Frame    // 按帧并行，吞吐最高，但每增加一个线程多一帧延迟
+};
+
+// 网络输入方式
+enum class IngestMode {
+    UdpSrc,    // udpsrc逐包接收
+    RecvMmsg,  // recvmmsg批量接收（可用时启用GRO），经appsrc以buffer list推入（见UdpBatchReceiver）
+    External   // 不占用网络端口，由调用方经GstVideoReceiver::pushPackets()推入（回放），队列满时阻塞调用方
+};
+
+// 录制文件格式
+enum class RecordFormat {
+    Matroska,  // 进程异常退出时已写入的部分仍可播放
+    Mp4        // 兼容性最好，但须正常停止才能写完索引
+};
+
+inline const char* latencyProfileName(LatencyProfile profile) {
+    switch (profile) {
+        case LatencyProfile::Fixed:    return "固定";
+        case LatencyProfile::UltraLow: return "超低延迟";
+        default:                       return "自适应";
+    }
+}
+
+// 接收管道参数（两个管道构建入口共用）
+struct VideoPipelineConfig {
+    PresentMode present_mode = PresentMode::Mailbox;
+
+    // 码流编码格式，决定RTP caps、depay和默认解码器
+    VideoCodec codec = VideoCodec::H264;
+
+    // 网络输入与socket接收缓冲（字节，两种输入方式均生效；超过net.core.rmem_max时需要CAP_NET_ADMIN）
+    IngestMode ingest = IngestMode::RecvMmsg;
+    int socket_buffer_bytes = 8 * 1024 * 1024;
+
+    // RTP会话（rtpbin）：RTCP收发、NACK重传与ULPFEC前向纠错；RTCP固定在RTP端口+1接收
+    int payload_type = 96;
+    bool retransmission = true;    // 丢包时经RTCP发送NACK请求重传（服务器需以RTX格式重发）
+    int rtx_payload_type = 97;
+    int fec_payload_type = 0;      // ULPFEC负载类型，0为不启用
+    std::string rtcp_host;         // 接收报告/NACK的发送目标，为空时只接收RTCP
+    int rtcp_port = 0;
+    bool request_keyframes = true; // 解码出错、丢包未恢复或中途加入时请求关键帧（RTCP PLI + 控制通道，限速）
+
+    // 录制支路：depay/parse之后经tee分出压缩码流直接封装（不解码、不重新编码，见StreamRecorder）
+    bool record_branch = false;     // 默认不建立：开启后每路多一个tee和队列，并常驻预录缓存
+    RecordFormat record_format = RecordFormat::Matroska;
+    int prerecord_ms = 5000;       // 预录缓存：开始录制时从其中最早的关键帧写起
+    int record_segment_seconds = 600;  // 按时长切分文件，0为不切分
+    int record_segment_mb = 1024;  // 按大小切分文件，0为不切分
+    int record_queue_mb = 32;      // 待写盘数据上限，超过时丢弃到下一个关键帧
+
+    // 显示区域约束（0表示不限制），同时用于与服务器协商码流
+    int max_width = 0;
+    int max_height = 0;
+    int max_fps = 0;
+
+    // 使用项目内SIMD内核完成I420/NV12 -> RGBA转换和缩放（见FrameConverter）
+    bool fast_convert = true;
+
+    // jitterbuffer延迟（毫秒）
+    LatencyProfile latency_profile = LatencyProfile::Adaptive;
+    int jitter_latency_ms = 100;   // 初始值（Fixed时为固定值）
+    int min_latency_ms = 10;
+    int max_latency_ms = 400;
+
+    // 多线程流水线：depay / 解码 / 转换各自运行在独立线程，之间用有界队列衔接
+    bool pipelined = true;
+    int stage_queue_buffers = 3;   // 各级队列最多缓存的buffer数
+    std::string decoder;           // 解码器元素，为空时使用该编码格式的软件解码器（NetworkManager按DecoderProbe结果填入）
+    DecodeThreading decode_threading = DecodeThreading::Auto;  // 以下两项仅对libav解码器有效
+    int decode_threads = 0;        // avdec max-threads，0为自动
+    int convert_threads = 0;       // videoconvert n-threads，0为自动（仅在videoconvert实际转换时有效）
+};
+
+// 当前策略下jitterbuffer的起始延迟
+inline int initialLatencyMs(const VideoPipelineConfig& config) {
+    return config.latency_profile == LatencyProfile::UltraLow ?
+        config.min_latency_ms : config.jitter_latency_ms;
+}
+
+
+// 解码后RGBA输出的caps：超过显示区域时由videoscale按比例缩小
+inline std::string rawCapsFilter(const VideoPipelineConfig& config) {
+    std::string caps = "video/x-raw,format=RGBA";
+    if (config.max_width > 0 && config.max_height > 0) {
+        caps += ",width=[1," + std::to_string(config.max_width) + "]"
+                ",height=[1," + std::to_string(config.max_height) + "]"
+                ",pixel-aspect-ratio=1/1";
+    }
+    return caps;
+}
+
+inline std::string convertThreads(const VideoPipelineConfig& config) {
+    return config.convert_threads > 0 ? " n-threads=" + std::to_string(config.convert_threads) : "";
+}
+
+// 解码之后到appsink之前的转换阶段
+// fast_convert时videoconvert仅在解码器输出不是I420/NV12时工作（否则直通），
+// 色彩转换和缩放由接收线程中的FrameConverter一次完成
+inline std::string convertStage(const VideoPipelineConfig& config) {
+    if (config.fast_convert) {
+        return "videoconvert" + convertThreads(config) + " ! video/x-raw,format=(string){I420,NV12}";
+    }
+    return "videoconvert" + convertThreads(config) + " ! videoscale ! " + rawCapsFilter(config);
+}
+
+// RTP码流caps（网络输入之后的capsfilter、appsrc输出，以及rtpbin的负载类型映射）
+inline std::string rtpCaps(const VideoPipelineConfig& config) {
+    return std::string("application/x-rtp,media=video,clock-rate=90000,encoding-name=") +
+           codecInfo(config.codec).encoding_name + ",payload=" + std::to_string(config.payload_type);
+}
+
+// 完整接收管道描述（udpsrc/appsrc -> rtpbin[jitterbuffer] -> depay -> [parse] -> [tee -> 录制] -> 解码 -> 转换 -> appsink）
+std::string buildReceivePipeline(int port, const VideoPipelineConfig& config);
+
+// 按呈现策略配置appsink，可在运行中调用
+// Fifo：随时钟同步输出并缓存少量帧；Mailbox：不同步、只保留最新一帧
+// 超低延迟策略下无论呈现策略如何都不同步、只保留一帧
+inline void applySinkConfig(GstAppSink* sink, const VideoPipelineConfig& config) {
+    const bool minimal = config.present_mode == PresentMode::Mailbox ||
+                         config.latency_profile == LatencyProfile::UltraLow;
+    gst_app_sink_set_drop(sink, true);
+    gst_app_sink_set_max_buffers(sink, minimal ? 1 : 5);
+    gst_base_sink_set_sync(GST_BASE_SINK(sink), minimal ? FALSE : TRUE);
+}
+
+#endif // PIPELINE_CONFIG_H
@@ -0,0 +1,41 @@
+/*
+file: src/core/video/receiver_metrics.h
+date: 2026/10/16
+*/
+#ifndef RECEIVER_METRICS_H
+#define RECEIVER_METRICS_H
+
+#include <cstdint>
+
+// 接收端健康指标，由接收线程每个统计周期（1秒）更新
+// 数据来源：jitterbuffer的stats属性、RTX/FEC元素的计数、总线上的QoS消息、管道内探针和队列水位
+struct ReceiverMetrics {
+    // 累计值
+    uint64_t packets_received = 0;   // 离开jitterbuffer的RTP包
+    uint64_t packets_lost = 0;       // jitterbuffer判定丢失的包
+    uint64_t packets_late = 0;       // 超过延迟到达而被丢弃的包
+    uint64_t kernel_drops = 0;       // socket接收缓冲溢出时内核丢弃的数据报
+    uint64_t rtx_requests = 0;       // 经RTCP发出的NACK重传请求
+    uint64_t packets_retransmitted = 0;  // 收到的RTX重传包
+    uint64_t packets_recovered = 0;  // 经重传或FEC恢复的包
+    uint64_t packets_unrecovered = 0;    // 最终未能恢复的包
+    uint64_t keyframe_requests = 0;  // 发出的关键帧请求
+    double recovery_ms = 0.0;        // 最近一次画面受损到解出完好关键帧的时间
+    uint64_t frames_decoded = 0;
+    uint64_t frames_delivered = 0;   // 交给帧回调的帧
+    uint64_t frames_dropped = 0;     // QoS报告的丢帧 + 解码后在管道内丢弃的帧
+
+    // 最近一个周期
+    double loss_rate = 0.0;          // 丢包率（0~1）
+    uint64_t late_recent = 0;        // 迟到包数
+    double jitter_ms = 0.0;          // jitterbuffer平均抖动
+    double qos_jitter_ms = 0.0;      // QoS消息报告的最大迟到时间
+    double decode_fps = 0.0;
+    double bitrate_kbps = 0.0;       // 进入管道的RTP码率
+    int queue_depth = 0;             // 管道内级间队列中的buffer数
+    int latency_ms = 0;              // 当前jitterbuffer延迟
+
+    int status = 200;                // 兼容旧协议的汇总：200正常，300拥塞
+};
+
+#endif // RECEIVER_METRICS_H
@@ -0,0 +1,215 @@
+/*
+file: src/core/video/rtp_session.cpp
+date: 2026/10/16
+*/
+#include "core/video/rtp_session.h"
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+// 会话编号：每个接收管道只有一路RTP
+static constexpr guint SESSION_ID = 0;
+
+// FEC恢复需要缓存的媒体包时长（覆盖一个FEC保护窗口）
+static constexpr GstClockTime FEC_STORAGE_TIME = 250 * GST_MSECOND;
+
+// 把名为element的元素的src pad连接到rtpbin的请求pad
+static bool linkToRtpBin(GstElement* pipeline, GstElement* rtpbin, const char* element, const char* pad) {
+    GstElement* upstream = gst_bin_get_by_name(GST_BIN(pipeline), element);
+    if (!upstream) return false;
+    const bool linked = gst_element_link_pads(upstream, "src", rtpbin, pad);
+    gst_object_unref(upstream);
+    return linked;
+}
+
+RtpSession::~RtpSession() {
+    detach();
+}
+
+bool RtpSession::attach(GstElement* pipeline, const VideoPipelineConfig& config) {
+    detach();
+    config_ = config;
+    rtpbin_ = gst_bin_get_by_name(GST_BIN(pipeline), "rtpbin");
+    depay_ = gst_bin_get_by_name(GST_BIN(pipeline), "depay");
+    if (!rtpbin_ || !depay_) {
+        detach();
+        return false;
+    }
+
+    // 信号须在申请会话pad之前连接
+    g_signal_connect(rtpbin_, "request-pt-map", G_CALLBACK(&RtpSession::onRequestPtMap), this);
+    g_signal_connect(rtpbin_, "new-jitterbuffer", G_CALLBACK(&RtpSession::onNewJitterBuffer), this);
+    g_signal_connect(rtpbin_, "pad-added", G_CALLBACK(&RtpSession::onPadAdded), this);
+    if (config_.retransmission) {
+        g_signal_connect(rtpbin_, "request-aux-receiver", G_CALLBACK(&RtpSession::onRequestAuxReceiver), this);
+    }
+    if (config_.fec_payload_type > 0) {
+        g_signal_connect(rtpbin_, "request-fec-decoder", G_CALLBACK(&RtpSession::onRequestFecDecoder), this);
+        g_signal_connect(rtpbin_, "new-storage", G_CALLBACK(&RtpSession::onNewStorage), this);
+    }
+
+    const std::string session = std::to_string(SESSION_ID);
+    if (!linkToRtpBin(pipeline, rtpbin_, "rtp_caps", ("recv_rtp_sink_" + session).c_str()) ||
+        !linkToRtpBin(pipeline, rtpbin_, "rtcp_src", ("recv_rtcp_sink_" + session).c_str())) {
+        std::cerr << "RTP会话: 无法连接rtpbin输入" << std::endl;
+        detach();
+        return false;
+    }
+
+    // 接收报告和NACK（没有发送目标时不申请，rtpbin不会产生RTCP输出）
+    if (GstElement* rtcp_sink = gst_bin_get_by_name(GST_BIN(pipeline), "rtcp_sink")) {
+        if (!gst_element_link_pads(rtpbin_, ("send_rtcp_src_" + session).c_str(), rtcp_sink, "sink")) {
+            std::cerr << "RTP会话: 无法连接RTCP发送" << std::endl;
+        }
+        gst_object_unref(rtcp_sink);
+    }
+    return true;
+}
+
+void RtpSession::detach() {
+    if (rtpbin_) {
+        g_signal_handlers_disconnect_by_data(rtpbin_, this);
+        gst_object_unref(rtpbin_);
+        rtpbin_ = nullptr;
+    }
+    if (depay_) {
+        gst_object_unref(depay_);
+        depay_ = nullptr;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (rtx_receive_) {
+        gst_object_unref(rtx_receive_);
+        rtx_receive_ = nullptr;
+    }
+    if (fec_decoder_) {
+        gst_object_unref(fec_decoder_);
+        fec_decoder_ = nullptr;
+    }
+}
+
+RecoveryStats RtpSession::stats(const JitterStats& jitter) const {
+    RecoveryStats stats;
+    stats.rtx_requests = jitter.rtx_count;
+    stats.recovered = jitter.rtx_success;
+    stats.unrecovered = jitter.lost;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (rtx_receive_) {
+        guint associated = 0;
+        g_object_get(rtx_receive_, "num-rtx-assoc-packets", &associated, nullptr);
+        stats.retransmitted = associated;
+    }
+    // FEC解码器位于jitterbuffer之后：jitterbuffer判定丢失的包一部分由FEC补回
+    if (fec_decoder_) {
+        guint recovered = 0, unrecovered = 0;
+        g_object_get(fec_decoder_, "recovered", &recovered, "unrecovered", &unrecovered, nullptr);
+        stats.recovered += recovered;
+        stats.unrecovered = unrecovered;
+    }
+    return stats;
+}
+
+// RTX重传接收：把重传包（rtx_payload_type）还原为原始序号和负载类型后交给jitterbuffer
+GstElement* RtpSession::onRequestAuxReceiver(GstElement*, guint session, gpointer user_data) {
+    auto* self = static_cast<RtpSession*>(user_data);
+    GstElement* rtx = gst_element_factory_make("rtprtxreceive", nullptr);
+    if (!rtx) {
+        std::cerr << "RTP会话: 缺少rtprtxreceive，重传不可用" << std::endl;
+        return nullptr;
+    }
+    GstStructure* pt_map = gst_structure_new("application/x-rtp-pt-map",
+        std::to_string(self->config_.payload_type).c_str(), G_TYPE_UINT,
+        static_cast<guint>(self->config_.rtx_payload_type), nullptr);
+    g_object_set(rtx, "payload-type-map", pt_map, nullptr);
+    gst_structure_free(pt_map);
+
+    GstElement* bin = gst_bin_new(nullptr);
+    gst_bin_add(GST_BIN(bin), rtx);
+    const std::string id = std::to_string(session);
+    for (const char* direction : {"sink", "src"}) {
+        GstPad* pad = gst_element_get_static_pad(rtx, direction);
+        gst_element_add_pad(bin, gst_ghost_pad_new((std::string(direction) + "_" + id).c_str(), pad));
+        gst_object_unref(pad);
+    }
+
+    std::lock_guard<std::mutex> lock(self->mutex_);
+    if (self->rtx_receive_) gst_object_unref(self->rtx_receive_);
+    self->rtx_receive_ = GST_ELEMENT(gst_object_ref(rtx));
+    return bin;
+}
+
+GstElement* RtpSession::onRequestFecDecoder(GstElement* rtpbin, guint session, gpointer user_data) {
+    auto* self = static_cast<RtpSession*>(user_data);
+    GstElement* decoder = gst_element_factory_make("rtpulpfecdec", nullptr);
+    if (!decoder) {
+        std::cerr << "RTP会话: 缺少rtpulpfecdec，FEC不可用" << std::endl;
+        return nullptr;
+    }
+    GObject* storage = nullptr;
+    g_signal_emit_by_name(rtpbin, "get-internal-storage", session, &storage);
+    g_object_set(decoder, "storage", storage, "pt", static_cast<guint>(self->config_.fec_payload_type), nullptr);
+    if (storage) g_object_unref(storage);
+
+    std::lock_guard<std::mutex> lock(self->mutex_);
+    if (self->fec_decoder_) gst_object_unref(self->fec_decoder_);
+    self->fec_decoder_ = GST_ELEMENT(gst_object_ref(decoder));
+    return decoder;
+}
+
+void RtpSession::onNewStorage(GstElement*, GstElement* storage, guint, gpointer) {
+    g_object_set(storage, "size-time", static_cast<guint64>(FEC_STORAGE_TIME), nullptr);
+}
+
+// jitterbuffer对会话中出现的每个负载类型都要取得caps（至少clock-rate），取不到的包会被丢弃：
+// 媒体、RTX重传（apt指向媒体负载类型）和ULPFEC包都须有映射
+GstCaps* RtpSession::onRequestPtMap(GstElement*, guint, guint pt, gpointer user_data) {
+    auto* self = static_cast<RtpSession*>(user_data);
+    const VideoPipelineConfig& config = self->config_;
+    if (pt == static_cast<guint>(config.payload_type)) {
+        return gst_caps_from_string(rtpCaps(config).c_str());
+    }
+    if (config.retransmission && pt == static_cast<guint>(config.rtx_payload_type)) {
+        return gst_caps_new_simple("application/x-rtp",
+            "media", G_TYPE_STRING, "video",
+            "clock-rate", G_TYPE_INT, 90000,
+            "encoding-name", G_TYPE_STRING, "RTX",
+            "apt", G_TYPE_INT, config.payload_type,
+            "payload", G_TYPE_INT, config.rtx_payload_type, nullptr);
+    }
+    if (config.fec_payload_type > 0 && pt == static_cast<guint>(config.fec_payload_type)) {
+        return gst_caps_new_simple("application/x-rtp",
+            "media", G_TYPE_STRING, "video",
+            "clock-rate", G_TYPE_INT, 90000,
+            "encoding-name", G_TYPE_STRING, "ULPFEC",
+            "payload", G_TYPE_INT, config.fec_payload_type, nullptr);
+    }
+    return nullptr;
+}
+
+void RtpSession::onNewJitterBuffer(GstElement*, GstElement* jitterbuffer, guint, guint, gpointer user_data) {
+    auto* self = static_cast<RtpSession*>(user_data);
+    if (self->jitter_callback_) {
+        self->jitter_callback_(jitterbuffer);
+    }
+}
+
+// 会话输出pad按SSRC和负载类型出现：只连接媒体负载类型；SSRC变化（服务器重启推流）时改接新pad
+void RtpSession::onPadAdded(GstElement*, GstPad* pad, gpointer user_data) {
+    auto* self = static_cast<RtpSession*>(user_data);
+    gchar* name = gst_pad_get_name(pad);
+    guint session = 0, ssrc = 0, pt = 0;
+    const bool media = sscanf(name, "recv_rtp_src_%u_%u_%u", &session, &ssrc, &pt) == 3 &&
+                       session == SESSION_ID && pt == static_cast<guint>(self->config_.payload_type);
+    g_free(name);
+    if (!media) return;
+
+    GstPad* sink = gst_element_get_static_pad(self->depay_, "sink");
+    if (GstPad* old = gst_pad_get_peer(sink)) {
+        gst_pad_unlink(old, sink);
+        gst_object_unref(old);
+    }
+    if (gst_pad_link(pad, sink) != GST_PAD_LINK_OK) {
+        std::cerr << "RTP会话: 无法连接depay" << std::endl;
+    }
+    gst_object_unref(sink);
+}
@@ -0,0 +1,67 @@
+/*
+file: src/core/video/rtp_session.h
+date: 2026/10/16
+*/
+#ifndef RTP_SESSION_H
+#define RTP_SESSION_H
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <gst/gst.h>
+#include "core/video/pipeline_config.h"
+#include "core/video/jitter_controller.h"
+
+// 丢包恢复统计（累计值）
+struct RecoveryStats {
+    uint64_t rtx_requests = 0;    // jitterbuffer经RTCP发出的NACK重传请求
+    uint64_t retransmitted = 0;   // 收到并还原为原始包的RTX重传包
+    uint64_t recovered = 0;       // 重传按时到达 + FEC恢复的包
+    uint64_t unrecovered = 0;     // 最终未能恢复的包
+};
+
+// 接收管道中的RTP会话（rtpbin）
+// 在rtpbin上连接信号，提供RTX重传接收（rtprtxreceive）、ULPFEC解码器（rtpulpfecdec）
+// 和负载类型映射，随后申请会话pad，把网络输入、RTCP收发和depay连接到rtpbin。
+// rtpbin内部的jitterbuffer按SSRC创建，通过回调交给调用方调整延迟和读取统计。
+class RtpSession {
+public:
+    // 新的jitterbuffer（首个包到达或SSRC变化时，在流线程中调用）
+    using JitterBufferCallback = std::function<void(GstElement*)>;
+
+    RtpSession() = default;
+    ~RtpSession();
+
+    RtpSession(const RtpSession&) = delete;
+    RtpSession& operator=(const RtpSession&) = delete;
+
+    // 须在管道启动前调用；管道中没有rtpbin时返回false
+    bool attach(GstElement* pipeline, const VideoPipelineConfig& config);
+    void detach();
+
+    void setJitterBufferCallback(JitterBufferCallback callback) { jitter_callback_ = callback; }
+
+    // 结合jitterbuffer统计汇总丢包恢复情况
+    RecoveryStats stats(const JitterStats& jitter) const;
+
+private:
+    static GstElement* onRequestAuxReceiver(GstElement* rtpbin, guint session, gpointer user_data);
+    static GstElement* onRequestFecDecoder(GstElement* rtpbin, guint session, gpointer user_data);
+    static void onNewStorage(GstElement* rtpbin, GstElement* storage, guint session, gpointer user_data);
+    static GstCaps* onRequestPtMap(GstElement* rtpbin, guint session, guint pt, gpointer user_data);
+    static void onNewJitterBuffer(GstElement* rtpbin, GstElement* jitterbuffer, guint session, guint ssrc,
+                                  gpointer user_data);
+    static void onPadAdded(GstElement* rtpbin, GstPad* pad, gpointer user_data);
+
+    VideoPipelineConfig config_;
+    GstElement* rtpbin_ = nullptr;
+    GstElement* depay_ = nullptr;
+
+    mutable std::mutex mutex_;             // 保护以下由流线程创建的元素
+    GstElement* rtx_receive_ = nullptr;
+    GstElement* fec_decoder_ = nullptr;
+
+    JitterBufferCallback jitter_callback_;
+};
+
+#endif // RTP_SESSION_H
@@ -0,0 +1,322 @@
+/*
+file: src/core/video/stream_recorder.cpp
+date: 2026/10/16
+*/
+#include "core/video/stream_recorder.h"
+#include <gst/app/gstappsrc.h>
+#include <iostream>
+
+// 预录缓存的内存上限：关键帧间隔很长时按此丢弃最早的GOP
+static constexpr uint64_t MAX_PRERECORD_BYTES = 64ull * 1024 * 1024;
+
+// 停止录制后等待文件写完（muxer写索引）的上限
+static constexpr GstClockTime FINALIZE_TIMEOUT = 10 * GST_SECOND;
+
+static bool isKeyframe(GstBuffer* buffer) {
+    return !GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_DELTA_UNIT);
+}
+
+// 旧版本mp4mux不支持VP8/VP9，这两种格式总是封装为Matroska
+static RecordFormat effectiveFormat(const VideoPipelineConfig& config) {
+    if (config.codec == VideoCodec::VP8 || config.codec == VideoCodec::VP9) {
+        return RecordFormat::Matroska;
+    }
+    return config.record_format;
+}
+
+// 写盘管道：appsrc ! [parse] ! splitmuxsink，parse把码流转换为muxer要求的格式（如H.264的avc）
+static GstElement* createWriter(const VideoPipelineConfig& config, const std::string& location) {
+    const CodecInfo& codec = codecInfo(config.codec);
+    const bool mp4 = effectiveFormat(config) == RecordFormat::Mp4;
+    std::string desc = "appsrc name=src format=time is-live=false max-bytes=" +
+                       std::to_string(static_cast<uint64_t>(config.record_queue_mb) * 1024 * 1024);
+    if (codec.parser) {
+        desc += std::string(" ! ") + codec.parser;
+    }
+    desc += " ! splitmuxsink name=mux";
+
+    GError* error = nullptr;
+    GstElement* writer = gst_parse_launch(desc.c_str(), &error);
+    if (error) {
+        std::cerr << "录制: 无法创建写盘管道: " << error->message << std::endl;
+        g_error_free(error);
+        if (writer) gst_object_unref(writer);
+        return nullptr;
+    }
+
+    GstElement* mux = gst_bin_get_by_name(GST_BIN(writer), "mux");
+    GstElement* muxer = gst_element_factory_make(mp4 ? "mp4mux" : "matroskamux", nullptr);
+    if (!mux || !muxer) {
+        std::cerr << "录制: 缺少" << (mp4 ? "mp4mux" : "matroskamux") << std::endl;
+        if (muxer) gst_object_unref(muxer);
+        if (mux) gst_object_unref(mux);
+        gst_object_unref(writer);
+        return nullptr;
+    }
+    g_object_set(mux,
+                 "muxer", muxer,
+                 "location", location.c_str(),
+                 "max-size-time", static_cast<guint64>(config.record_segment_seconds) * GST_SECOND,
+                 "max-size-bytes", static_cast<guint64>(config.record_segment_mb) * 1024 * 1024,
+                 nullptr);
+    gst_object_unref(mux);
+    return writer;
+}
+
+StreamRecorder::~StreamRecorder() {
+    detach();
+    stopFinalize();
+}
+
+void StreamRecorder::attach(GstElement* pipeline, const VideoPipelineConfig& config) {
+    detach();
+    config_ = config;
+    GstElement* sink = gst_bin_get_by_name(GST_BIN(pipeline), "record_sink");
+    if (!sink) return;
+    sink_ = GST_APP_SINK(sink);
+
+    // 在录制队列的流线程中直接取走样本，appsink内部不积压
+    GstAppSinkCallbacks callbacks = {};
+    callbacks.new_sample = &StreamRecorder::onNewSample;
+    gst_app_sink_set_callbacks(sink_, &callbacks, this, nullptr);
+}
+
+void StreamRecorder::detach() {
+    stop();
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (GstBuffer* buffer : prerecord_) {
+        gst_buffer_unref(buffer);
+    }
+    prerecord_.clear();
+    prerecord_bytes_ = 0;
+    if (caps_) {
+        gst_caps_unref(caps_);
+        caps_ = nullptr;
+    }
+    if (sink_) {
+        gst_object_unref(sink_);
+        sink_ = nullptr;
+    }
+}
+
+bool StreamRecorder::start(const std::string& path_prefix) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!sink_ || writer_) return false;
+
+    const std::string location = path_prefix + "_%05d" +
+        (effectiveFormat(config_) == RecordFormat::Mp4 ? ".mp4" : ".mkv");
+    GstElement* writer = createWriter(config_, location);
+    if (!writer) return false;
+    GstElement* src = gst_bin_get_by_name(GST_BIN(writer), "src");
+    if (caps_) {
+        gst_app_src_set_caps(GST_APP_SRC(src), caps_);
+    }
+    if (gst_element_set_state(writer, GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE) {
+        std::cerr << "录制: 无法启动写盘管道: " << location << std::endl;
+        gst_element_set_state(writer, GST_STATE_NULL);
+        gst_object_unref(src);
+        gst_object_unref(writer);
+        return false;
+    }
+
+    writer_ = writer;
+    writer_src_ = src;
+    base_time_ = GST_CLOCK_TIME_NONE;
+    wait_keyframe_ = true;
+    stats_ = RecordingStats();
+    stats_.location = location;
+
+    // 先写入预录缓存（从关键帧开始），之后的帧由流线程续写
+    for (GstBuffer* buffer : prerecord_) {
+        writeBuffer(buffer);
+    }
+    return true;
+}
+
+void StreamRecorder::stop() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (writer_) {
+        releaseWriter(true);
+    }
+}
+
+bool StreamRecorder::isRecording() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return writer_ != nullptr;
+}
+
+RecordingStats StreamRecorder::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    RecordingStats stats = stats_;
+    stats.active = writer_ != nullptr;
+    return stats;
+}
+
+GstFlowReturn StreamRecorder::onNewSample(GstAppSink* sink, gpointer user_data) {
+    GstSample* sample = gst_app_sink_pull_sample(sink);
+    if (!sample) return GST_FLOW_OK;
+    auto* self = static_cast<StreamRecorder*>(user_data);
+    GstCaps* caps = gst_sample_get_caps(sample);
+    GstBuffer* buffer = gst_sample_get_buffer(sample);
+    {
+        std::lock_guard<std::mutex> lock(self->mutex_);
+        if (caps && (!self->caps_ || !gst_caps_is_equal(caps, self->caps_))) {
+            gst_caps_replace(&self->caps_, caps);
+            if (self->writer_src_) {
+                gst_app_src_set_caps(GST_APP_SRC(self->writer_src_), caps);
+            }
+        }
+    }
+    if (buffer) {
+        self->pushBuffer(buffer);
+    }
+    gst_sample_unref(sample);
+    return GST_FLOW_OK;
+}
+
+// 流线程中调用：放入预录缓存，录制中同时写盘
+void StreamRecorder::pushBuffer(GstBuffer* buffer) {
+    const bool keyframe = isKeyframe(buffer);
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // 缓存总是从关键帧开始，之前的差分帧没有参考帧，无法单独播放
+    if (config_.prerecord_ms > 0 && (keyframe || !prerecord_.empty())) {
+        prerecord_.push_back(gst_buffer_ref(buffer));
+        prerecord_bytes_ += gst_buffer_get_size(buffer);
+        trimPrerecord();
+    }
+
+    if (writer_) {
+        if (keyframe && writerFailed()) {
+            releaseWriter(false);
+            return;
+        }
+        writeBuffer(buffer);
+    }
+}
+
+// 每帧到达时检查：若从第二个关键帧起已覆盖预录时长（或超出内存上限），丢弃最早的GOP
+void StreamRecorder::trimPrerecord() {
+    const GstClockTime window = static_cast<GstClockTime>(config_.prerecord_ms) * GST_MSECOND;
+    const GstClockTime newest = GST_BUFFER_DTS_OR_PTS(prerecord_.back());
+    while (prerecord_.size() > 1) {
+        size_t next = 1;
+        while (next < prerecord_.size() && !isKeyframe(prerecord_[next])) ++next;
+        if (next == prerecord_.size()) break;
+
+        const GstClockTime start = GST_BUFFER_DTS_OR_PTS(prerecord_[next]);
+        const bool covered = GST_CLOCK_TIME_IS_VALID(start) && GST_CLOCK_TIME_IS_VALID(newest) &&
+                             newest >= start && newest - start >= window;
+        if (!covered && prerecord_bytes_ <= MAX_PRERECORD_BYTES) break;
+
+        for (size_t i = 0; i < next; ++i) {
+            prerecord_bytes_ -= gst_buffer_get_size(prerecord_.front());
+            gst_buffer_unref(prerecord_.front());
+            prerecord_.pop_front();
+        }
+    }
+}
+
+// 推入写盘管道（调用方持有mutex_）：从不阻塞，待写数据过多时丢弃到下一个关键帧
+void StreamRecorder::writeBuffer(GstBuffer* buffer) {
+    const bool keyframe = isKeyframe(buffer);
+    if (wait_keyframe_ && !keyframe) {
+        if (GST_CLOCK_TIME_IS_VALID(base_time_)) stats_.frames_dropped++;
+        return;
+    }
+    const uint64_t limit = static_cast<uint64_t>(config_.record_queue_mb) * 1024 * 1024;
+    if (gst_app_src_get_current_level_bytes(GST_APP_SRC(writer_src_)) > limit) {
+        stats_.frames_dropped++;
+        wait_keyframe_ = true;
+        return;
+    }
+    wait_keyframe_ = false;
+
+    // 浅拷贝（共享内存）后改写时间戳，使文件从0开始
+    if (!GST_CLOCK_TIME_IS_VALID(base_time_)) {
+        base_time_ = GST_BUFFER_DTS_OR_PTS(buffer);
+    }
+    GstBuffer* out = gst_buffer_copy(buffer);
+    if (GST_CLOCK_TIME_IS_VALID(base_time_)) {
+        auto shift = [this](GstClockTime ts) {
+            if (!GST_CLOCK_TIME_IS_VALID(ts)) return ts;
+            return ts > base_time_ ? ts - base_time_ : 0;
+        };
+        GST_BUFFER_PTS(out) = shift(GST_BUFFER_PTS(out));
+        GST_BUFFER_DTS(out) = shift(GST_BUFFER_DTS(out));
+    }
+    stats_.frames_written++;
+    stats_.bytes_written += gst_buffer_get_size(out);
+    gst_app_src_push_buffer(GST_APP_SRC(writer_src_), out);
+}
+
+// 写盘管道是否出错（磁盘满、无法创建文件等，调用方持有mutex_）
+bool StreamRecorder::writerFailed() {
+    GstBus* bus = gst_element_get_bus(writer_);
+    GstMessage* msg = gst_bus_pop_filtered(bus, GST_MESSAGE_ERROR);
+    gst_object_unref(bus);
+    if (!msg) return false;
+
+    GError* error = nullptr;
+    gst_message_parse_error(msg, &error, nullptr);
+    std::cerr << "录制出错，已停止: " << (error ? error->message : "未知错误") << std::endl;
+    if (error) g_error_free(error);
+    gst_message_unref(msg);
+    return true;
+}
+
+// 交出写盘管道（调用方持有mutex_）：只放入写完队列，EOS和等待muxer写完都在后台线程中进行
+void StreamRecorder::releaseWriter(bool finish) {
+    PendingWriter pending{writer_, writer_src_, finish};
+    writer_ = nullptr;
+    writer_src_ = nullptr;
+    stats_.active = false;
+
+    std::lock_guard<std::mutex> lock(finalize_mutex_);
+    finalize_queue_.push_back(pending);
+    if (!finalize_thread_.joinable()) {
+        finalize_thread_ = std::thread(&StreamRecorder::runFinalize, this);
+    }
+    finalize_cv_.notify_one();
+}
+
+void StreamRecorder::runFinalize() {
+    std::unique_lock<std::mutex> lock(finalize_mutex_);
+    while (true) {
+        finalize_cv_.wait(lock, [this] { return finalize_exit_ || !finalize_queue_.empty(); });
+        if (finalize_queue_.empty()) return;  // 退出前先写完所有已交出的管道
+        const PendingWriter pending = finalize_queue_.front();
+        finalize_queue_.pop_front();
+        lock.unlock();
+
+        if (pending.finish) {
+            gst_app_src_end_of_stream(GST_APP_SRC(pending.src));
+            GstBus* bus = gst_element_get_bus(pending.writer);
+            GstMessage* msg = gst_bus_timed_pop_filtered(bus, FINALIZE_TIMEOUT,
+                static_cast<GstMessageType>(GST_MESSAGE_EOS | GST_MESSAGE_ERROR));
+            if (!msg) {
+                std::cerr << "录制: 等待文件写完超时" << std::endl;
+            } else {
+                gst_message_unref(msg);
+            }
+            gst_object_unref(bus);
+        }
+        gst_element_set_state(pending.writer, GST_STATE_NULL);
+        gst_object_unref(pending.src);
+        gst_object_unref(pending.writer);
+
+        lock.lock();
+    }
+}
+
+// 析构时调用（不持有mutex_）：等待队列中的文件写完
+void StreamRecorder::stopFinalize() {
+    {
+        std::lock_guard<std::mutex> lock(finalize_mutex_);
+        finalize_exit_ = true;
+    }
+    finalize_cv_.notify_one();
+    if (finalize_thread_.joinable()) {
+        finalize_thread_.join();
+    }
+}
@@ -0,0 +1,88 @@
+/*
+file: src/core/video/stream_recorder.h
+date: 2026/10/16
+*/
+#ifndef STREAM_RECORDER_H
+#define STREAM_RECORDER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <gst/gst.h>
+#include <gst/app/gstappsink.h>
+#include "core/video/pipeline_config.h"
+
+// 录制统计
+struct RecordingStats {
+    bool active = false;
+    uint64_t frames_written = 0;    // 本次录制写入的帧（含预录）
+    uint64_t frames_dropped = 0;    // 写盘跟不上时丢弃的帧
+    uint64_t bytes_written = 0;
+    std::string location;           // 文件名模式（splitmuxsink的location）
+};
+
+// 直通录制
+// 接收管道的record_sink收到depay/parse之后的压缩帧：平时只放进预录缓存（按时长保留，总是从关键帧开始），
+// 开始录制时先写入缓存再续写后续帧。写入由独立的写盘管道完成：
+//   appsrc ! [parse] ! splitmuxsink(matroskamux/mp4mux)，按时长或大小在关键帧处切分文件。
+// 推入写盘管道从不阻塞：待写数据超过record_queue_mb时丢弃到下一个关键帧，显示支路不受磁盘速度影响。
+class StreamRecorder {
+public:
+    StreamRecorder() = default;
+    ~StreamRecorder();
+
+    StreamRecorder(const StreamRecorder&) = delete;
+    StreamRecorder& operator=(const StreamRecorder&) = delete;
+
+    // 接管名为record_sink的appsink（管道未启用录制支路时不做任何事）
+    void attach(GstElement* pipeline, const VideoPipelineConfig& config);
+    void detach();
+
+    // 开始录制：文件为path_prefix_00000.mkv（或.mp4）起依次编号；已在录制或没有录制支路时返回false
+    bool start(const std::string& path_prefix);
+    // 停止录制：发送EOS后由后台写完线程等待文件写完，不阻塞调用方
+    void stop();
+
+    bool isRecording() const;
+    RecordingStats stats() const;
+
+private:
+    static GstFlowReturn onNewSample(GstAppSink* sink, gpointer user_data);
+    void pushBuffer(GstBuffer* buffer);
+    void trimPrerecord();
+    void writeBuffer(GstBuffer* buffer);
+    bool writerFailed();
+    void releaseWriter(bool finish);
+    void runFinalize();
+    void stopFinalize();
+
+    VideoPipelineConfig config_;
+    GstAppSink* sink_ = nullptr;
+
+    mutable std::mutex mutex_;             // 以下成员由流线程与调用方共享
+    std::deque<GstBuffer*> prerecord_;     // 预录缓存，首个元素总是关键帧
+    uint64_t prerecord_bytes_ = 0;
+    GstCaps* caps_ = nullptr;              // 压缩码流的当前caps
+    GstElement* writer_ = nullptr;         // 写盘管道（未录制时为空）
+    GstElement* writer_src_ = nullptr;
+    GstClockTime base_time_ = GST_CLOCK_TIME_NONE;  // 写入的第一帧时间戳，文件从0开始
+    bool wait_keyframe_ = false;           // 丢帧后等待关键帧再续写
+    RecordingStats stats_;
+
+    // 交出的写盘管道依次在后台线程中写完并释放；入队只持有finalize_mutex_，从不等待
+    struct PendingWriter {
+        GstElement* writer;
+        GstElement* src;
+        bool finish;                       // 发送EOS并等待muxer写完（出错时直接释放）
+    };
+    std::mutex finalize_mutex_;
+    std::condition_variable finalize_cv_;
+    std::deque<PendingWriter> finalize_queue_;
+    bool finalize_exit_ = false;
+    std::thread finalize_thread_;          // 首次交出写盘管道时启动，析构时写完队列后退出
+};
+
+#endif // STREAM_RECORDER_H
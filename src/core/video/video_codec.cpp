@@ -0,0 +1,48 @@
+/*
+file: src/core/video/video_codec.cpp
+date: 2026/10/16
+*/
+#include "core/video/video_codec.h"
+#include <cctype>
+
+static const CodecInfo CODECS[] = {
+    {VideoCodec::H264,  "H264",  "H264", "rtph264depay", "h264parse", "avdec_h264"},
+    {VideoCodec::H265,  "H265",  "H265", "rtph265depay", "h265parse", "avdec_h265"},
+    {VideoCodec::VP8,   "VP8",   "VP8",  "rtpvp8depay",  nullptr,     "vp8dec"},
+    {VideoCodec::VP9,   "VP9",   "VP9",  "rtpvp9depay",  nullptr,     "vp9dec"},
+    {VideoCodec::MJPEG, "MJPEG", "JPEG", "rtpjpegdepay", nullptr,     "jpegdec"},
+};
+
+const CodecInfo& codecInfo(VideoCodec codec) {
+    for (const auto& info : CODECS) {
+        if (info.codec == codec) return info;
+    }
+    return CODECS[0];
+}
+
+bool codecFromName(const std::string& name, VideoCodec* codec) {
+    std::string upper;
+    for (char c : name) {
+        if (c != '.' && c != '-' && c != '_') {
+            upper += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        }
+    }
+    if (upper == "AVC") upper = "H264";
+    if (upper == "HEVC") upper = "H265";
+    if (upper == "JPEG") upper = "MJPEG";
+
+    for (const auto& info : CODECS) {
+        if (upper == info.name) {
+            *codec = info.codec;
+            return true;
+        }
+    }
+    return false;
+}
+
+const std::vector<VideoCodec>& codecsByEfficiency() {
+    static const std::vector<VideoCodec> order = {
+        VideoCodec::H265, VideoCodec::VP9, VideoCodec::H264, VideoCodec::VP8, VideoCodec::MJPEG,
+    };
+    return order;
+}
@@ -0,0 +1,42 @@
+/*
+file: src/core/video/video_codec.h
+date: 2026/10/16
+*/
+#ifndef VIDEO_CODEC_H
+#define VIDEO_CODEC_H
+
+#include <string>
+#include <vector>
+
+// 支持的视频编码格式
+enum class VideoCodec {
+    H264,
+    H265,
+    VP8,
+    VP9,
+    MJPEG
+};
+
+// 编码格式对应的RTP参数和GStreamer元素
+struct CodecInfo {
+    VideoCodec codec;
+    const char* name;             // 控制协议中的名称（摄像头列表/选择消息）
+    const char* encoding_name;    // RTP caps中的encoding-name
+    const char* depayloader;
+    const char* parser;           // 硬件解码器前需要的解析器，可为nullptr
+    const char* default_decoder;  // 软件解码器，探测失败时使用
+};
+
+const CodecInfo& codecInfo(VideoCodec codec);
+
+inline const char* codecName(VideoCodec codec) {
+    return codecInfo(codec).name;
+}
+
+// 按协议名称查找（不区分大小写，接受HEVC/JPEG等别名），未知名称返回false
+bool codecFromName(const std::string& name, VideoCodec* codec);
+
+// 按带宽效率从高到低排列：H.265、VP9、H.264、VP8、MJPEG
+const std::vector<VideoCodec>& codecsByEfficiency();
+
+#endif // VIDEO_CODEC_H
@@ -0,0 +1,119 @@
+/*
+file: src/core/video/video_frame.h
+date: 2026/10/16
+*/
+#ifndef VIDEO_FRAME_H
+#define VIDEO_FRAME_H
+
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <gst/gst.h>
+#include <gst/video/video.h>
+
+// 帧在各阶段的时刻（steady_clock纳秒，0表示未记录），见LatencyTracker
+struct FrameTiming {
+    int64_t arrival_ns = 0;   // 首个RTP包到达udpsrc
+    int64_t jitter_ns = 0;    // 离开jitterbuffer
+    int64_t depay_ns = 0;     // depay组帧完成
+    int64_t decode_ns = 0;    // 解码完成
+    int64_t ready_ns = 0;     // 转换完成，交给帧回调
+};
+
+// 解码后的视频帧
+// 持有GstBuffer的引用并保持映射，直到对象销毁（纹理上传完成后）才释放，
+// 从appsink到纹理上传之间不再进行任何CPU拷贝。只可移动，不可复制。
+class VideoFrame {
+public:
+    VideoFrame() = default;
+
+    // 从appsink取得的sample构造（内部增加buffer引用，调用者仍需释放sample）
+    static VideoFrame fromSample(GstSample* sample) {
+        VideoFrame frame;
+        if (!sample) return frame;
+
+        GstBuffer* buffer = gst_sample_get_buffer(sample);
+        GstCaps* caps = gst_sample_get_caps(sample);
+        GstVideoInfo info;
+        gst_video_info_init(&info);
+        if (buffer && caps && gst_video_info_from_caps(&info, caps)) {
+            frame.map(buffer, info);
+        }
+        return frame;
+    }
+
+    // 从已知格式的buffer构造（内部增加buffer引用）
+    static VideoFrame fromBuffer(GstBuffer* buffer, const GstVideoInfo& info) {
+        VideoFrame frame;
+        if (buffer) frame.map(buffer, info);
+        return frame;
+    }
+
+    ~VideoFrame() { release(); }
+
+    VideoFrame(const VideoFrame&) = delete;
+    VideoFrame& operator=(const VideoFrame&) = delete;
+
+    VideoFrame(VideoFrame&& other) noexcept
+        : frame_(other.frame_), mapped_(other.mapped_), timing_(other.timing_) {
+        other.mapped_ = false;
+    }
+
+    VideoFrame& operator=(VideoFrame&& other) noexcept {
+        if (this != &other) {
+            release();
+            frame_ = other.frame_;
+            mapped_ = other.mapped_;
+            timing_ = other.timing_;
+            other.mapped_ = false;
+        }
+        return *this;
+    }
+
+    // 解除映射并归还buffer（可提前调用）
+    void release() {
+        if (mapped_) {
+            gst_video_frame_unmap(&frame_);
+            mapped_ = false;
+        }
+    }
+
+    bool valid() const { return mapped_; }
+    int width() const { return mapped_ ? GST_VIDEO_FRAME_WIDTH(&frame_) : 0; }
+    int height() const { return mapped_ ? GST_VIDEO_FRAME_HEIGHT(&frame_) : 0; }
+    GstVideoFormat format() const {
+        return mapped_ ? GST_VIDEO_FRAME_FORMAT(&frame_) : GST_VIDEO_FORMAT_UNKNOWN;
+    }
+
+    // 第0平面（RGBA为唯一平面）
+    const uint8_t* data() const {
+        return mapped_ ? static_cast<const uint8_t*>(GST_VIDEO_FRAME_PLANE_DATA(&frame_, 0)) : nullptr;
+    }
+    int stride() const { return mapped_ ? GST_VIDEO_FRAME_PLANE_STRIDE(&frame_, 0) : 0; }
+    size_t size() const { return mapped_ ? GST_VIDEO_FRAME_SIZE(&frame_) : 0; }
+
+    // 纹理上传要求RGBA且行紧密排列（行跨度等于宽度*4，无额外对齐）
+    bool isPackedRgba() const {
+        return mapped_ && format() == GST_VIDEO_FORMAT_RGBA &&
+               static_cast<size_t>(stride()) == static_cast<size_t>(width()) * 4;
+    }
+
+    GstBuffer* buffer() const { return mapped_ ? frame_.buffer : nullptr; }
+    const GstVideoFrame* raw() const { return mapped_ ? &frame_ : nullptr; }
+
+    FrameTiming& timing() { return timing_; }
+    const FrameTiming& timing() const { return timing_; }
+
+private:
+    void map(GstBuffer* buffer, const GstVideoInfo& info) {
+        // gst_video_frame_map会增加buffer引用，unmap时释放
+        GstVideoInfo map_info = info;
+        mapped_ = gst_video_frame_map(&frame_, &map_info, buffer, GST_MAP_READ);
+    }
+
+    GstVideoFrame frame_{};
+    bool mapped_ = false;
+    FrameTiming timing_;
+};
+
+#endif // VIDEO_FRAME_H
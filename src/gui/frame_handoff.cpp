@@ -0,0 +1,26 @@
+/*
+file: src/gui/frame_handoff.cpp
+date: 2026/10/16
+*/
+#include "gui/frame_handoff.h"
+#include <iostream>
+
+HandoffResult handOffFrame(FrameQueue<VideoFrame>& queue, VideoFrame&& frame) {
+    if (!frame.isPackedRgba()) {
+        // 数据格式异常，记录错误避免越界
+        std::cerr << "视频帧布局不符预期: 期望行跨度 " << frame.width() * 4
+                  << " 实际 " << frame.stride() << std::endl;
+        return HandoffResult::BadLayout;
+    }
+    return queue.tryPush(std::move(frame)) ? HandoffResult::Queued : HandoffResult::QueueFull;
+}
+
+VideoFrame* takeFrame(FrameQueue<VideoFrame>& queue, PresentMode mode, uint64_t* skipped) {
+    if (mode == PresentMode::Mailbox) {
+        while (queue.size() > 1) {
+            queue.popFront();
+            ++*skipped;
+        }
+    }
+    return queue.front();
+}
@@ -0,0 +1,28 @@
+/*
+file: src/gui/frame_handoff.h
+date: 2026/10/16
+*/
+#ifndef FRAME_HANDOFF_H
+#define FRAME_HANDOFF_H
+
+#include <cstdint>
+#include "core/video/pipeline_config.h"
+#include "core/video/video_frame.h"
+#include "utils/frame_queue.h"
+
+// 视频线程 -> UI线程的帧交接（VideoClientUI::pushVideoFrame/updateStreamFrame，基准测试直接调用）
+
+enum class HandoffResult {
+    Queued,
+    QueueFull,      // 队列已满，帧被丢弃（析构时buffer归还GStreamer）
+    BadLayout       // 不是行紧密排列的RGBA，纹理上传会越界，丢弃
+};
+
+// 视频线程调用：校验布局后推入该路的帧队列
+HandoffResult handOffFrame(FrameQueue<VideoFrame>& queue, VideoFrame&& frame);
+
+// UI线程调用：取出队首待上传的帧（上传后由调用方popFront），没有时返回nullptr
+// Mailbox时先丢弃积压的旧帧，只留最新一帧，丢弃数累加到skipped
+VideoFrame* takeFrame(FrameQueue<VideoFrame>& queue, PresentMode mode, uint64_t* skipped);
+
+#endif // FRAME_HANDOFF_H
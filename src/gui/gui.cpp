@@ -4,25 +4,63 @@ author: Linductor
 date: 2025/05/04
 */
 #include "gui/gui.h"
+#include "gui/frame_handoff.h"
 #include <SFML/Graphics.hpp>
 #include <iostream>
 #include <atomic>
 #include <mutex>
-#include <deque>
 #include <chrono>
+#include <cstdio>
+#include <thread>
+#include "utils/grid_layout.h"
 
 // 字体文件路径（需实际存在）
 #define FONT_PATH "res/SweiSansCJKjp-Medium.ttf"
 
+// 录制文件目录（R键开始/停止）
+static const char* RECORDING_DIR = "recordings";
+
+// 视频面板内可显示区域（面板900x600，四周留边）
+static constexpr int VIDEO_AREA_WIDTH = 860;
+static constexpr int VIDEO_AREA_HEIGHT = 580;
+
+// 窗口背景色
+static const sf::Color BACKGROUND_COLOR(25, 25, 35);
+
+// 画布分区（窗口1280x720）：左侧服务器列表、右侧视频面板、底部状态栏
+static const sf::FloatRect SERVER_LIST_REGION(0, 0, 335, 675);
+static const sf::FloatRect VIDEO_REGION(335, 0, 945, 675);
+static const sf::FloatRect STATUS_REGION(0, 675, 1280, 45);
+
+// 空闲时检查输入的间隔（SFML不能从其他线程唤醒waitEvent，按此间隔取事件，不绘制）
+// 最近有输入时每10ms取一次，保证拖动、连续按键的响应；无输入超过INPUT_ACTIVE_WINDOW后退到100ms，
+// 空闲唤醒由每秒100次降为10次（新帧、网络状态变化仍经条件变量立即唤醒）
+static constexpr auto INPUT_POLL_INTERVAL = std::chrono::milliseconds(10);
+static constexpr auto IDLE_INPUT_POLL_INTERVAL = std::chrono::milliseconds(100);
+static constexpr auto INPUT_ACTIVE_WINDOW = std::chrono::seconds(2);
+
+// 状态栏定时刷新的间隔（接收指标每秒更新一次）
+static constexpr auto STATUS_REFRESH_INTERVAL = std::chrono::seconds(1);
+
+// 相邻两次呈现的最小间隔：多路的帧在此间隔内先后到达时合并为一次呈现
+static constexpr auto MIN_PRESENT_INTERVAL = std::chrono::microseconds(1000000 / 120);
+
+// 状态栏中的接收指标：丢包率、码率、解码帧率
+static std::string metricsSummary(const ReceiverMetrics& metrics) {
+    char text[96];
+    snprintf(text, sizeof(text), "丢包:%.1f%% 码率:%.0fkbps 帧率:%.0ffps",
+             metrics.loss_rate * 100.0, metrics.bitrate_kbps, metrics.decode_fps);
+    return text;
+}
+
 // 全局资源定义
 ServerListCache server_cache;
 std::atomic<bool> ui_running{false};
-std::deque<RawVideoFrame> raw_frames;
-std::mutex frame_mutex;
+std::array<FrameQueue<VideoFrame>, NetworkManager::MAX_STREAMS> stream_frames;
 
 VideoClientUI::VideoClientUI() 
     : server_list_widget_(net_manager_, server_cache) { // 初始化列表传递参数
-    // 其他成员变量初始化（若有）
+    presented_arrivals_.reserve(NetworkManager::MAX_STREAMS);
 }
 
 VideoClientUI::~VideoClientUI() {
@@ -40,11 +78,23 @@ bool VideoClientUI::init() {
     }
 
     window.create(sf::VideoMode(1280, 720), sf::String::fromUtf8(std::begin("视频客户端"), std::end("视频客户端")), sf::Style::Close);
-    window.setFramerateLimit(60);
+
+    // 常驻画布：只重绘脏区域，呈现时整体绘制到窗口（创建失败时每次重绘全部区域）
+    canvas_ready_ = canvas_.create(1280, 720);
+    if (canvas_ready_) {
+        canvas_.clear(BACKGROUND_COLOR);
+        canvas_sprite_.setTexture(canvas_.getTexture());
+    } else {
+        std::cerr << "无法创建离屏画布，改为每次重绘全部区域" << std::endl;
+    }
+
+    // 视频帧经PBO异步上传（需要窗口的上下文，不支持时自动退回同步上传）
+    window.setActive(true);
+    texture_uploader_.init();
     
     // 初始化网络组件
     net_manager_.setServerListCallback(
-        [this](const auto& servers){ this->updateServerListUI(servers); });
+        [this](const ServerRegistryDelta& delta){ this->updateServerListUI(delta); });
     // net_manager_.setStatusCallback(
     //     [this](bool conn, const std::string& msg){ this->onConnectionStatus(conn, msg); });
     // 网络状态绑定
@@ -56,24 +106,25 @@ bool VideoClientUI::init() {
     net_manager_.setCameraListCallback([this](const std::vector<int>& cams){
         if (!cams.empty()) {
             showCameraSelection(cams);
+            markDirty(DIRTY_VIDEO);
         }else {
-            status_text.setString("错误：无可用摄像头");
+            std::cerr << "错误：无可用摄像头" << std::endl;
         }
     });
 
+    // 呈现策略与延迟策略
+    net_manager_.setPresentMode(present_mode_);
+    net_manager_.setLatencyProfile(latency_profile_);
+
+    // 按显示面板大小协商码流：不超过720p的小窗口只需30帧（多路时由网络模块按单元格划分）
+    net_manager_.setDisplayConstraints(VIDEO_AREA_WIDTH, VIDEO_AREA_HEIGHT,
+        VIDEO_AREA_WIDTH * VIDEO_AREA_HEIGHT <= 1280 * 720 ? 30 : 60);
+
     // 视频帧回调
-    net_manager_.setFrameCallback([this](const VideoFrame& frame) {
-        if (frame.data && frame.width > 0 && frame.height > 0) {
-            // 将像素数据拷贝到缓冲区（需考虑格式对齐）
-            std::vector<uint8_t> pixels(
-                frame.data, 
-                frame.data + frame.size
-            );
-            this->pushVideoFrame(
-                frame.width, 
-                frame.height, 
-                std::move(pixels)
-            );
+    net_manager_.setFrameCallback([this](int stream, VideoFrame&& frame) {
+        if (frame.data() && frame.width() > 0 && frame.height() > 0) {
+            // 直接转交帧对象（持有GstBuffer），像素只在上传纹理时拷贝一次
+            this->pushVideoFrame(stream, std::move(frame));
         }
     });
     
@@ -84,7 +135,10 @@ bool VideoClientUI::init() {
     }
     server_list_widget_.setPosition(20, 80);
     server_list_widget_.setSelectCallback(
-        [this](const Json::Value& server){ this->onServerSelected(server); });
+        [this](const ServerEntry& server){ this->onServerSelected(server); });
+
+    // 持续发现：启动即探测，之后服务器上线/下线自动反映到列表
+    net_manager_.startDiscovery();
     
     // 初始化其他UI组件
     initVideoPanel();
@@ -100,6 +154,14 @@ void VideoClientUI::initVideoPanel() {
     video_border.setFillColor(sf::Color(30, 30, 40));
     video_border.setOutlineThickness(2);
     video_border.setOutlineColor(sf::Color(80, 80, 100));
+
+    for (auto& view : stream_views_) {
+        view.label.setFont(font);
+        view.label.setCharacterSize(14);
+        view.label.setFillColor(sf::Color(220, 220, 220));
+        view.label.setOutlineColor(sf::Color::Black);
+        view.label.setOutlineThickness(1);
+    }
 }
 
 // 状态栏初始化
@@ -121,10 +183,66 @@ void VideoClientUI::initStatusBar() {
 void VideoClientUI::handleEvents() {
     sf::Event event;
     while (window.pollEvent(event)) {
+        last_input_ = std::chrono::steady_clock::now();
         if (event.type == sf::Event::Closed) {
             window.close();
         }
 
+        // 点击可能改变任一区域（选择服务器、摄像头窗口等），按键只影响状态栏
+        if (event.type == sf::Event::MouseButtonPressed) {
+            dirty_.fetch_or(DIRTY_ALL);
+        } else if (event.type == sf::Event::KeyPressed) {
+            dirty_.fetch_or(DIRTY_STATUS);
+        } else if (event.type == sf::Event::GainedFocus) {
+            dirty_.fetch_or(DIRTY_PRESENT);
+        }
+
+        // P键切换呈现策略（顺序/最新帧）
+        if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::P) {
+            present_mode_ = (present_mode_ == PresentMode::Mailbox) ?
+                PresentMode::Fifo : PresentMode::Mailbox;
+            net_manager_.setPresentMode(present_mode_);
+        }
+
+        // L键切换延迟策略（自适应/固定/超低延迟）
+        if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::L) {
+            switch (latency_profile_) {
+                case LatencyProfile::Adaptive: latency_profile_ = LatencyProfile::Fixed; break;
+                case LatencyProfile::Fixed:    latency_profile_ = LatencyProfile::UltraLow; break;
+                default:                       latency_profile_ = LatencyProfile::Adaptive; break;
+            }
+            net_manager_.setLatencyProfile(latency_profile_);
+        }
+
+        // U键切换PBO异步上传/同步上传，便于对比上传耗时
+        if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::U &&
+            texture_uploader_.pboSupported()) {
+            texture_uploader_.setPboEnabled(!texture_uploader_.pboEnabled());
+        }
+
+        // T键切换状态栏的分阶段延迟显示，D键把延迟统计写入文件
+        if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::T) {
+            show_latency_ = !show_latency_;
+        }
+        if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::D) {
+            const std::string path = "latency_stats.txt";
+            const std::string msg = latencyStats().dumpToFile(path) ?
+                "延迟统计已写入 " + path : "延迟统计写入失败: " + path;
+            std::cout << msg << std::endl;
+        }
+
+        // R键开始/停止录制当前各路
+        if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::R && is_connected) {
+            if (net_manager_.isRecording()) {
+                net_manager_.stopRecording();
+                std::cout << "录制已停止" << std::endl;
+            } else if (net_manager_.startRecording(RECORDING_DIR)) {
+                std::cout << "开始录制到 " << RECORDING_DIR << std::endl;
+            } else {
+                std::cerr << "无法开始录制（未选择摄像头或录制支路建立失败）" << std::endl;
+            }
+        }
+
         // 检测视频区域点击（非模态状态下）
         if (!is_modal_open_ && event.type == sf::Event::MouseButtonPressed) {
             sf::Vector2f mouse_pos(event.mouseButton.x, event.mouseButton.y);
@@ -140,9 +258,8 @@ void VideoClientUI::handleEvents() {
                 sf::Vector2f mouse_pos(event.mouseButton.x, event.mouseButton.y);
                 for (size_t i = 0; i < camera_options_.size(); ++i) {
                     if (camera_options_[i].getGlobalBounds().contains(mouse_pos)) {
-                        onCameraSelected(camera_ids_[i]);
+                        onCameraOptionClicked(i);
                         show_camera_options_ = false; // 选择后隐藏
-                        camera_options_.clear();
                         break;
                     }
                 }
@@ -159,9 +276,7 @@ void VideoClientUI::handleEvents() {
                     event.mouseButton.x, 
                     event.mouseButton.y)
                 ) {
-                    int cam_id = camera_ids_[i];
-                    onCameraSelected(cam_id);
-                    camera_options_.clear();
+                    onCameraOptionClicked(i);
                     break;
                 }
             }
@@ -171,62 +286,133 @@ void VideoClientUI::handleEvents() {
     }
 }
 
-// 更新视频帧显示（线程安全）
+// 更新视频帧显示（无锁，上传期间不阻塞视频线程）
 void VideoClientUI::updateVideoFrame() {
-    std::lock_guard<std::mutex> lock(frame_mutex);
-    if (!raw_frames.empty()) {
-        const auto& frame = raw_frames.front();
+    for (int stream = 0; stream < stream_count_; ++stream) {
+        updateStreamFrame(stream);
+    }
+    texture_uploader_.flush();
+}
+
+void VideoClientUI::updateStreamFrame(int stream) {
+    FrameQueue<VideoFrame>& frames = stream_frames[stream];
+    StreamView& view = stream_views_[stream];
+
+    // 最新帧模式：跳过积压的旧帧，出队即归还buffer
+    uint64_t skipped = 0;
+    VideoFrame* pending = takeFrame(frames, present_mode_, &skipped);
+    if (skipped > 0) {
+        dropped_frames_.fetch_add(skipped, std::memory_order_relaxed);
+    }
+
+    if (pending) {
+        const auto& frame = *pending;
+        const unsigned int width = frame.width();
+        const unsigned int height = frame.height();
+        const int64_t dequeued_ns = steadyNowNs();
+        latencyStats().record(LatencyStage::Queue, frame.timing().ready_ns, dequeued_ns);
         
         // 主线程中创建和更新纹理
         // 使用成员纹理，仅在尺寸变化时重新创建
-        if (video_texture.getSize().x != frame.width || video_texture.getSize().y != frame.height) {
-            if (!video_texture.create(frame.width, frame.height)) {
-                std::cerr << "纹理创建失败: " << frame.width << "x" << frame.height << std::endl;
+        if (view.texture.getSize().x != width || view.texture.getSize().y != height) {
+            if (!view.texture.create(width, height)) {
+                std::cerr << "纹理创建失败: " << width << "x" << height << std::endl;
+                frames.popFront();
                 return;
             }
         }
         
-        video_texture.update(frame.pixels.data(), frame.width, frame.height, 0, 0); // 在主线程操作
+        // 直接从映射的GstBuffer上传（经PBO时拷入映射的缓冲，传输与绘制重叠）
+        texture_uploader_.upload(view.texture, frame.data(), width, height); // 在主线程操作
+        latencyStats().record(LatencyStage::Upload, dequeued_ns, steadyNowNs());
+        presented_arrivals_.push_back(frame.timing().arrival_ns);
         
-        video_sprite.setTexture(video_texture, true);
-        raw_frames.pop_front();
-
-        // 自适应缩放
-        auto tex_size = video_sprite.getTexture()->getSize();
-        float scale = std::min(
-            860.0f / tex_size.x, 
-            580.0f / tex_size.y
-        );
-        video_sprite.setScale(scale, scale);
-
-        // 计算居中位置
-        sf::FloatRect video_bounds = video_border.getGlobalBounds();
-        sf::FloatRect sprite_bounds = video_sprite.getGlobalBounds();
-        video_sprite.setPosition(
-            video_bounds.left + (video_bounds.width - sprite_bounds.width) / 2,
-            video_bounds.top + (video_bounds.height - sprite_bounds.height) / 2
-        );
+        view.sprite.setTexture(view.texture, true);
+        view.has_frame = true;
+        frames.popFront(); // 释放帧，buffer归还GStreamer
+
+        layoutStream(stream);
     }
 }
 
-// 状态栏文本更新
-void VideoClientUI::updateStatusText() {
+// 按网格把第stream路缩放并居中到其单元格内
+void VideoClientUI::layoutStream(int stream) {
+    StreamView& view = stream_views_[stream];
+    if (!view.has_frame) return;
+
+    const GridLayout grid = gridLayoutFor(stream_count_);
+    const float cell_width = static_cast<float>(VIDEO_AREA_WIDTH) / grid.cols;
+    const float cell_height = static_cast<float>(VIDEO_AREA_HEIGHT) / grid.rows;
+    sf::FloatRect video_bounds = video_border.getGlobalBounds();
+    const float cell_left = video_bounds.left + (video_bounds.width - VIDEO_AREA_WIDTH) / 2 +
+                            grid.column(stream) * cell_width;
+    const float cell_top = video_bounds.top + (video_bounds.height - VIDEO_AREA_HEIGHT) / 2 +
+                           grid.row(stream) * cell_height;
+
+    // 自适应缩放
+    auto tex_size = view.texture.getSize();
+    float scale = std::min(cell_width / tex_size.x, cell_height / tex_size.y);
+    view.sprite.setScale(scale, scale);
+
+    // 计算居中位置
+    sf::FloatRect sprite_bounds = view.sprite.getGlobalBounds();
+    view.sprite.setPosition(
+        cell_left + (cell_width - sprite_bounds.width) / 2,
+        cell_top + (cell_height - sprite_bounds.height) / 2
+    );
+    view.label.setPosition(cell_left + 6, cell_top + 4);
+}
+
+// 状态栏文本（由当前状态生成）
+std::string VideoClientUI::buildStatusText() {
     std::string status;
     
     if (is_connecting) {
         status = "正在连接...";
-    } else if (net_manager_.isDiscovering()) {
+    } else if (net_manager_.isDiscovering() && server_cache.size() == 0) {
         status = "正在搜索服务器...";
     } else if (!is_connected) {
         status = "未连接 | 发现" + 
-            std::to_string(server_cache.get().size()) + "个服务器";
+            std::to_string(server_cache.size()) + "个服务器";
     } else {
+        size_t buffered = 0;
+        for (int stream = 0; stream < stream_count_; ++stream) {
+            buffered += stream_frames[stream].size();
+        }
         status = "已连接至 " + current_server + 
-            " | 缓冲帧:" + std::to_string(raw_frames.size()) + 
-            " | 网络状态:" + std::to_string(net_manager_.getReceiverStatus());
+            " | 路数:" + std::to_string(stream_count_) + 
+            " | 缓冲帧:" + std::to_string(buffered) + 
+            " | 丢帧:" + std::to_string(dropped_frames_.load()) + 
+            " | 模式:" + presentModeName(present_mode_) + 
+            " | " + metricsSummary(net_manager_.getReceiverMetrics()) + 
+            " | 延迟(" + latencyProfileName(latency_profile_) + "):" + 
+            std::to_string(net_manager_.getLatencyMs()) + "ms" + 
+            " 抖动:" + std::to_string(static_cast<int>(net_manager_.getJitterMs())) + "ms";
+        const DecoderChoice decoder = net_manager_.getStreamDecoder(0);
+        if (!decoder.element.empty()) {
+            status += std::string(" | 解码:") + codecName(decoder.codec) + "/" + decoder.element;
+        }
+        char upload[48];
+        snprintf(upload, sizeof(upload), " | 上传:%s %.1fms", texture_uploader_.pboEnabled() ? "PBO" : "同步",
+                 texture_uploader_.stats().average_upload_ms);
+        status += upload;
+        if (net_manager_.isRecording()) {
+            status += " | 录制中";
+        }
+        if (show_latency_) {
+            status = latencyStats().summary();
+        }
     }
-    
-    status_text.setString(sf::String::fromUtf8(std::begin(status), std::end(status)));
+    return status;
+}
+
+// 刷新状态栏：内容不变时不重新排版，也不触发重绘
+void VideoClientUI::refreshStatus() {
+    std::string status = buildStatusText();
+    if (status == status_string_) return;
+    status_string_ = std::move(status);
+    status_text.setString(sf::String::fromUtf8(status_string_.begin(), status_string_.end()));
+    dirty_.fetch_or(DIRTY_STATUS);
 }
 
 void VideoClientUI::onConnectionStatus(bool connected, const std::string& msg) {
@@ -236,7 +422,7 @@ void VideoClientUI::onConnectionStatus(bool connected, const std::string& msg) {
     std::lock_guard<std::mutex> lock(status_mutex_); // 添加互斥锁
     auto now = std::chrono::system_clock::now();
     is_connected = connected;
-    status_text.setString(msg);
+    std::cout << "连接状态: " << msg << std::endl;
     
     if (!connected) {
         // 断开时重置摄像头相关状态
@@ -260,45 +446,55 @@ void VideoClientUI::onConnectionStatus(bool connected, const std::string& msg) {
         }
     }
     
-    // 重绘状态栏
-    needs_redraw_ = true;
+    // 断开时清空视频面板，状态栏换色
+    markDirty(DIRTY_VIDEO | DIRTY_STATUS);
 }
 
-// 从网络线程接收视频帧（线程安全）
-void VideoClientUI::pushVideoFrame(int width, int height, std::vector<uint8_t> pixels) {
-    std::lock_guard<std::mutex> lock(frame_mutex);
-    if (raw_frames.size() < 10) {
-        // 修改为处理RGBA格式（每个像素4字节）
-        const size_t bytes_per_pixel = 4; // RGBA格式
-        const size_t stride = width * bytes_per_pixel; // 每行字节数（无额外对齐）
-        const size_t expected_size = stride * height;
-
-        // 移除对齐填充逻辑，直接使用数据
-        if (pixels.size() == expected_size) {
-            raw_frames.emplace_back(width, height, std::move(pixels));
-        } else {
-            // 数据大小异常，记录错误避免越界
-            std::cerr << "视频帧大小不符预期: 期望 " << expected_size 
-                      << " 实际 " << pixels.size() << std::endl;
-        }
+// 从网络线程接收视频帧（仅由该路的视频线程调用）
+void VideoClientUI::pushVideoFrame(int stream, VideoFrame frame) {
+    if (stream < 0 || stream >= NetworkManager::MAX_STREAMS) return;
+
+    // 纹理上传要求RGBA且行紧密排列，布局不符时丢弃避免越界；队列已满时丢弃新帧
+    switch (handOffFrame(stream_frames[stream], std::move(frame))) {
+        case HandoffResult::Queued:
+            markDirty(DIRTY_VIDEO);
+            break;
+        case HandoffResult::QueueFull:
+            dropped_frames_.fetch_add(1, std::memory_order_relaxed);
+            break;
+        case HandoffResult::BadLayout:
+            break;
+    }
+}
+
+// 标记脏区域并唤醒UI线程（任意线程可调用）
+void VideoClientUI::markDirty(uint32_t regions) {
+    if (dirty_.fetch_or(regions) == 0) {
+        // 经过互斥量再通知，避免UI线程检查条件后、进入等待前错过唤醒
+        { std::lock_guard<std::mutex> lock(wake_mutex_); }
+        wake_cv_.notify_one();
     }
 }
 
+// 等待新帧或其他线程的重绘请求，最迟到deadline返回
+void VideoClientUI::waitForWork(std::chrono::steady_clock::time_point deadline) {
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    wake_cv_.wait_until(lock, deadline, [this]() { return dirty_.load() != 0; });
+}
+
 // 按钮点击处理
 void VideoClientUI::onRefreshClicked() {
-    server_cache.update({});
-    server_list_widget_.updateList({});
-    status_text.setString(sf::String::fromUtf8(std::begin("正在搜索服务器..."), std::end("正在搜索服务器...")));
     net_manager_.refreshServerList();
+    markDirty(DIRTY_STATUS);
 }
 
-void VideoClientUI::onServerSelected(const Json::Value& server) {
+void VideoClientUI::onServerSelected(const ServerEntry& server) {
     // 创建weak_ptr以避免悬空指针
     // auto weak_self = std::weak_ptr<VideoClientUI>(shared_from_this());
 
-    current_server = server["ip"].asString();
+    current_server = server.ip;
     is_connecting = true;
-    status_text.setString(sf::String::fromUtf8(std::begin("正在连接..."), std::end("正在连接...")));
+    markDirty(DIRTY_STATUS);
     
     // 获取并保存原始回调
     auto original_cam_callback = net_manager_.getCameraListCallback();
@@ -314,48 +510,128 @@ void VideoClientUI::onServerSelected(const Json::Value& server) {
     });
 
     // 发起连接
-    net_manager_.connectToServer(server["ip"].asString(), server["heartbeat_port"].asInt());
+    net_manager_.connectToServer(server.ip, server.heartbeat_port);
 }
 
-// 渲染主循环
+// 渲染主循环（事件驱动）
+// 没有新帧、输入或到期的定时器时不绘制；有新帧时按其到达节奏呈现，不再固定60Hz重绘
 void VideoClientUI::update() {
+    using Clock = std::chrono::steady_clock;
+    auto next_status_refresh = Clock::now();
+    auto last_present = Clock::time_point{};
     while (window.isOpen()) {
         handleEvents();
+        if (!window.isOpen()) break;
+
+        const auto now = Clock::now();
+        if (now >= next_status_refresh || (dirty_.load() & DIRTY_STATUS)) {
+            refreshStatus();
+            next_status_refresh = now + STATUS_REFRESH_INTERVAL;
+        }
+
+        const auto present_at = last_present + MIN_PRESENT_INTERVAL;
+        if (dirty_.load() != 0) {
+            if (now >= present_at) {
+                present(dirty_.exchange(0));
+                last_present = Clock::now();
+            } else {
+                std::this_thread::sleep_until(present_at);
+            }
+            continue;
+        }
+        const auto poll_interval = now - last_input_ < INPUT_ACTIVE_WINDOW ?
+            INPUT_POLL_INTERVAL : IDLE_INPUT_POLL_INTERVAL;
+        waitForWork(std::min<Clock::time_point>(now + poll_interval, next_status_refresh));
+    }
+}
+
+// 取出新帧上传纹理，重绘脏区域并呈现
+void VideoClientUI::present(uint32_t dirty) {
+    if (server_list_pending_.exchange(false)) {
+        server_list_widget_.updateList(server_cache.get());
+    }
+    if (dirty & DIRTY_VIDEO) {
         updateVideoFrame();
-        window.clear(sf::Color(25, 25, 35));
-        
-        // 绘制服务器列表
-        server_list_widget_.draw(window);
-        
-        // 绘制视频区域
-        window.draw(video_border);
-        if (video_sprite.getTexture()) {
-            window.draw(video_sprite);
+        // 顺序模式下每次只取一帧，仍有积压时继续呈现
+        for (int stream = 0; stream < stream_count_; ++stream) {
+            if (!stream_frames[stream].empty()) {
+                dirty_.fetch_or(DIRTY_VIDEO);
+                break;
+            }
+        }
+    }
+
+    if (canvas_ready_) {
+        drawRegions(canvas_, dirty);
+        canvas_.display();
+        window.draw(canvas_sprite_);
+    } else {
+        window.clear(BACKGROUND_COLOR);
+        drawRegions(window, DIRTY_ALL);
+    }
+
+    const int64_t display_begin = steadyNowNs();
+    window.display();
+    const int64_t display_end = steadyNowNs();
+    if (!presented_arrivals_.empty()) {
+        latencyStats().record(LatencyStage::Display, display_begin, display_end);
+        for (int64_t arrival : presented_arrivals_) {
+            latencyStats().record(LatencyStage::Total, arrival, display_end);
+        }
+        presented_arrivals_.clear();
+    }
+}
+
+// 用背景色覆盖区域后重绘其中的组件
+void VideoClientUI::drawRegions(sf::RenderTarget& target, uint32_t dirty) {
+    auto clear_region = [&](const sf::FloatRect& region) {
+        sf::RectangleShape background({region.width, region.height});
+        background.setPosition(region.left, region.top);
+        background.setFillColor(BACKGROUND_COLOR);
+        target.draw(background);
+    };
+
+    // 服务器列表
+    if (dirty & DIRTY_SERVER_LIST) {
+        clear_region(SERVER_LIST_REGION);
+        server_list_widget_.draw(target);
+    }
+
+    // 视频区域与摄像头选择模态窗口
+    if (dirty & DIRTY_VIDEO) {
+        clear_region(VIDEO_REGION);
+        target.draw(video_border);
+        if (is_connected) {
+            for (int stream = 0; stream < stream_count_; ++stream) {
+                const StreamView& view = stream_views_[stream];
+                if (!view.has_frame) continue;
+                target.draw(view.sprite);
+                if (stream_count_ > 1) {
+                    target.draw(view.label);
+                }
+            }
         }
-        
-        // 绘制摄像头选择模态窗口
         if (is_modal_open_) {
-            window.draw(camera_modal_);
+            target.draw(camera_modal_);
             for (auto& opt : camera_options_) {
-                window.draw(opt);
+                target.draw(opt);
             }
         }
-        
-        // 绘制状态栏
-        window.draw(status_bar);
-        updateStatusText();
-        window.draw(status_text);
-        
-        window.display();
+    }
 
-        // 检查窗口状态
-        if (!window.isOpen()) break;
+    // 状态栏
+    if (dirty & DIRTY_STATUS) {
+        clear_region(STATUS_REGION);
+        target.draw(status_bar);
+        target.draw(status_text);
     }
 }
 
-void VideoClientUI::updateServerListUI(const std::vector<Json::Value>& servers) {
-    server_cache.update(servers);
-    server_list_widget_.updateList(servers); 
+// 发现线程中调用：只把增量应用到缓存，由UI线程在下次呈现前同步到列表组件
+void VideoClientUI::updateServerListUI(const ServerRegistryDelta& delta) {
+    server_cache.apply(delta);
+    server_list_pending_.store(true);
+    markDirty(DIRTY_SERVER_LIST | DIRTY_STATUS);
 }
 
 void VideoClientUI::showCameraSelection(const std::vector<int>& cameras) {
@@ -383,6 +659,19 @@ void VideoClientUI::showCameraSelection(const std::vector<int>& cameras) {
         option.setPosition(start_x, start_y + i * 40);
         camera_options_.push_back(option);
     }
+
+    // 多个摄像头时提供网格同时查看
+    if (cameras.size() > 1) {
+        const size_t count = std::min(cameras.size(), static_cast<size_t>(NetworkManager::MAX_STREAMS));
+        const std::string all_name = "同时查看全部 (" + std::to_string(count) + "路)";
+        sf::Text option;
+        option.setFont(font);
+        option.setString(sf::String::fromUtf8(std::begin(all_name), std::end(all_name)));
+        option.setCharacterSize(20);
+        option.setFillColor(sf::Color(140, 200, 255));
+        option.setPosition(start_x, start_y + cameras.size() * 40);
+        camera_options_.push_back(option);
+    }
     is_modal_open_ = true; // 进入模态状态
 }
 
@@ -390,12 +679,47 @@ void VideoClientUI::onCameraSelected(int index) {
     try {
         if (index >= 0 && index < camera_ids_.size()) {
             net_manager_.selectCamera(index);
-            status_text.setString(sf::String::fromUtf8(std::begin("已选择摄像头 " + std::to_string(index)), std::end("已选择摄像头 " + std::to_string(index))));
+            setActiveStreams({index});
         }
     }catch (const std::exception& e) {
         std::cerr << "摄像头选择错误: " << e.what() << std::endl;
-        status_text.setString(sf::String::fromUtf8(std::begin("选择摄像头失败"), std::end("选择摄像头失败")));
     }
     is_modal_open_ = false;
     camera_options_.clear();
-}
\ No newline at end of file
+}
+
+// 摄像头列表中第option项被点击（最后一项可能是“同时查看全部”）
+void VideoClientUI::onCameraOptionClicked(size_t option) {
+    if (option < camera_ids_.size()) {
+        onCameraSelected(camera_ids_[option]);
+    } else {
+        onAllCamerasSelected();
+    }
+    camera_options_.clear();
+}
+
+void VideoClientUI::onAllCamerasSelected() {
+    std::vector<int> cameras = camera_ids_;
+    if (cameras.size() > static_cast<size_t>(NetworkManager::MAX_STREAMS)) {
+        cameras.resize(NetworkManager::MAX_STREAMS);
+    }
+    net_manager_.selectCameras(cameras);
+    setActiveStreams(cameras);
+    is_modal_open_ = false;
+}
+
+// 切换网格内容：清空各路遗留的帧并重置画面
+void VideoClientUI::setActiveStreams(const std::vector<int>& cameras) {
+    for (auto& frames : stream_frames) {
+        while (frames.front()) {
+            frames.popFront();
+        }
+    }
+    stream_count_ = static_cast<int>(std::min(cameras.size(), stream_views_.size()));
+    for (int stream = 0; stream < stream_count_; ++stream) {
+        StreamView& view = stream_views_[stream];
+        view.has_frame = false;
+        const std::string name = "摄像头 " + std::to_string(cameras[stream]);
+        view.label.setString(sf::String::fromUtf8(std::begin(name), std::end(name)));
+    }
+}
@@ -9,24 +9,18 @@ date: 2025/05/04
 
 #include <SFML/Graphics.hpp>
 #include <json/json.h>
+#include <array>
+#include <chrono>
+#include <condition_variable>
 #include <mutex>
+#include <string>
 #include <vector>
 #include <atomic>
+#include "gui/texture_uploader.h"
 #include "gui/widgets/server_list.h"
 #include "core/network/network_manager.h"
-
-struct RawVideoFrame {
-    int width;
-    int height;
-    std::vector<uint8_t> pixels;
-
-    // 添加构造函数
-    RawVideoFrame(int w, int h, std::vector<uint8_t> pix)
-        : width(w), height(h), pixels(std::move(pix)) {}
-    
-    // 删除默认构造函数（按需可选）
-    RawVideoFrame() = delete; 
-};
+#include "utils/frame_queue.h"
+#include "core/video/latency_tracker.h"
 
 class VideoClientUI {
 public:
@@ -35,38 +29,85 @@ public:
     bool init();
     void update();
 
-    // 视频帧处理接口
-    void pushVideoFrame(int width, int height, std::vector<uint8_t> pixels);
+    // 视频帧处理接口（stream为路序号）
+    void pushVideoFrame(int stream, VideoFrame frame);
     
 private:
+    // 脏区域（按区域重绘画布）
+    enum DirtyRegion : uint32_t {
+        DIRTY_SERVER_LIST = 1 << 0,  // 左侧服务器列表
+        DIRTY_VIDEO = 1 << 1,        // 视频面板（含摄像头选择窗口）
+        DIRTY_STATUS = 1 << 2,       // 底部状态栏
+        DIRTY_PRESENT = 1 << 3,      // 画布不变，只重新呈现
+        DIRTY_ALL = DIRTY_SERVER_LIST | DIRTY_VIDEO | DIRTY_STATUS
+    };
+
     void handleEvents();
+    void markDirty(uint32_t regions);
+    void waitForWork(std::chrono::steady_clock::time_point deadline);
+    void present(uint32_t dirty);
+    void drawRegions(sf::RenderTarget& target, uint32_t dirty);
     void updateVideoFrame();
-    void updateStatusText();
+    void updateStreamFrame(int stream);
+    void layoutStream(int stream);
+    std::string buildStatusText();
+    void refreshStatus();
     void initVideoPanel();
     void initStatusBar();
     void onRefreshClicked();
-    void onServerSelected(const Json::Value& server);
+    void onServerSelected(const ServerEntry& server);
     void onConnectionStatus(bool connected, const std::string& msg);
-    void updateServerListUI(const std::vector<Json::Value>& servers);
+    void updateServerListUI(const ServerRegistryDelta& delta);
     void showCameraSelection(const std::vector<int>& cameras);
     void onCameraSelected(int index);
+    void onCameraOptionClicked(size_t option);
+    void onAllCamerasSelected();
+    void setActiveStreams(const std::vector<int>& cameras);
+
+    // 单路画面：纹理、精灵和摄像头标签
+    struct StreamView {
+        sf::Texture texture;
+        sf::Sprite sprite;
+        sf::Text label;
+        bool has_frame = false;
+    };
 
     // UI组件
     sf::RenderWindow window;
+    TextureUploader texture_uploader_;  // 在window之前析构，此时上下文仍有效
     sf::Font font;
     NetworkManager net_manager_;
     ServerListWidget server_list_widget_;
     sf::RectangleShape video_border;
-    sf::Sprite video_sprite;
     sf::RectangleShape status_bar;
     sf::Text status_text;
     sf::RectangleShape camera_modal_;
     std::vector<sf::Text> camera_options_;
-    sf::Texture video_texture;
+    std::array<StreamView, NetworkManager::MAX_STREAMS> stream_views_;
+    int stream_count_ = 0;  // 当前网格中的路数
 
     std::mutex status_mutex_;
     std::chrono::system_clock::time_point last_connected_time_;
-    bool needs_redraw_ = false;
+
+    // 事件驱动的渲染：有新帧、输入或定时器到期时才唤醒，只重绘脏区域到常驻画布后呈现
+    std::atomic<uint32_t> dirty_{DIRTY_ALL};          // 可由网络/视频线程设置
+    std::atomic<bool> server_list_pending_{false};    // 发现线程更新了服务器缓存
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    std::chrono::steady_clock::time_point last_input_;  // 最近一次窗口事件，决定空闲时取事件的间隔
+    sf::RenderTexture canvas_;
+    sf::Sprite canvas_sprite_;
+    bool canvas_ready_ = false;
+    std::string status_string_;                       // 状态栏当前内容，变化时才重新排版
+
+    // 呈现策略与丢帧统计
+    PresentMode present_mode_ = PresentMode::Mailbox;
+    LatencyProfile latency_profile_ = LatencyProfile::Adaptive;
+    std::atomic<uint64_t> dropped_frames_{0};
+
+    // 延迟统计：状态栏显示分阶段延迟，本次循环上传的帧的到达时刻（display后计入总延迟）
+    bool show_latency_ = false;
+    std::vector<int64_t> presented_arrivals_;
 
     // 状态
     std::string current_server;
@@ -79,7 +120,7 @@ private:
 
 extern ServerListCache server_cache;
 extern std::atomic<bool> ui_running;
-extern std::deque<RawVideoFrame> raw_frames;
-extern std::mutex frame_mutex;
+// 每路一个队列：该路接收线程 -> UI线程（单生产者/单消费者）
+extern std::array<FrameQueue<VideoFrame>, NetworkManager::MAX_STREAMS> stream_frames;
 
 #endif // VIDEO_CLIENT_UI_H
\ No newline at end of file
@@ -0,0 +1,152 @@
+/*
+file: src/gui/texture_uploader.cpp
+date: 2026/10/16
+*/
+#include "gui/texture_uploader.h"
+#include <SFML/Window/Context.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+// gl.h只保证OpenGL 1.1，缓冲对象相关的常量在此补齐
+#ifndef GL_PIXEL_UNPACK_BUFFER
+#define GL_PIXEL_UNPACK_BUFFER 0x88EC
+#endif
+#ifndef GL_STREAM_DRAW
+#define GL_STREAM_DRAW 0x88E0
+#endif
+#ifndef GL_WRITE_ONLY
+#define GL_WRITE_ONLY 0x88B9
+#endif
+
+// 上传耗时滑动平均的权重
+static constexpr double UPLOAD_AVERAGE_WEIGHT = 0.1;
+
+// OpenGL 2.1起PBO为核心功能，更早的版本需要ARB_pixel_buffer_object扩展
+static bool hasPixelBufferObjects() {
+    const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+    int major = 0;
+    int minor = 0;
+    if (version && sscanf(version, "%d.%d", &major, &minor) == 2 &&
+        (major > 2 || (major == 2 && minor >= 1))) {
+        return true;
+    }
+    const char* extensions = reinterpret_cast<const char*>(glGetString(GL_EXTENSIONS));
+    return extensions && strstr(extensions, "GL_ARB_pixel_buffer_object");
+}
+
+// Mesa的CPU光栅化驱动
+static bool isSoftwareRenderer(const char* renderer) {
+    return renderer && (strstr(renderer, "llvmpipe") || strstr(renderer, "softpipe") ||
+                        strstr(renderer, "Software Rasterizer"));
+}
+
+TextureUploader::TextureUploader(unsigned int buffer_count)
+    : buffer_count_(std::min(std::max(buffer_count, 2u), 3u)) {}
+
+TextureUploader::~TextureUploader() {
+    if (!delete_buffers_) return;
+    for (auto& entry : rings_) {
+        delete_buffers_(static_cast<GLsizei>(entry.second.buffers.size()), entry.second.buffers.data());
+    }
+}
+
+bool TextureUploader::init() {
+    if (supported_) return true;
+    if (!hasPixelBufferObjects()) {
+        std::cerr << "纹理上传: 不支持PBO，使用同步上传" << std::endl;
+        return false;
+    }
+
+    gen_buffers_ = reinterpret_cast<GenBuffersFn>(sf::Context::getFunction("glGenBuffers"));
+    delete_buffers_ = reinterpret_cast<DeleteBuffersFn>(sf::Context::getFunction("glDeleteBuffers"));
+    bind_buffer_ = reinterpret_cast<BindBufferFn>(sf::Context::getFunction("glBindBuffer"));
+    buffer_data_ = reinterpret_cast<BufferDataFn>(sf::Context::getFunction("glBufferData"));
+    map_buffer_ = reinterpret_cast<MapBufferFn>(sf::Context::getFunction("glMapBuffer"));
+    unmap_buffer_ = reinterpret_cast<UnmapBufferFn>(sf::Context::getFunction("glUnmapBuffer"));
+    if (!gen_buffers_ || !delete_buffers_ || !bind_buffer_ || !buffer_data_ || !map_buffer_ || !unmap_buffer_) {
+        std::cerr << "纹理上传: 无法加载缓冲对象函数，使用同步上传" << std::endl;
+        return false;
+    }
+
+    supported_ = true;
+    const char* renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+    if (isSoftwareRenderer(renderer)) {
+        // 软件渲染的“传输”同样在CPU上执行：经PBO多一次拷贝，实测比直接上传慢（见README），默认不用
+        enabled_ = false;
+        std::cout << "纹理上传: 软件渲染 (" << renderer << ")，默认同步上传，可按U键切换到PBO" << std::endl;
+        return true;
+    }
+    std::cout << "纹理上传: 每个纹理使用" << buffer_count_ << "个PBO轮流上传 ("
+              << (renderer ? renderer : "") << ")" << std::endl;
+    return true;
+}
+
+void TextureUploader::upload(sf::Texture& texture, const uint8_t* pixels, unsigned int width, unsigned int height) {
+    const auto begin = std::chrono::steady_clock::now();
+    if (pboEnabled() && uploadPbo(texture, pixels, width, height)) {
+        stats_.pbo_uploads++;
+    } else {
+        texture.update(pixels, width, height, 0, 0);
+        stats_.direct_uploads++;
+    }
+    const double elapsed_ms =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    stats_.last_upload_ms = elapsed_ms;
+    stats_.average_upload_ms = (stats_.pbo_uploads + stats_.direct_uploads == 1) ? elapsed_ms :
+        stats_.average_upload_ms + UPLOAD_AVERAGE_WEIGHT * (elapsed_ms - stats_.average_upload_ms);
+}
+
+void TextureUploader::flush() {
+    // 纹理在离屏画布的上下文中绘制，提交本轮的传输命令使其可见；每次呈现至多一次
+    if (flush_pending_) {
+        glFlush();
+        flush_pending_ = false;
+    }
+}
+
+bool TextureUploader::uploadPbo(sf::Texture& texture, const uint8_t* pixels, unsigned int width, unsigned int height) {
+    const std::ptrdiff_t size = static_cast<std::ptrdiff_t>(width) * height * 4;
+    PboRing& ring = rings_[texture.getNativeHandle()];
+    if (ring.buffers.empty()) {
+        ring.buffers.assign(buffer_count_, 0);
+        ring.sizes.assign(buffer_count_, 0);
+        gen_buffers_(static_cast<GLsizei>(ring.buffers.size()), ring.buffers.data());
+    }
+    const unsigned int index = ring.next;
+    ring.next = (ring.next + 1) % buffer_count_;
+
+    // 轮到的缓冲上次用于N-1帧之前，传输早已完成，直接映射；只在尺寸变化时重新分配
+    bind_buffer_(GL_PIXEL_UNPACK_BUFFER, ring.buffers[index]);
+    if (ring.sizes[index] != size) {
+        buffer_data_(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+        ring.sizes[index] = size;
+    }
+    void* mapped = map_buffer_(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
+    if (!mapped) {
+        bind_buffer_(GL_PIXEL_UNPACK_BUFFER, 0);
+        return false;
+    }
+    memcpy(mapped, pixels, static_cast<size_t>(size));
+    if (!unmap_buffer_(GL_PIXEL_UNPACK_BUFFER)) {
+        // 映射期间内容丢失（如显示模式切换），本帧改走同步上传
+        bind_buffer_(GL_PIXEL_UNPACK_BUFFER, 0);
+        return false;
+    }
+
+    // 数据指针为PBO内的偏移，调用立即返回；与sf::Texture::update一样保存并恢复纹理绑定
+    GLint previous_texture = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &previous_texture);
+    glBindTexture(GL_TEXTURE_2D, texture.getNativeHandle());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, static_cast<GLsizei>(width), static_cast<GLsizei>(height),
+                    GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(previous_texture));
+
+    // SFML的其他上传（字体字形等）假定没有绑定PBO
+    bind_buffer_(GL_PIXEL_UNPACK_BUFFER, 0);
+    flush_pending_ = true;
+    return true;
+}
@@ -0,0 +1,90 @@
+/*
+file: src/gui/texture_uploader.h
+date: 2026/10/16
+*/
+#ifndef TEXTURE_UPLOADER_H
+#define TEXTURE_UPLOADER_H
+
+#include <SFML/Graphics/Texture.hpp>
+#include <SFML/OpenGL.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+
+// 纹理上传统计
+struct TextureUploadStats {
+    uint64_t pbo_uploads = 0;       // 经PBO上传的帧数
+    uint64_t direct_uploads = 0;    // 经sf::Texture::update上传的帧数
+    double last_upload_ms = 0.0;    // 最近一帧上传调用的耗时（UI线程上的阻塞时间）
+    double average_upload_ms = 0.0; // 上传耗时的滑动平均
+};
+
+// 视频帧纹理上传
+// 每个纹理轮流使用2~3个像素缓冲对象（PBO）：像素拷入映射的PBO后由glTexSubImage2D从PBO发起传输，
+// 调用立即返回，传输与后续绘制重叠，也不增加一帧的显示延迟。
+// 缓冲只在尺寸变化时分配（不做orphaning）：轮到的缓冲是该纹理N-1帧之前上传用的，其传输已经完成，
+// 映射不必等待。拷入映射缓冲的memcpy仍在UI线程中进行，与sf::Texture::update的拷贝量相同。
+// 只依赖OpenGL 1.5的缓冲对象和2.1/ARB_pixel_buffer_object；不支持时退回sf::Texture::update。
+// Mesa软件渲染（llvmpipe）上可用但更慢，默认不启用。只能在UI线程（OpenGL上下文所在线程）中使用。
+class TextureUploader {
+public:
+    explicit TextureUploader(unsigned int buffer_count = 2);
+    ~TextureUploader();
+
+    TextureUploader(const TextureUploader&) = delete;
+    TextureUploader& operator=(const TextureUploader&) = delete;
+
+    // 检测并加载PBO所需的函数（需要当前线程有活动的OpenGL上下文），不支持时返回false
+    bool init();
+
+    // 上传一帧紧密排列的RGBA像素到纹理（纹理尺寸须与帧一致）
+    void upload(sf::Texture& texture, const uint8_t* pixels, unsigned int width, unsigned int height);
+
+    // 各路上传完后调用一次：提交经PBO发起的传输，使其他上下文（离屏画布）中可见
+    void flush();
+
+    // 是否支持PBO，以及是否启用（关闭后与原有路径相同，便于对比；软件渲染时默认关闭）
+    bool pboSupported() const { return supported_; }
+    bool pboEnabled() const { return supported_ && enabled_; }
+    void setPboEnabled(bool enabled) { enabled_ = enabled; }
+
+    const TextureUploadStats& stats() const { return stats_; }
+
+private:
+    bool uploadPbo(sf::Texture& texture, const uint8_t* pixels, unsigned int width, unsigned int height);
+
+    using GenBuffersFn = void (APIENTRY*)(GLsizei, GLuint*);
+    using DeleteBuffersFn = void (APIENTRY*)(GLsizei, const GLuint*);
+    using BindBufferFn = void (APIENTRY*)(GLenum, GLuint);
+    using BufferDataFn = void (APIENTRY*)(GLenum, std::ptrdiff_t, const void*, GLenum);
+    using MapBufferFn = void* (APIENTRY*)(GLenum, GLenum);
+    using UnmapBufferFn = GLboolean (APIENTRY*)(GLenum);
+
+    GenBuffersFn gen_buffers_ = nullptr;
+    DeleteBuffersFn delete_buffers_ = nullptr;
+    BindBufferFn bind_buffer_ = nullptr;
+    BufferDataFn buffer_data_ = nullptr;
+    MapBufferFn map_buffer_ = nullptr;
+    UnmapBufferFn unmap_buffer_ = nullptr;
+
+    // 一个纹理的PBO环
+    struct PboRing {
+        std::vector<GLuint> buffers;
+        std::vector<std::ptrdiff_t> sizes;  // 各缓冲已分配的大小
+        unsigned int next = 0;
+    };
+
+    const unsigned int buffer_count_;
+    std::unordered_map<GLuint, PboRing> rings_;  // 按纹理句柄（各路纹理重建尺寸时句柄不变）
+    bool flush_pending_ = false;
+    bool supported_ = false;
+    bool enabled_ = true;
+    TextureUploadStats stats_;
+};
+
+#endif // TEXTURE_UPLOADER_H
@@ -8,18 +8,42 @@ data: 2025/05/05
 #include <SFML/Graphics.hpp>
 #include <iostream>
 #include <string>
+#include <algorithm>
 
-void ServerListCache::update(const std::vector<Json::Value>& new_servers) {
+// 同一服务器（ip+heartbeat_port）在列表中的位置
+static std::vector<ServerEntry>::iterator findServer(std::vector<ServerEntry>& servers, const ServerEntry& entry) {
+    return std::find_if(servers.begin(), servers.end(), [&](const ServerEntry& s) {
+        return s.heartbeat_port == entry.heartbeat_port && s.ip == entry.ip;
+    });
+}
+
+void ServerListCache::apply(const ServerRegistryDelta& delta) {
     std::lock_guard<std::mutex> lock(mtx);
-    servers = new_servers;
+    if (delta.generation <= generation) return;  // 已过期
+    for (const auto& entry : delta.removed) {
+        auto it = findServer(servers, entry);
+        if (it != servers.end()) servers.erase(it);
+    }
+    for (const auto& entry : delta.updated) {
+        auto it = findServer(servers, entry);
+        if (it != servers.end()) *it = entry;
+    }
+    // 新条目的发现顺序总是晚于已有条目，追加即保持顺序
+    servers.insert(servers.end(), delta.added.begin(), delta.added.end());
+    generation = delta.generation;
     last_update = time(nullptr);
 }
 
-std::vector<Json::Value> ServerListCache::get() {
+std::vector<ServerEntry> ServerListCache::get() {
     std::lock_guard<std::mutex> lock(mtx);
     return servers;
 }
 
+size_t ServerListCache::size() {
+    std::lock_guard<std::mutex> lock(mtx);
+    return servers.size();
+}
+
 ServerListWidget::ServerListWidget(NetworkManager& net_mgr, ServerListCache& cache)
     : net_manager_(net_mgr), server_cache_(cache), displayed_servers_() {
     std::string title_name = "可用服务器";
@@ -58,11 +82,21 @@ void ServerListWidget::setPosition(float x, float y) {
     refresh_text_.setPosition(refresh_btn_.getPosition().x + 10, y - 45);
 }
 
-void ServerListWidget::updateList(const std::vector<Json::Value>& servers) {
+void ServerListWidget::updateList(const std::vector<ServerEntry>& servers) {
+    // 列表持续更新：选中的服务器仍在列表中时保持选中
+    int selected = -1;
+    if (selected_index_ >= 0 && selected_index_ < static_cast<int>(displayed_servers_.size())) {
+        const ServerEntry& current = displayed_servers_[selected_index_];
+        for (size_t i = 0; i < servers.size(); ++i) {
+            if (servers[i].ip == current.ip && servers[i].heartbeat_port == current.heartbeat_port) {
+                selected = static_cast<int>(i);
+                break;
+            }
+        }
+    }
     // 更新显示的服务器列表
     displayed_servers_ = servers; 
-    // 重置选中状态
-    selected_index_ = -1; 
+    selected_index_ = selected;
     // 触发重新布局（下次绘制时自动处理）
 }
 
@@ -81,15 +115,15 @@ void ServerListWidget::handleEvent(const sf::Event& event) {
     }
 }
 
-void ServerListWidget::draw(sf::RenderWindow& window) const {
-    window.draw(panel_);
-    window.draw(title_);
-    window.draw(refresh_btn_);
-    window.draw(refresh_text_);
-    drawItems(window);
+void ServerListWidget::draw(sf::RenderTarget& target) const {
+    target.draw(panel_);
+    target.draw(title_);
+    target.draw(refresh_btn_);
+    target.draw(refresh_text_);
+    drawItems(target);
 }
 
-void ServerListWidget::drawItems(sf::RenderWindow& window) const {
+void ServerListWidget::drawItems(sf::RenderTarget& target) const {
     const auto& servers = displayed_servers_; 
     float y = position_.y + 20;
     
@@ -103,18 +137,18 @@ void ServerListWidget::drawItems(sf::RenderWindow& window) const {
         // 服务器信息
         sf::Text name;
         name.setFont(*font_);
-        name.setString(servers[i]["name"].asString());
+        name.setString(servers[i].displayName());
         name.setPosition(position_.x + 20, y + 10);
         
         sf::Text ip;
         ip.setFont(*font_);
-        ip.setString(servers[i]["ip"].asString());
+        ip.setString(servers[i].ip + ":" + std::to_string(servers[i].heartbeat_port));
         ip.setCharacterSize(14);
         ip.setPosition(position_.x + 20, y + 35);
         
-        window.draw(bg);
-        window.draw(name);
-        window.draw(ip);
+        target.draw(bg);
+        target.draw(name);
+        target.draw(ip);
         
         y += 70;
     }
@@ -144,9 +178,7 @@ void ServerListWidget::checkItemClick(const sf::Vector2f& pos) {
 }
 
 void ServerListWidget::onRefreshClick() {
-    net_manager_.startDiscovery(); // 触发网络发现
-    server_cache_.update({}); // 清空缓存
-    selected_index_ = -1;
+    net_manager_.refreshServerList(); // 立即探测，列表保留（失效的服务器按TTL移除）
     
     if (status_callback_) {
         status_callback_("正在搜索服务器...");
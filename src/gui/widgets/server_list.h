@@ -13,18 +13,21 @@ data: 2025/05/05
 #include <string>
 #include "core/network/network_manager.h"
 
+// 界面侧的服务器列表（按注册表的增量更新，保持首次发现的顺序）
 struct ServerListCache {
     std::mutex mtx;
-    std::vector<Json::Value> servers;
+    std::vector<ServerEntry> servers;
+    uint64_t generation = 0;        // 已应用的最新代数
     time_t last_update = 0;
     
-    void update(const std::vector<Json::Value>& new_servers);
-    std::vector<Json::Value> get();
+    void apply(const ServerRegistryDelta& delta);
+    std::vector<ServerEntry> get();
+    size_t size();
 };
 
 class ServerListWidget {
 public:
-    using SelectCallback = std::function<void(const Json::Value& server)>;
+    using SelectCallback = std::function<void(const ServerEntry& server)>;
     using StatusCallback = std::function<void(const std::string& message)>;
 
     ServerListWidget(NetworkManager& net_mgr, ServerListCache& cache);
@@ -33,20 +36,20 @@ public:
     bool init(sf::Font& font);
     void setPosition(float x, float y);
     
-    void updateList(const std::vector<Json::Value>& servers);
+    void updateList(const std::vector<ServerEntry>& servers);
 
     // 事件处理
     void handleEvent(const sf::Event& event);
     
     // 绘制方法
-    void draw(sf::RenderWindow& window) const;
+    void draw(sf::RenderTarget& target) const;
     
     // 回调设置
     void setSelectCallback(SelectCallback cb) { select_callback_ = cb; }
     void setStatusCallback(StatusCallback cb) { status_callback_ = cb; }
 
 private:
-    void drawItems(sf::RenderWindow& window) const;
+    void drawItems(sf::RenderTarget& target) const;
     void checkItemClick(const sf::Vector2f& pos);
     void onRefreshClick();
 
@@ -55,7 +58,7 @@ private:
     ServerListCache& server_cache_;
     const sf::Font* font_ = nullptr;
     
-    std::vector<Json::Value> displayed_servers_;
+    std::vector<ServerEntry> displayed_servers_;
     
     // UI元素
     sf::RectangleShape panel_;
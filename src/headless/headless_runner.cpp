@@ -0,0 +1,282 @@
+/*
+file: src/headless/headless_runner.cpp
+date: 2026/10/16
+*/
+#include "headless/headless_runner.h"
+#include <sys/resource.h>
+#include <json/json.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include "core/video/gst_video_receiver.h"
+#include "core/video/latency_tracker.h"
+#include "utils/alloc_counter.h"
+#include "utils/frame_queue.h"
+#include "utils/latency_histogram.h"
+
+using namespace std::chrono_literals;
+
+// 输入结束后等待管道排空（EOS到达appsink）的上限
+static constexpr auto DRAIN_TIMEOUT = 10s;
+
+// 消费线程在队列为空时的等待间隔（UI线程按刷新率取帧，这里取得更勤，计入的排队延迟更接近管道本身）
+static constexpr auto CONSUMER_IDLE_WAIT = 500us;
+
+// 与界面的帧队列容量相同
+static constexpr size_t FRAME_QUEUE_CAPACITY = 8;
+
+static void printUsage() {
+    std::cerr <<
+        "用法: video-client-headless --input <文件> [选项]\n"
+        "  --format rtpdump|h264   输入格式（默认按扩展名：.h264/.264为裸流，.rtpdump/.rtp为rtpdump）\n"
+        "  --speed max|realtime    回放速度（默认max）\n"
+        "  --fps <帧率>            H.264裸流的帧率（默认30）\n"
+        "  --codec <格式>          rtpdump中的编码格式（默认H264）\n"
+        "  --pt <负载类型>         RTP负载类型0~127（默认取自文件）\n"
+        "  --decoder <元素>        解码器（默认使用软件解码器）\n"
+        "  --decode-threading auto|slice|frame  libav解码线程模型（默认auto）\n"
+        "  --decode-threads <数量> libav解码线程数（默认0，自动）\n"
+        "  --pipelined on|off      depay/解码/转换是否分线程（默认on）\n"
+        "  --output <文件>         JSON结果写入文件（默认输出到标准输出）" << std::endl;
+}
+
+bool parseHeadlessOptions(int argc, char** argv, HeadlessOptions* options) {
+    bool format_set = false;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--headless") continue;  // 兼容原先由界面程序转入回放时的写法
+        if (i + 1 >= argc) {
+            printUsage();
+            return false;
+        }
+        const std::string value = argv[++i];
+        bool valid = true;
+        if (arg == "--input") {
+            options->input = value;
+        } else if (arg == "--format") {
+            valid = value == "rtpdump" || value == "h264";
+            options->format = value == "h264" ? ReplayFormat::H264 : ReplayFormat::RtpDump;
+            format_set = true;
+        } else if (arg == "--speed") {
+            valid = value == "max" || value == "realtime";
+            options->speed = value == "realtime" ? ReplaySpeed::Realtime : ReplaySpeed::Max;
+        } else if (arg == "--fps") {
+            options->fps = std::atof(value.c_str());
+            valid = options->fps > 0;
+        } else if (arg == "--codec") {
+            valid = codecFromName(value, &options->codec);
+        } else if (arg == "--pt") {
+            options->payload_type = std::atoi(value.c_str());
+            valid = options->payload_type >= 0 && options->payload_type <= 127;  // RTP头中只有7位
+        } else if (arg == "--decoder") {
+            options->decoder = value;
+        } else if (arg == "--decode-threading") {
+            valid = value == "auto" || value == "slice" || value == "frame";
+            options->decode_threading = value == "slice" ? DecodeThreading::Slice :
+                                        value == "frame" ? DecodeThreading::Frame : DecodeThreading::Auto;
+        } else if (arg == "--decode-threads") {
+            options->decode_threads = std::atoi(value.c_str());
+            valid = options->decode_threads >= 0;
+        } else if (arg == "--pipelined") {
+            valid = value == "on" || value == "off";
+            options->pipelined = value == "on";
+        } else if (arg == "--output") {
+            options->output = value;
+        } else {
+            valid = false;
+        }
+        if (!valid) {
+            std::cerr << "无效参数: " << arg << " " << value << std::endl;
+            printUsage();
+            return false;
+        }
+    }
+    if (options->input.empty() ||
+        (!format_set && !replayFormatFromPath(options->input, &options->format))) {
+        printUsage();
+        return false;
+    }
+    if (options->format == ReplayFormat::H264) {
+        options->codec = VideoCodec::H264;
+    }
+    return true;
+}
+
+static double cpuSeconds(const timeval& tv) {
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static Json::Value histogramToJson(const LatencyHistogram& histogram) {
+    Json::Value value;
+    value["count"] = Json::UInt64(histogram.count());
+    value["p50_ms"] = histogram.percentile(0.50) / 1000.0;
+    value["p90_ms"] = histogram.percentile(0.90) / 1000.0;
+    value["p99_ms"] = histogram.percentile(0.99) / 1000.0;
+    value["max_ms"] = histogram.max() / 1000.0;
+    return value;
+}
+
+int runHeadless(const HeadlessOptions& options) {
+    gst_init(nullptr, nullptr);
+
+    ReplaySource source;
+    const int default_pt = options.payload_type >= 0 ? options.payload_type : 96;
+    if (!source.open(options.input, options.format, options.fps, default_pt)) {
+        return EXIT_FAILURE;
+    }
+
+    // 与界面相同的接收管道，只把网络输入换成外部推入；没有服务器，不发送RTCP反馈
+    VideoPipelineConfig config;
+    config.ingest = IngestMode::External;
+    config.codec = options.codec;
+    config.payload_type = options.payload_type >= 0 ? options.payload_type :
+                          (source.payloadType() >= 0 ? source.payloadType() : default_pt);
+    config.decoder = options.decoder;
+    config.pipelined = options.pipelined;
+    config.decode_threading = options.decode_threading;
+    config.decode_threads = options.decode_threads;
+    config.retransmission = false;
+    config.request_keyframes = false;
+    config.present_mode = PresentMode::Mailbox;  // 与界面默认相同；appsink不按时钟同步，--speed max不被限速
+    config.latency_profile = LatencyProfile::Fixed;
+
+    FrameQueue<VideoFrame> frames(FRAME_QUEUE_CAPACITY);
+    std::atomic<uint64_t> delivered{0};
+    std::atomic<uint64_t> queue_drops{0};
+    std::atomic<uint64_t> errors{0};
+    std::atomic<bool> eos{false};
+
+    GstVideoReceiver receiver;
+    receiver.setFrameCallback([&](VideoFrame&& frame) {
+        delivered.fetch_add(1, std::memory_order_relaxed);
+        if (!frames.tryPush(std::move(frame))) {
+            queue_drops.fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+    receiver.setErrorCallback([&](const std::string& message, int type) {
+        if (type == GST_VIDEO_ERROR_EOS) {
+            eos.store(true);
+            return;
+        }
+        errors.fetch_add(1, std::memory_order_relaxed);
+        std::cerr << "回放: " << message << std::endl;
+    });
+    if (!receiver.initialize(0, config)) {
+        return EXIT_FAILURE;
+    }
+
+    // 消费线程代替UI线程：取帧、记录排队延迟和到达至取出的逐帧延迟
+    LatencyHistogram frame_latency;
+    std::atomic<uint64_t> consumed{0};
+    std::atomic<int64_t> last_frame_ns{0};
+    std::atomic<bool> consuming{true};
+    std::thread consumer([&]() {
+        while (consuming.load(std::memory_order_relaxed) || !frames.empty()) {
+            VideoFrame* frame = frames.front();
+            if (!frame) {
+                std::this_thread::sleep_for(CONSUMER_IDLE_WAIT);
+                continue;
+            }
+            const int64_t now = steadyNowNs();
+            latencyStats().record(LatencyStage::Queue, frame->timing().ready_ns, now);
+            if (frame->timing().arrival_ns > 0 && now > frame->timing().arrival_ns) {
+                frame_latency.record(static_cast<uint64_t>((now - frame->timing().arrival_ns) / 1000));
+            }
+            frames.popFront();
+            consumed.fetch_add(1, std::memory_order_relaxed);
+            last_frame_ns.store(now, std::memory_order_relaxed);
+        }
+    });
+
+    latencyStats().reset();
+    receiver.start();
+    rusage usage_begin;
+    getrusage(RUSAGE_SELF, &usage_begin);
+    const uint64_t allocations_begin = allocationCount();
+    const int64_t begin_ns = steadyNowNs();
+
+    std::atomic<bool> cancel{false};
+    const uint64_t packets = source.run(options.speed, [&](GstBufferList* list) {
+        return receiver.pushPackets(list);
+    }, cancel);
+    receiver.endOfStream();
+
+    const auto drain_deadline = std::chrono::steady_clock::now() + DRAIN_TIMEOUT;
+    while (!eos.load() && std::chrono::steady_clock::now() < drain_deadline) {
+        std::this_thread::sleep_for(10ms);
+    }
+    consuming.store(false);
+    consumer.join();
+
+    const int64_t end_ns = last_frame_ns.load() > 0 ? last_frame_ns.load() : steadyNowNs();
+    const uint64_t allocations = allocationCount() - allocations_begin;
+    rusage usage_end;
+    getrusage(RUSAGE_SELF, &usage_end);
+    const double wall = (end_ns - begin_ns) / 1e9;
+    const double user = cpuSeconds(usage_end.ru_utime) - cpuSeconds(usage_begin.ru_utime);
+    const double system = cpuSeconds(usage_end.ru_stime) - cpuSeconds(usage_begin.ru_stime);
+
+    // 接收指标每秒更新一次，等最后一次更新后再读取
+    std::this_thread::sleep_for(1100ms);
+    const ReceiverMetrics metrics = receiver.getMetrics();
+    const TexturePoolStats pool = receiver.getTexturePoolStats();
+    receiver.stop();
+
+    Json::Value result;
+    result["input"] = options.input;
+    result["format"] = options.format == ReplayFormat::H264 ? "h264" : "rtpdump";
+    result["speed"] = options.speed == ReplaySpeed::Max ? "max" : "realtime";
+    result["codec"] = codecName(config.codec);
+    result["decoder"] = config.decoder.empty() ? codecInfo(config.codec).default_decoder : config.decoder;
+    result["pipelined"] = config.pipelined;
+    result["decode_threading"] = config.decode_threading == DecodeThreading::Slice ? "slice" :
+                                 config.decode_threading == DecodeThreading::Frame ? "frame" : "auto";
+    result["decode_threads"] = config.decode_threads;
+    result["completed"] = eos.load();
+    result["packets"] = Json::UInt64(packets);
+    result["frames"] = Json::UInt64(consumed.load());
+    result["frames_delivered"] = Json::UInt64(delivered.load());
+    result["frames_decoded"] = Json::UInt64(metrics.frames_decoded);
+    result["frames_dropped"] = Json::UInt64(metrics.frames_dropped + queue_drops.load());
+    result["packets_lost"] = Json::UInt64(metrics.packets_lost);
+    result["errors"] = Json::UInt64(errors.load());
+    result["wall_seconds"] = wall;
+    result["fps"] = wall > 0 ? consumed.load() / wall : 0.0;
+    result["latency"] = histogramToJson(frame_latency);
+
+    Json::Value stages;
+    for (LatencyStage stage : {LatencyStage::JitterBuffer, LatencyStage::Depay, LatencyStage::Decode,
+                               LatencyStage::Convert, LatencyStage::Queue}) {
+        stages[latencyStageName(stage)] = histogramToJson(latencyStats().histogram(stage));
+    }
+    result["stages"] = stages;
+
+    Json::Value cpu;
+    cpu["user_seconds"] = user;
+    cpu["system_seconds"] = system;
+    cpu["percent"] = wall > 0 ? (user + system) / wall * 100.0 : 0.0;
+    result["cpu"] = cpu;
+
+    Json::Value alloc;
+    alloc["cpp_allocations"] = Json::UInt64(allocations);
+    alloc["cpp_allocations_per_frame"] = consumed.load() > 0 ?
+        static_cast<double>(allocations) / consumed.load() : 0.0;
+    alloc["frame_pool_hits"] = Json::UInt64(pool.hits);
+    alloc["frame_pool_misses"] = Json::UInt64(pool.misses);
+    result["allocations"] = alloc;
+
+    const std::string json = Json::StyledWriter().write(result);
+    if (options.output.empty()) {
+        std::cout << json;
+    } else {
+        std::ofstream file(options.output);
+        if (!(file << json)) {
+            std::cerr << "无法写入结果文件: " << options.output << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    return consumed.load() > 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
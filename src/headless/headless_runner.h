@@ -0,0 +1,37 @@
+/*
+file: src/headless/headless_runner.h
+date: 2026/10/16
+*/
+#ifndef HEADLESS_RUNNER_H
+#define HEADLESS_RUNNER_H
+
+#include <string>
+#include "core/replay/replay_source.h"
+#include "core/video/pipeline_config.h"
+#include "core/video/video_codec.h"
+
+// 无界面回放参数（命令行：video-client-headless --input 文件 [...]）
+struct HeadlessOptions {
+    std::string input;
+    ReplayFormat format = ReplayFormat::RtpDump;  // 未指定时按扩展名推断
+    ReplaySpeed speed = ReplaySpeed::Max;
+    double fps = 30.0;             // H.264裸流的帧率
+    VideoCodec codec = VideoCodec::H264;
+    int payload_type = -1;         // 0~127；-1：rtpdump取文件中的负载类型，裸流使用96
+    std::string decoder;           // 为空时使用该编码格式的软件解码器
+    bool pipelined = true;         // false时depay/解码/转换串行（对比各解码流水线模式）
+    DecodeThreading decode_threading = DecodeThreading::Auto;
+    int decode_threads = 0;
+    std::string output;            // JSON结果文件，为空时输出到标准输出
+};
+
+// 解析命令行，参数错误时打印用法并返回false
+bool parseHeadlessOptions(int argc, char** argv, HeadlessOptions* options);
+
+// 无界面回放
+// 把录制的RTP流经与界面相同的接收管道（GstVideoReceiver）和帧队列（FrameQueue），
+// 由消费线程代替UI线程取帧；结束后以JSON报告帧率、逐帧延迟分位数、CPU时间和分配次数。
+// 返回进程退出码：没有解出任何帧时为1，便于CI据此判定。
+int runHeadless(const HeadlessOptions& options);
+
+#endif // HEADLESS_RUNNER_H
@@ -0,0 +1,15 @@
+/*
+file: src/headless/main.cpp
+date: 2026/10/16
+*/
+#include "headless/headless_runner.h"
+#include <cstdlib>
+
+// 无界面回放程序：不创建窗口，结果以JSON输出
+int main(int argc, char** argv) {
+    HeadlessOptions options;
+    if (!parseHeadlessOptions(argc, argv, &options)) {
+        return EXIT_FAILURE;
+    }
+    return runHeadless(options);
+}
@@ -15,4 +15,4 @@ int main() {
     client_ui.update();
 
     return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
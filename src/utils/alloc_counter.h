@@ -0,0 +1,15 @@
+/*
+file: src/utils/alloc_counter.h
+date: 2026/10/16
+*/
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+#include <cstdint>
+
+// 进程内全局operator new的累计调用次数（替换了默认的operator new/delete，含对齐与nothrow版本，仅计数，relaxed原子加）
+// 只统计C++分配；GStreamer/GLib经g_malloc的分配不在其中。
+// 只编入无界面回放和基准测试程序，界面程序使用标准库的分配函数
+uint64_t allocationCount();
+
+#endif // ALLOC_COUNTER_H
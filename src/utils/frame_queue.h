@@ -0,0 +1,104 @@
+/*
+file: src/utils/frame_queue.h
+date: 2026/10/16
+*/
+#ifndef FRAME_QUEUE_H
+#define FRAME_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+// 有界单生产者/单消费者无锁环形队列
+// 生产者：视频线程（tryPush）；消费者：UI线程（front/popFront/tryPop）。
+// 槽位在构造时一次性分配，运行期间不再申请内存；
+// 读写索引各自独占缓存行，避免两个线程之间的伪共享。
+template <typename T>
+class FrameQueue {
+public:
+    // 容量向上取整为2的幂
+    explicit FrameQueue(size_t capacity = 8)
+        : capacity_(roundUpPow2(capacity)), mask_(capacity_ - 1),
+          slots_(new T[capacity_]) {}
+
+    FrameQueue(const FrameQueue&) = delete;
+    FrameQueue& operator=(const FrameQueue&) = delete;
+
+    // 生产者：队列满时返回false，item保持不变
+    bool tryPush(T&& item) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cached_head_ == capacity_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ == capacity_) return false;
+        }
+        slots_[tail & mask_] = std::move(item);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 消费者：查看队首元素，队列为空时返回nullptr
+    // 返回的元素在popFront()之前一直有效，生产者不会覆盖它
+    T* front() {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cached_tail_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head == cached_tail_) return nullptr;
+        }
+        return &slots_[head & mask_];
+    }
+
+    // 消费者：丢弃队首元素（须先由front()确认非空）
+    // 槽位重置为默认值，及时释放元素持有的资源
+    void popFront() {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        slots_[head & mask_] = T();
+        head_.store(head + 1, std::memory_order_release);
+    }
+
+    // 消费者：取出队首元素
+    bool tryPop(T& out) {
+        T* item = front();
+        if (!item) return false;
+        out = std::move(*item);
+        popFront();
+        return true;
+    }
+
+    // 近似长度（任一线程可调用，仅用于统计显示）
+    // 先读head再读tail：tail只增不减，读到的tail不会落后于head；
+    // 两次读取之间生产者/消费者都可能前进，结果再按容量截断
+    size_t size() const {
+        const size_t head = head_.load(std::memory_order_acquire);
+        const size_t tail = tail_.load(std::memory_order_acquire);
+        const size_t count = tail - head;
+        return count > capacity_ ? capacity_ : count;
+    }
+
+    bool empty() const { return size() == 0; }
+    size_t capacity() const { return capacity_; }
+
+private:
+    static constexpr size_t CACHE_LINE = 64;
+
+    static size_t roundUpPow2(size_t n) {
+        size_t v = 1;
+        while (v < n) v <<= 1;
+        return v;
+    }
+
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<T[]> slots_;
+
+    // 消费者独占
+    alignas(CACHE_LINE) std::atomic<size_t> head_{0};
+    size_t cached_tail_ = 0;
+
+    // 生产者独占
+    alignas(CACHE_LINE) std::atomic<size_t> tail_{0};
+    size_t cached_head_ = 0;
+    // 成员按缓存行对齐，sizeof也随之补齐，不会与相邻对象共享缓存行
+};
+
+#endif // FRAME_QUEUE_H
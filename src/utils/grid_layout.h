@@ -0,0 +1,29 @@
+/*
+file: src/utils/grid_layout.h
+date: 2026/10/16
+*/
+#ifndef GRID_LAYOUT_H
+#define GRID_LAYOUT_H
+
+#include <cmath>
+
+// 多路画面的网格布局：列数取ceil(sqrt(n))，行数按需补齐
+// 1路1x1，2路2x1，3~4路2x2，5~6路3x2，7~9路3x3，10~12路4x3，13~16路4x4
+struct GridLayout {
+    int cols = 1;
+    int rows = 1;
+
+    // 第index路所在单元格
+    int column(int index) const { return index % cols; }
+    int row(int index) const { return index / cols; }
+};
+
+inline GridLayout gridLayoutFor(int count) {
+    GridLayout layout;
+    if (count <= 1) return layout;
+    layout.cols = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count))));
+    layout.rows = (count + layout.cols - 1) / layout.cols;
+    return layout;
+}
+
+#endif // GRID_LAYOUT_H
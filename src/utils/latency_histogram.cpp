@@ -0,0 +1,70 @@
+/*
+file: src/utils/latency_histogram.cpp
+date: 2026/10/16
+*/
+#include "utils/latency_histogram.h"
+
+int LatencyHistogram::bucketIndex(uint64_t value) {
+    const uint64_t limit = (uint64_t(1) << (MAX_MSB + 1)) - 1;
+    if (value > limit) value = limit;
+    if (value < SUB_COUNT) return static_cast<int>(value);
+
+    const int msb = 63 - __builtin_clzll(value);
+    const int shift = msb - SUB_BITS;
+    return (shift + 1) * SUB_COUNT + static_cast<int>((value >> shift) - SUB_COUNT);
+}
+
+uint64_t LatencyHistogram::bucketLow(int index) {
+    if (index < SUB_COUNT) return index;
+    const int shift = index / SUB_COUNT - 1;
+    return static_cast<uint64_t>(index % SUB_COUNT + SUB_COUNT) << shift;
+}
+
+uint64_t LatencyHistogram::bucketHigh(int index) {
+    if (index < SUB_COUNT) return index;
+    const int shift = index / SUB_COUNT - 1;
+    return bucketLow(index) + (uint64_t(1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t value_us) {
+    buckets_[bucketIndex(value_us)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t current = max_.load(std::memory_order_relaxed);
+    while (value_us > current &&
+           !max_.compare_exchange_weak(current, value_us, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    count_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::percentile(double p) const {
+    // 以桶内计数之和为准，避免与count_之间的并发偏差
+    uint64_t total = 0;
+    for (const auto& bucket : buckets_) {
+        total += bucket.load(std::memory_order_relaxed);
+    }
+    if (total == 0) return 0;
+
+    if (p >= 1.0) return max();
+    if (p < 0.0) p = 0.0;
+    uint64_t rank = static_cast<uint64_t>(p * total + 0.5);
+    if (rank < 1) rank = 1;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        seen += buckets_[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            const uint64_t mid = (bucketLow(i) + bucketHigh(i)) / 2;
+            const uint64_t max_value = max();
+            return max_value && mid > max_value ? max_value : mid;
+        }
+    }
+    return max();
+}
@@ -0,0 +1,46 @@
+/*
+file: src/utils/latency_histogram.h
+date: 2026/10/16
+*/
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <atomic>
+#include <cstdint>
+
+// 无锁延迟直方图（HDR风格的对数-线性分桶，单位微秒）
+// 每个2的幂区间再均分为32格，任意值的相对误差不超过1/32；上限约35分钟。
+// record()可由任意线程并发调用（仅relaxed原子加），不分配内存；
+// 读取为近似快照，与并发写入之间不保证一致。
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BITS = 5;
+    static constexpr int SUB_COUNT = 1 << SUB_BITS;
+    static constexpr int MAX_MSB = 31;
+    static constexpr int BUCKET_COUNT = (MAX_MSB - SUB_BITS + 2) * SUB_COUNT;
+
+    LatencyHistogram() { reset(); }
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void record(uint64_t value_us);
+    void reset();
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+
+    // p取[0, 1]，返回所在桶的中点；没有样本时返回0
+    uint64_t percentile(double p) const;
+
+private:
+    static int bucketIndex(uint64_t value);
+    static uint64_t bucketLow(int index);
+    static uint64_t bucketHigh(int index);
+
+    std::atomic<uint64_t> buckets_[BUCKET_COUNT];
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+#endif // LATENCY_HISTOGRAM_H
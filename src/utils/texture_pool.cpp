@@ -0,0 +1,205 @@
+/*
+file: src/utils/texture_pool.cpp
+date: 2026/10/16
+*/
+#include "utils/texture_pool.h"
+#include <atomic>
+#include <iostream>
+#include <new>
+#include <unistd.h>
+
+// 常驻buffer数量：appsink队列 + UI帧队列 + 正在上传的一帧
+static constexpr guint POOL_MIN_BUFFERS = 4;
+
+// ---------------------------------------------------------------------------
+// FrameBufferPool：在GstVideoBufferPool基础上统计命中/未命中
+// ---------------------------------------------------------------------------
+struct FrameBufferPool {
+    GstVideoBufferPool parent;
+    std::shared_ptr<TexturePoolCounters> counters;  // 计入所属TexturePool，池可能比TexturePool活得久
+};
+
+struct FrameBufferPoolClass {
+    GstVideoBufferPoolClass parent_class;
+};
+
+G_DEFINE_TYPE(FrameBufferPool, frame_buffer_pool, GST_TYPE_VIDEO_BUFFER_POOL)
+
+#define FRAME_BUFFER_POOL(obj) (reinterpret_cast<FrameBufferPool*>(obj))
+
+// 默认acquire_buffer在空闲列表为空时于同一线程内调用alloc_buffer，
+// 用线程局部标记记录本次acquire是否触发了分配，多线程同时acquire互不干扰
+static thread_local bool t_allocated_in_acquire = false;
+
+static GstFlowReturn frame_buffer_pool_alloc_buffer(GstBufferPool* pool, GstBuffer** buffer,
+                                                    GstBufferPoolAcquireParams* params) {
+    t_allocated_in_acquire = true;
+    return GST_BUFFER_POOL_CLASS(frame_buffer_pool_parent_class)->alloc_buffer(pool, buffer, params);
+}
+
+static GstFlowReturn frame_buffer_pool_acquire_buffer(GstBufferPool* pool, GstBuffer** buffer,
+                                                      GstBufferPoolAcquireParams* params) {
+    FrameBufferPool* self = FRAME_BUFFER_POOL(pool);
+    t_allocated_in_acquire = false;
+    GstFlowReturn ret = GST_BUFFER_POOL_CLASS(frame_buffer_pool_parent_class)->acquire_buffer(pool, buffer, params);
+    if (ret == GST_FLOW_OK && self->counters) {
+        if (t_allocated_in_acquire) {
+            self->counters->misses.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            self->counters->hits.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    return ret;
+}
+
+static void frame_buffer_pool_finalize(GObject* object) {
+    FrameBufferPool* self = FRAME_BUFFER_POOL(object);
+    self->counters.~shared_ptr();
+    G_OBJECT_CLASS(frame_buffer_pool_parent_class)->finalize(object);
+}
+
+static void frame_buffer_pool_class_init(FrameBufferPoolClass* klass) {
+    GstBufferPoolClass* pool_class = GST_BUFFER_POOL_CLASS(klass);
+    pool_class->alloc_buffer = frame_buffer_pool_alloc_buffer;
+    pool_class->acquire_buffer = frame_buffer_pool_acquire_buffer;
+    G_OBJECT_CLASS(klass)->finalize = frame_buffer_pool_finalize;
+}
+
+static void frame_buffer_pool_init(FrameBufferPool* self) {
+    new (&self->counters) std::shared_ptr<TexturePoolCounters>();
+}
+
+// ---------------------------------------------------------------------------
+// TexturePool
+// ---------------------------------------------------------------------------
+TexturePool::~TexturePool() {
+    clear();
+}
+
+void TexturePool::attach(GstElement* appsink) {
+    GstPad* pad = gst_element_get_static_pad(appsink, "sink");
+    if (!pad) return;
+    gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_QUERY_DOWNSTREAM,
+                      &TexturePool::onAllocationQuery, this, nullptr);
+    gst_object_unref(pad);
+}
+
+// 应答上游的allocation查询，让videoconvert输出到池内存
+GstPadProbeReturn TexturePool::onAllocationQuery(GstPad* pad, GstPadProbeInfo* info, gpointer user_data) {
+    GstQuery* query = GST_PAD_PROBE_INFO_QUERY(info);
+    if (GST_QUERY_TYPE(query) != GST_QUERY_ALLOCATION) {
+        return GST_PAD_PROBE_OK;
+    }
+
+    GstCaps* caps = nullptr;
+    gboolean need_pool = FALSE;
+    gst_query_parse_allocation(query, &caps, &need_pool);
+
+    GstVideoInfo vinfo;
+    gst_video_info_init(&vinfo);
+    if (!caps || !gst_video_info_from_caps(&vinfo, caps)) {
+        return GST_PAD_PROBE_OK;
+    }
+
+    auto* self = static_cast<TexturePool*>(user_data);
+    GstBufferPool* pool = self->offerPool(vinfo);
+    if (!pool) return GST_PAD_PROBE_OK;
+
+    gst_query_add_allocation_pool(query, pool, GST_VIDEO_INFO_SIZE(&vinfo), POOL_MIN_BUFFERS, 0);
+    gst_query_add_allocation_meta(query, GST_VIDEO_META_API_TYPE, nullptr);
+    gst_object_unref(pool);
+
+    // 查询已应答，不再交给appsink（其默认实现不提供缓冲池）
+    return GST_PAD_PROBE_HANDLED;
+}
+
+GstBufferPool* TexturePool::getPool(const GstVideoInfo& info) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    GstBufferPool* pool = findOrCreate(info);
+    return pool ? GST_BUFFER_POOL(gst_object_ref(pool)) : nullptr;
+}
+
+// 重新协商时上游可能仍在使用旧池：已激活的池无法再被重新配置，
+// 因此换一个新池应答，旧池由上游在切换后自行停用并释放，期间的计数仍记入counters_
+GstBufferPool* TexturePool::offerPool(const GstVideoInfo& info) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const PoolKey key{GST_VIDEO_INFO_WIDTH(&info), GST_VIDEO_INFO_HEIGHT(&info),
+                      GST_VIDEO_INFO_FORMAT(&info)};
+    auto it = pools_.find(key);
+    if (it != pools_.end() && gst_buffer_pool_is_active(it->second)) {
+        gst_object_unref(it->second);
+        pools_.erase(it);
+    }
+    GstBufferPool* pool = findOrCreate(info);
+    return pool ? GST_BUFFER_POOL(gst_object_ref(pool)) : nullptr;
+}
+
+GstBuffer* TexturePool::acquire(const GstVideoInfo& info) {
+    GstBufferPool* pool = getPool(info);
+    if (!pool) return nullptr;
+
+    if (!gst_buffer_pool_is_active(pool) && !gst_buffer_pool_set_active(pool, TRUE)) {
+        std::cerr << "缓冲池激活失败" << std::endl;
+        gst_object_unref(pool);
+        return nullptr;
+    }
+
+    GstBuffer* buffer = nullptr;
+    if (gst_buffer_pool_acquire_buffer(pool, &buffer, nullptr) != GST_FLOW_OK) {
+        buffer = nullptr;
+    }
+    gst_object_unref(pool);
+    return buffer;
+}
+
+// 调用时须持有mutex_
+GstBufferPool* TexturePool::findOrCreate(const GstVideoInfo& info) {
+    const PoolKey key{GST_VIDEO_INFO_WIDTH(&info), GST_VIDEO_INFO_HEIGHT(&info),
+                      GST_VIDEO_INFO_FORMAT(&info)};
+    auto it = pools_.find(key);
+    if (it != pools_.end()) return it->second;
+
+    GstBufferPool* pool = GST_BUFFER_POOL(g_object_new(frame_buffer_pool_get_type(), nullptr));
+    gst_object_ref_sink(pool);
+    FRAME_BUFFER_POOL(pool)->counters = counters_;
+
+    GstCaps* caps = gst_video_info_to_caps(&info);
+    GstStructure* config = gst_buffer_pool_get_config(pool);
+    gst_buffer_pool_config_set_params(config, caps, GST_VIDEO_INFO_SIZE(&info), POOL_MIN_BUFFERS, 0);
+    gst_buffer_pool_config_add_option(config, GST_BUFFER_POOL_OPTION_VIDEO_META);
+
+    // 页对齐，便于驱动直接DMA上传
+    GstAllocationParams params;
+    gst_allocation_params_init(&params);
+    params.align = static_cast<gsize>(sysconf(_SC_PAGESIZE)) - 1;
+    gst_buffer_pool_config_set_allocator(config, nullptr, &params);
+    gst_caps_unref(caps);
+
+    if (!gst_buffer_pool_set_config(pool, config)) {
+        std::cerr << "缓冲池配置失败: " << GST_VIDEO_INFO_WIDTH(&info) << "x"
+                  << GST_VIDEO_INFO_HEIGHT(&info) << std::endl;
+        gst_object_unref(pool);
+        return nullptr;
+    }
+
+    pools_.emplace(key, pool);
+    return pool;
+}
+
+void TexturePool::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& entry : pools_) {
+        gst_buffer_pool_set_active(entry.second, FALSE);
+        gst_object_unref(entry.second);
+    }
+    pools_.clear();
+}
+
+TexturePoolStats TexturePool::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    TexturePoolStats result;
+    result.hits = counters_->hits.load(std::memory_order_relaxed);
+    result.misses = counters_->misses.load(std::memory_order_relaxed);
+    result.pools = pools_.size();
+    return result;
+}
@@ -0,0 +1,69 @@
+/*
+file: src/utils/texture_pool.h
+date: 2026/10/16
+*/
+#ifndef TEXTURE_POOL_H
+#define TEXTURE_POOL_H
+
+#include <cstdint>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <gst/gst.h>
+#include <gst/video/video.h>
+
+// 缓冲池统计
+struct TexturePoolStats {
+    uint64_t hits = 0;      // 从空闲列表直接取得buffer
+    uint64_t misses = 0;    // 需要新分配内存
+    size_t pools = 0;       // 当前按分辨率/格式建立的池数量
+};
+
+// 命中计数，由TexturePool与其创建的各个池共享：
+// 被替换的池在上游切换前仍会被acquire，池释放前的计数也不会丢失
+struct TexturePoolCounters {
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+};
+
+// 帧缓冲池
+// 按（宽、高、像素格式）维护页对齐的GstBufferPool。通过appsink的
+// allocation查询提供给上游，videoconvert直接写入UI随后上传纹理的内存；
+// 帧释放后buffer回到池中，稳定状态下每帧不再产生堆分配。
+class TexturePool {
+public:
+    TexturePool() = default;
+    ~TexturePool();
+
+    TexturePool(const TexturePool&) = delete;
+    TexturePool& operator=(const TexturePool&) = delete;
+
+    // 在appsink的sink pad上应答allocation查询，提供对应格式的缓冲池
+    void attach(GstElement* appsink);
+
+    // 获取对应格式的缓冲池（返回新引用，调用方负责unref）
+    GstBufferPool* getPool(const GstVideoInfo& info);
+
+    // 直接从池中取一个buffer（供客户端自行写入），失败返回nullptr
+    GstBuffer* acquire(const GstVideoInfo& info);
+
+    // 释放所有池（已借出的buffer归还后由GStreamer回收）
+    void clear();
+
+    TexturePoolStats stats() const;
+
+private:
+    using PoolKey = std::tuple<int, int, GstVideoFormat>;
+
+    static GstPadProbeReturn onAllocationQuery(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+    GstBufferPool* offerPool(const GstVideoInfo& info);
+    GstBufferPool* findOrCreate(const GstVideoInfo& info);
+
+    mutable std::mutex mutex_;
+    std::map<PoolKey, GstBufferPool*> pools_;
+    std::shared_ptr<TexturePoolCounters> counters_ = std::make_shared<TexturePoolCounters>();
+};
+
+#endif // TEXTURE_POOL_H
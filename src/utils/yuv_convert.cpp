@@ -0,0 +1,302 @@
+/*
+file: src/utils/yuv_convert.cpp
+date: 2026/10/16
+*/
+#include "utils/yuv_convert.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define YUV_CONVERT_X86 1
+#endif
+
+// BT.601有限范围定点系数（8位小数）
+//   R = (298*(Y-16)             + 409*(V-128) + 128) >> 8
+//   G = (298*(Y-16) - 100*(U-128) - 208*(V-128) + 128) >> 8
+//   B = (298*(Y-16) + 516*(U-128)               + 128) >> 8
+static constexpr int COEF_Y = 298;
+static constexpr int COEF_RV = 409;
+static constexpr int COEF_GU = 100;
+static constexpr int COEF_GV = 208;
+static constexpr int COEF_BU = 516;
+
+static const uint8_t OPAQUE_BLACK[4] = {0, 0, 0, 255};
+
+// 目标区域内等比缩放后的有效矩形（居中）
+struct FitRect {
+    int x, y, w, h;
+};
+
+static FitRect computeFit(int src_w, int src_h, int dst_w, int dst_h) {
+    FitRect fit{0, 0, dst_w, dst_h};
+    if (static_cast<int64_t>(dst_w) * src_h <= static_cast<int64_t>(dst_h) * src_w) {
+        fit.h = std::max(1, static_cast<int>(static_cast<int64_t>(src_h) * dst_w / src_w));
+    } else {
+        fit.w = std::max(1, static_cast<int>(static_cast<int64_t>(src_w) * dst_h / src_h));
+    }
+    fit.x = (dst_w - fit.w) / 2;
+    fit.y = (dst_h - fit.h) / 2;
+    return fit;
+}
+
+// 最近邻采样：输出第i个像素中心映射到源坐标
+static inline int mapCoord(int i, int src_len, int dst_len) {
+    const int v = static_cast<int>((static_cast<int64_t>(2 * i + 1) * src_len) / (2 * dst_len));
+    return std::min(v, src_len - 1);
+}
+
+static inline uint8_t clampByte(int v) {
+    return static_cast<uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+static inline void yuvToRgbaPixel(int y, int u, int v, uint8_t* out) {
+    const int c = COEF_Y * (y - 16);
+    const int d = u - 128;
+    const int e = v - 128;
+    out[0] = clampByte((c + COEF_RV * e + 128) >> 8);
+    out[1] = clampByte((c - COEF_GU * d - COEF_GV * e + 128) >> 8);
+    out[2] = clampByte((c + COEF_BU * d + 128) >> 8);
+    out[3] = 255;
+}
+
+static inline void chromaAt(const YuvImage& src, int cx, int cy, int& u, int& v) {
+    if (src.layout == YuvLayout::NV12) {
+        const uint8_t* uv = src.planes[1] + cy * src.strides[1] + cx * 2;
+        u = uv[0];
+        v = uv[1];
+    } else {
+        u = src.planes[1][cy * src.strides[1] + cx];
+        v = src.planes[2][cy * src.strides[2] + cx];
+    }
+}
+
+static bool validImages(const YuvImage& src, const RgbaImage& dst) {
+    return src.width > 0 && src.height > 0 && src.planes[0] && src.planes[1] &&
+           (src.layout == YuvLayout::NV12 || src.planes[2]) &&
+           dst.data && dst.width > 0 && dst.height > 0 && dst.stride >= dst.width * 4;
+}
+
+// 填充有效区域以外的黑边
+static void fillBorders(RgbaImage& dst, const FitRect& fit) {
+    for (int row = 0; row < dst.height; ++row) {
+        uint8_t* line = dst.data + static_cast<size_t>(row) * dst.stride;
+        const bool inside = row >= fit.y && row < fit.y + fit.h;
+        const int left = inside ? fit.x : dst.width;
+        for (int x = 0; x < left; ++x) {
+            std::memcpy(line + x * 4, OPAQUE_BLACK, 4);
+        }
+        if (inside) {
+            for (int x = fit.x + fit.w; x < dst.width; ++x) {
+                std::memcpy(line + x * 4, OPAQUE_BLACK, 4);
+            }
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// 行转换内核：输入为已按输出列展开的Y/U/V，输出n个RGBA像素
+// ---------------------------------------------------------------------------
+using RowKernel = void (*)(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* out, int n);
+
+static void convertRowScalar(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* out, int n) {
+    for (int i = 0; i < n; ++i) {
+        yuvToRgbaPixel(y[i], u[i], v[i], out + i * 4);
+    }
+}
+
+#ifdef YUV_CONVERT_X86
+__attribute__((target("sse4.1")))
+static void convertRowSse41(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* out, int n) {
+    const __m128i k16 = _mm_set1_epi32(16);
+    const __m128i k128 = _mm_set1_epi32(128);
+    const __m128i ky = _mm_set1_epi32(COEF_Y);
+    const __m128i krv = _mm_set1_epi32(COEF_RV);
+    const __m128i kgu = _mm_set1_epi32(COEF_GU);
+    const __m128i kgv = _mm_set1_epi32(COEF_GV);
+    const __m128i kbu = _mm_set1_epi32(COEF_BU);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i k255 = _mm_set1_epi32(255);
+    const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        int32_t y4, u4, v4;
+        std::memcpy(&y4, y + i, 4);
+        std::memcpy(&u4, u + i, 4);
+        std::memcpy(&v4, v + i, 4);
+        const __m128i c = _mm_mullo_epi32(_mm_sub_epi32(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(y4)), k16), ky);
+        const __m128i d = _mm_sub_epi32(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(u4)), k128);
+        const __m128i e = _mm_sub_epi32(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(v4)), k128);
+        const __m128i base = _mm_add_epi32(c, k128);
+
+        __m128i r = _mm_srai_epi32(_mm_add_epi32(base, _mm_mullo_epi32(e, krv)), 8);
+        __m128i g = _mm_srai_epi32(_mm_sub_epi32(_mm_sub_epi32(base, _mm_mullo_epi32(d, kgu)),
+                                                 _mm_mullo_epi32(e, kgv)), 8);
+        __m128i b = _mm_srai_epi32(_mm_add_epi32(base, _mm_mullo_epi32(d, kbu)), 8);
+        r = _mm_min_epi32(_mm_max_epi32(r, zero), k255);
+        g = _mm_min_epi32(_mm_max_epi32(g, zero), k255);
+        b = _mm_min_epi32(_mm_max_epi32(b, zero), k255);
+
+        // 小端序下每个32位通道即一个RGBA像素
+        const __m128i px = _mm_or_si128(_mm_or_si128(r, _mm_slli_epi32(g, 8)),
+                                        _mm_or_si128(_mm_slli_epi32(b, 16), alpha));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 4), px);
+    }
+    convertRowScalar(y + i, u + i, v + i, out + i * 4, n - i);
+}
+
+__attribute__((target("avx2")))
+static void convertRowAvx2(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* out, int n) {
+    const __m256i k16 = _mm256_set1_epi32(16);
+    const __m256i k128 = _mm256_set1_epi32(128);
+    const __m256i ky = _mm256_set1_epi32(COEF_Y);
+    const __m256i krv = _mm256_set1_epi32(COEF_RV);
+    const __m256i kgu = _mm256_set1_epi32(COEF_GU);
+    const __m256i kgv = _mm256_set1_epi32(COEF_GV);
+    const __m256i kbu = _mm256_set1_epi32(COEF_BU);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i k255 = _mm256_set1_epi32(255);
+    const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256i yv = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(y + i)));
+        const __m256i uv = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(u + i)));
+        const __m256i vv = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(v + i)));
+        const __m256i c = _mm256_mullo_epi32(_mm256_sub_epi32(yv, k16), ky);
+        const __m256i d = _mm256_sub_epi32(uv, k128);
+        const __m256i e = _mm256_sub_epi32(vv, k128);
+        const __m256i base = _mm256_add_epi32(c, k128);
+
+        __m256i r = _mm256_srai_epi32(_mm256_add_epi32(base, _mm256_mullo_epi32(e, krv)), 8);
+        __m256i g = _mm256_srai_epi32(_mm256_sub_epi32(_mm256_sub_epi32(base, _mm256_mullo_epi32(d, kgu)),
+                                                       _mm256_mullo_epi32(e, kgv)), 8);
+        __m256i b = _mm256_srai_epi32(_mm256_add_epi32(base, _mm256_mullo_epi32(d, kbu)), 8);
+        r = _mm256_min_epi32(_mm256_max_epi32(r, zero), k255);
+        g = _mm256_min_epi32(_mm256_max_epi32(g, zero), k255);
+        b = _mm256_min_epi32(_mm256_max_epi32(b, zero), k255);
+
+        const __m256i px = _mm256_or_si256(_mm256_or_si256(r, _mm256_slli_epi32(g, 8)),
+                                           _mm256_or_si256(_mm256_slli_epi32(b, 16), alpha));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i * 4), px);
+    }
+    convertRowScalar(y + i, u + i, v + i, out + i * 4, n - i);
+}
+#endif // YUV_CONVERT_X86
+
+static RowKernel selectKernel(SimdLevel level) {
+#ifdef YUV_CONVERT_X86
+    switch (level) {
+        case SimdLevel::Avx2:  return convertRowAvx2;
+        case SimdLevel::Sse41: return convertRowSse41;
+        default: break;
+    }
+#endif
+    (void)level;
+    return convertRowScalar;
+}
+
+SimdLevel detectSimdLevel() {
+#ifdef YUV_CONVERT_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return SimdLevel::Avx2;
+    if (__builtin_cpu_supports("sse4.1")) return SimdLevel::Sse41;
+#endif
+    return SimdLevel::Scalar;
+}
+
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::Avx2:  return "AVX2";
+        case SimdLevel::Sse41: return "SSE4.1";
+        default:               return "Scalar";
+    }
+}
+
+// ---------------------------------------------------------------------------
+// 参考实现
+// ---------------------------------------------------------------------------
+void convertYuvToRgbaReference(const YuvImage& src, RgbaImage& dst) {
+    if (!validImages(src, dst)) return;
+
+    const FitRect fit = computeFit(src.width, src.height, dst.width, dst.height);
+    fillBorders(dst, fit);
+
+    for (int oy = 0; oy < fit.h; ++oy) {
+        const int sy = mapCoord(oy, src.height, fit.h);
+        uint8_t* line = dst.data + static_cast<size_t>(fit.y + oy) * dst.stride + fit.x * 4;
+        for (int ox = 0; ox < fit.w; ++ox) {
+            const int sx = mapCoord(ox, src.width, fit.w);
+            int u, v;
+            chromaAt(src, sx / 2, sy / 2, u, v);
+            yuvToRgbaPixel(src.planes[0][sy * src.strides[0] + sx], u, v, line + ox * 4);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// YuvToRgbaConverter
+// ---------------------------------------------------------------------------
+YuvToRgbaConverter::YuvToRgbaConverter(SimdLevel level)
+    : level_(std::min(level, detectSimdLevel())) {}
+
+void YuvToRgbaConverter::prepare(int src_w, int src_h, int dst_w, int dst_h) {
+    if (src_w == src_w_ && src_h == src_h_ && dst_w == dst_w_ && dst_h == dst_h_) {
+        return;
+    }
+    src_w_ = src_w;
+    src_h_ = src_h;
+    dst_w_ = dst_w;
+    dst_h_ = dst_h;
+
+    const FitRect fit = computeFit(src_w, src_h, dst_w, dst_h);
+    fit_x_ = fit.x;
+    fit_y_ = fit.y;
+    fit_w_ = fit.w;
+    fit_h_ = fit.h;
+
+    x_map_.resize(fit_w_);
+    for (int i = 0; i < fit_w_; ++i) x_map_[i] = mapCoord(i, src_w, fit_w_);
+    y_map_.resize(fit_h_);
+    for (int i = 0; i < fit_h_; ++i) y_map_[i] = mapCoord(i, src_h, fit_h_);
+
+    y_row_.resize(fit_w_);
+    u_row_.resize(fit_w_);
+    v_row_.resize(fit_w_);
+}
+
+bool YuvToRgbaConverter::convert(const YuvImage& src, RgbaImage& dst) {
+    if (!validImages(src, dst)) return false;
+
+    prepare(src.width, src.height, dst.width, dst.height);
+    fillBorders(dst, FitRect{fit_x_, fit_y_, fit_w_, fit_h_});
+
+    const RowKernel kernel = selectKernel(level_);
+    const bool nv12 = src.layout == YuvLayout::NV12;
+
+    for (int oy = 0; oy < fit_h_; ++oy) {
+        const int sy = y_map_[oy];
+        const uint8_t* y_src = src.planes[0] + sy * src.strides[0];
+        const uint8_t* u_src = src.planes[1] + (sy / 2) * src.strides[1];
+        const uint8_t* v_src = nv12 ? nullptr : src.planes[2] + (sy / 2) * src.strides[2];
+
+        // 按输出列展开（L1缓存内完成），随后整行交给SIMD内核
+        for (int ox = 0; ox < fit_w_; ++ox) {
+            const int sx = x_map_[ox];
+            const int cx = sx / 2;
+            y_row_[ox] = y_src[sx];
+            if (nv12) {
+                u_row_[ox] = u_src[cx * 2];
+                v_row_[ox] = u_src[cx * 2 + 1];
+            } else {
+                u_row_[ox] = u_src[cx];
+                v_row_[ox] = v_src[cx];
+            }
+        }
+
+        uint8_t* line = dst.data + static_cast<size_t>(fit_y_ + oy) * dst.stride + fit_x_ * 4;
+        kernel(y_row_.data(), u_row_.data(), v_row_.data(), line, fit_w_);
+    }
+    return true;
+}
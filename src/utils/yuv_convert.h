@@ -0,0 +1,74 @@
+/*
+file: src/utils/yuv_convert.h
+date: 2026/10/16
+*/
+#ifndef YUV_CONVERT_H
+#define YUV_CONVERT_H
+
+#include <cstdint>
+#include <vector>
+
+// 解码器原生输出的4:2:0布局
+enum class YuvLayout {
+    I420,   // Y + U + V 三个平面
+    NV12    // Y + 交错UV 两个平面
+};
+
+// 指令集级别（运行时由CPUID选择）
+enum class SimdLevel {
+    Scalar,
+    Sse41,
+    Avx2
+};
+
+struct YuvImage {
+    YuvLayout layout = YuvLayout::I420;
+    int width = 0;
+    int height = 0;
+    const uint8_t* planes[3] = {nullptr, nullptr, nullptr};  // NV12只使用前两个
+    int strides[3] = {0, 0, 0};
+};
+
+struct RgbaImage {
+    uint8_t* data = nullptr;
+    int width = 0;
+    int height = 0;
+    int stride = 0;
+};
+
+// 当前CPU支持的最高级别
+SimdLevel detectSimdLevel();
+const char* simdLevelName(SimdLevel level);
+
+// 参考实现：逐像素计算，作为SIMD路径逐位比对的基准
+void convertYuvToRgbaReference(const YuvImage& src, RgbaImage& dst);
+
+// I420/NV12 -> RGBA 转换与缩放一次完成
+// 源图像按比例缩放（最近邻）到目标尺寸内居中，四周填充不透明黑边。
+// 缩放为标量最近邻采样（逐行展开到行缓存），只有色彩转换按指令集向量化；
+// 色彩转换为BT.601有限范围定点运算，各指令集路径结果逐位一致。
+// 缩放映射表和行缓存按尺寸缓存复用，稳定状态下不分配内存。
+class YuvToRgbaConverter {
+public:
+    explicit YuvToRgbaConverter(SimdLevel level = detectSimdLevel());
+
+    bool convert(const YuvImage& src, RgbaImage& dst);
+
+    SimdLevel level() const { return level_; }
+
+private:
+    void prepare(int src_w, int src_h, int dst_w, int dst_h);
+
+    SimdLevel level_;
+
+    // 缩放参数（随尺寸缓存）
+    int src_w_ = 0, src_h_ = 0, dst_w_ = 0, dst_h_ = 0;
+    int fit_x_ = 0, fit_y_ = 0, fit_w_ = 0, fit_h_ = 0;
+    std::vector<int> x_map_;      // 输出列 -> 源亮度列
+    std::vector<int> y_map_;      // 输出行 -> 源亮度行
+    std::vector<uint8_t> y_row_;  // 当前输出行按列展开后的Y/U/V
+    std::vector<uint8_t> u_row_;
+    std::vector<uint8_t> v_row_;
+};
+
+#endif // YUV_CONVERT_H
@@ -0,0 +1,297 @@
+/*
+file: tests/gst_video_receiver_test.cpp
+date: 2026/10/16
+*/
+#include <gtest/gtest.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "core/video/gst_video_receiver.h"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+// 工作线程每次等待最多50ms，停止和错误发现都应在此量级内完成；留出状态切换的余量
+constexpr auto SHUTDOWN_BOUND = 500ms;
+constexpr auto ERROR_DETECTION_BOUND = 500ms;
+
+// 不依赖网络的接收配置：udpsrc输入，不发送RTCP，不录制
+VideoPipelineConfig idleConfig() {
+    VideoPipelineConfig config;
+    config.ingest = IngestMode::UdpSrc;
+    config.retransmission = false;
+    config.request_keyframes = false;
+    config.record_branch = false;
+    return config;
+}
+
+// 绑定一个本地UDP端口（不设SO_REUSEADDR），返回fd，端口写入port
+int bindUdp(int* port) {
+    const int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(static_cast<uint16_t>(*port));
+    socklen_t len = sizeof(addr);
+    if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    *port = ntohs(addr.sin_port);
+    return fd;
+}
+
+// 取一对空闲端口（RTP端口和RTCP端口+1）
+int freePortPair() {
+    for (int attempt = 0; attempt < 16; ++attempt) {
+        int port = 0;
+        const int rtp_fd = bindUdp(&port);
+        if (rtp_fd < 0) continue;
+        int rtcp_port = port + 1;
+        const int rtcp_fd = port < 65535 ? bindUdp(&rtcp_port) : -1;
+        close(rtp_fd);
+        if (rtcp_fd >= 0) {
+            close(rtcp_fd);
+            return port;
+        }
+    }
+    return 0;
+}
+
+// 记录第一次错误回调的类型与时刻
+struct ErrorWaiter {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool fired = false;
+    int type = -1;
+
+    void install(GstVideoReceiver& receiver) {
+        receiver.setErrorCallback([this](const std::string&, int error_type) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!fired) {
+                fired = true;
+                type = error_type;
+            }
+            cv.notify_all();
+        });
+    }
+
+    bool waitFor(std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return cv.wait_for(lock, timeout, [this] { return fired; });
+    }
+};
+
+// 丢包恢复测试的发送端参数
+constexpr int MEDIA_PT = 96;
+constexpr int RTX_PT = 97;
+constexpr int FEC_PT = 122;
+constexpr int SENT_FRAMES = 90;           // 30fps下3秒
+constexpr int DROP_EVERY = 25;            // 每25个媒体包丢一个（重传和FEC包不丢）
+constexpr auto METRICS_SETTLE = 1500ms;   // 发送结束后等待在途包和下一次指标更新
+
+// 本地发送端：x264编码 -> RTP打包 -> [ULPFEC | RTX缓存] -> rtpbin -> 确定性丢包 -> 回环到接收端
+// NACK经发送端rtpbin交给rtprtxsend，重传包使用RTX负载类型，不受丢包影响
+struct LossySender {
+    GstElement* pipeline = nullptr;
+    std::atomic<int> media_packets{0};
+    std::atomic<int> dropped{0};
+
+    ~LossySender() {
+        if (pipeline) {
+            gst_element_set_state(pipeline, GST_STATE_NULL);
+            gst_object_unref(pipeline);
+        }
+    }
+
+    bool create(int client_port, int rtcp_port, bool fec) {
+        const std::string protection = fec ?
+            "rtpulpfecenc pt=" + std::to_string(FEC_PT) + " percentage=100 ! " :
+            "rtprtxsend payload-type-map=\"application/x-rtp-pt-map," + std::to_string(MEDIA_PT) +
+                "=(uint)" + std::to_string(RTX_PT) + "\" max-size-time=1000 ! ";
+        const std::string desc =
+            "rtpbin name=rtpbin rtp-profile=avpf "
+            "videotestsrc is-live=true pattern=ball num-buffers=" + std::to_string(SENT_FRAMES) +
+            " ! video/x-raw,width=640,height=360,framerate=30/1 ! "
+            "x264enc tune=zerolatency speed-preset=ultrafast key-int-max=300 bitrate=2000 ! "
+            "rtph264pay pt=" + std::to_string(MEDIA_PT) + " mtu=1200 config-interval=1 ! " + protection +
+            "rtpbin.send_rtp_sink_0 "
+            "rtpbin.send_rtp_src_0 ! udpsink name=rtp_out host=127.0.0.1 port=" + std::to_string(client_port) +
+            " sync=false async=false "
+            "rtpbin.send_rtcp_src_0 ! udpsink host=127.0.0.1 port=" + std::to_string(client_port + 1) +
+            " sync=false async=false "
+            "udpsrc port=" + std::to_string(rtcp_port) + " caps=application/x-rtcp ! rtpbin.recv_rtcp_sink_0";
+        GError* error = nullptr;
+        pipeline = gst_parse_launch(desc.c_str(), &error);
+        if (error) {
+            g_error_free(error);
+            if (pipeline) gst_object_unref(pipeline);
+            pipeline = nullptr;
+            return false;
+        }
+        GstElement* out = gst_bin_get_by_name(GST_BIN(pipeline), "rtp_out");
+        GstPad* pad = gst_element_get_static_pad(out, "sink");
+        gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, dropMediaPackets, this, nullptr);
+        gst_object_unref(pad);
+        gst_object_unref(out);
+        return true;
+    }
+
+    // 首个关键帧之后，按固定间隔丢弃媒体包
+    static GstPadProbeReturn dropMediaPackets(GstPad*, GstPadProbeInfo* info, gpointer user_data) {
+        auto* self = static_cast<LossySender*>(user_data);
+        guint8 header[2];
+        if (gst_buffer_extract(GST_PAD_PROBE_INFO_BUFFER(info), 0, header, sizeof(header)) != sizeof(header) ||
+            (header[1] & 0x7f) != MEDIA_PT) {
+            return GST_PAD_PROBE_OK;
+        }
+        const int index = self->media_packets.fetch_add(1) + 1;
+        if (index > DROP_EVERY && index % DROP_EVERY == 0) {
+            self->dropped.fetch_add(1);
+            return GST_PAD_PROBE_DROP;
+        }
+        return GST_PAD_PROBE_OK;
+    }
+};
+
+// 接收端开启重传或FEC时运行一次有损发送，返回发送结束后的接收指标
+bool runLossyStream(bool fec, ReceiverMetrics* metrics, int* dropped) {
+    const int port = freePortPair();
+    const int sender_rtcp_port = freePortPair();
+    if (port <= 0 || sender_rtcp_port <= 0) return false;
+
+    VideoPipelineConfig config = idleConfig();
+    config.codec = VideoCodec::H264;
+    config.latency_profile = LatencyProfile::Fixed;
+    config.jitter_latency_ms = 200;   // 留出一次回环往返的重传时间
+    config.payload_type = MEDIA_PT;
+    config.retransmission = !fec;
+    config.rtx_payload_type = RTX_PT;
+    config.fec_payload_type = fec ? FEC_PT : 0;
+    config.rtcp_host = "127.0.0.1";
+    config.rtcp_port = sender_rtcp_port;
+
+    GstVideoReceiver receiver;
+    receiver.setFrameCallback([](VideoFrame&&) {});
+    if (!receiver.initialize(port, config)) return false;
+    LossySender sender;
+    if (!sender.create(port, sender_rtcp_port, fec)) return false;
+
+    receiver.start();
+    gst_element_set_state(sender.pipeline, GST_STATE_PLAYING);
+    GstBus* bus = gst_element_get_bus(sender.pipeline);
+    GstMessage* message = gst_bus_timed_pop_filtered(bus, 10 * GST_SECOND,
+        static_cast<GstMessageType>(GST_MESSAGE_EOS | GST_MESSAGE_ERROR));
+    const bool finished = message && GST_MESSAGE_TYPE(message) == GST_MESSAGE_EOS;
+    if (message) gst_message_unref(message);
+    gst_object_unref(bus);
+
+    std::this_thread::sleep_for(METRICS_SETTLE);
+    *metrics = receiver.getMetrics();
+    *dropped = sender.dropped.load();
+    receiver.stop();
+    return finished;
+}
+
+} // namespace
+
+// 没有任何帧到达时stop()仍须在有界时间内返回（原先阻塞在pull_sample直到下一帧）
+TEST(GstVideoReceiver, StopsPromptlyWithoutFrames) {
+    const int port = freePortPair();
+    ASSERT_GT(port, 0);
+
+    GstVideoReceiver receiver;
+    if (!receiver.initialize(port, idleConfig())) {
+        GTEST_SKIP() << "接收管道无法创建（缺少GStreamer插件）";
+    }
+    receiver.start();
+    std::this_thread::sleep_for(300ms);
+
+    const auto begin = std::chrono::steady_clock::now();
+    receiver.stop();
+    EXPECT_LT(std::chrono::steady_clock::now() - begin, SHUTDOWN_BOUND);
+}
+
+// 重复启动/停止不会泄漏线程或卡住
+TEST(GstVideoReceiver, RestartsAfterStop) {
+    const int port = freePortPair();
+    ASSERT_GT(port, 0);
+
+    for (int round = 0; round < 3; ++round) {
+        GstVideoReceiver receiver;
+        if (!receiver.initialize(port, idleConfig())) {
+            GTEST_SKIP() << "接收管道无法创建（缺少GStreamer插件）";
+        }
+        receiver.start();
+        std::this_thread::sleep_for(100ms);
+        const auto begin = std::chrono::steady_clock::now();
+        receiver.stop();
+        EXPECT_LT(std::chrono::steady_clock::now() - begin, SHUTDOWN_BOUND) << "round " << round;
+    }
+}
+
+// 没有帧到达时管道错误也要及时报告：端口被独占时udpsrc启动失败
+TEST(GstVideoReceiver, ReportsErrorWithoutFrames) {
+    int port = 0;
+    const int blocker = bindUdp(&port);
+    ASSERT_GE(blocker, 0);
+
+    GstVideoReceiver receiver;
+    ErrorWaiter waiter;
+    waiter.install(receiver);
+    if (!receiver.initialize(port, idleConfig())) {
+        close(blocker);
+        GTEST_SKIP() << "接收管道无法创建（缺少GStreamer插件）";
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+    receiver.start();
+    const bool fired = waiter.waitFor(std::chrono::duration_cast<std::chrono::milliseconds>(ERROR_DETECTION_BOUND));
+    const auto elapsed = std::chrono::steady_clock::now() - begin;
+    EXPECT_TRUE(fired);
+    EXPECT_LT(elapsed, ERROR_DETECTION_BOUND);
+    EXPECT_EQ(waiter.type, GST_VIDEO_ERROR_DECODE);
+
+    const auto stop_begin = std::chrono::steady_clock::now();
+    receiver.stop();
+    EXPECT_LT(std::chrono::steady_clock::now() - stop_begin, SHUTDOWN_BOUND);
+    close(blocker);
+}
+
+// 发送端按固定间隔丢包，NACK重传须把每个丢失的包补回，所有帧都送达解码器
+TEST(GstVideoReceiver, RetransmissionRecoversDroppedPackets) {
+    ReceiverMetrics metrics;
+    int dropped = 0;
+    if (!runLossyStream(false, &metrics, &dropped)) {
+        GTEST_SKIP() << "无法运行本地发送端（需要x264enc、rtprtxsend和H.264解码器）";
+    }
+    ASSERT_GT(dropped, 0);
+    EXPECT_GE(metrics.rtx_requests, static_cast<uint64_t>(dropped));
+    EXPECT_GE(metrics.packets_retransmitted, static_cast<uint64_t>(dropped));
+    EXPECT_GE(metrics.packets_recovered, static_cast<uint64_t>(dropped));
+    EXPECT_EQ(metrics.packets_unrecovered, 0u);
+    EXPECT_EQ(metrics.frames_decoded, static_cast<uint64_t>(SENT_FRAMES));
+}
+
+// 同样的丢包由ULPFEC在接收端直接恢复（不重传）；FEC包需要rtpbin的负载类型映射才能进入解码器
+TEST(GstVideoReceiver, FecRecoversDroppedPackets) {
+    ReceiverMetrics metrics;
+    int dropped = 0;
+    if (!runLossyStream(true, &metrics, &dropped)) {
+        GTEST_SKIP() << "无法运行本地发送端（需要x264enc、rtpulpfecenc和H.264解码器）";
+    }
+    ASSERT_GT(dropped, 0);
+    EXPECT_EQ(metrics.packets_retransmitted, 0u);
+    EXPECT_GE(metrics.packets_recovered, static_cast<uint64_t>(dropped));
+    EXPECT_EQ(metrics.packets_unrecovered, 0u);
+    EXPECT_EQ(metrics.frames_decoded, static_cast<uint64_t>(SENT_FRAMES));
+}
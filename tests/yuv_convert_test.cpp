@@ -0,0 +1,164 @@
+/*
+file: tests/yuv_convert_test.cpp
+date: 2026/10/16
+*/
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "utils/yuv_convert.h"
+
+namespace {
+
+// 随机内容的4:2:0源帧，各平面行尾带填充字节以覆盖stride != width的情况
+struct SourceFrame {
+    std::vector<uint8_t> y, u, v;
+    YuvImage image;
+
+    SourceFrame(int width, int height, YuvLayout layout, int padding) {
+        const int cw = (width + 1) / 2;
+        const int ch = (height + 1) / 2;
+        const int y_stride = width + padding;
+        const int u_stride = (layout == YuvLayout::NV12 ? cw * 2 : cw) + padding;
+        const int v_stride = cw + padding;
+
+        std::mt19937 rng(static_cast<uint32_t>(width * 131 + height * 7 + padding));
+        y.resize(static_cast<size_t>(y_stride) * height);
+        u.resize(static_cast<size_t>(u_stride) * ch);
+        v.resize(static_cast<size_t>(v_stride) * ch);
+        for (auto& b : y) b = static_cast<uint8_t>(rng());
+        for (auto& b : u) b = static_cast<uint8_t>(rng());
+        for (auto& b : v) b = static_cast<uint8_t>(rng());
+
+        image.layout = layout;
+        image.width = width;
+        image.height = height;
+        image.planes[0] = y.data();
+        image.strides[0] = y_stride;
+        image.planes[1] = u.data();
+        image.strides[1] = u_stride;
+        image.planes[2] = layout == YuvLayout::NV12 ? nullptr : v.data();
+        image.strides[2] = layout == YuvLayout::NV12 ? 0 : v_stride;
+    }
+};
+
+// 目标缓冲区预先填充哨兵值，可检查行尾填充字节未被改写
+struct TargetFrame {
+    static constexpr uint8_t SENTINEL = 0xA5;
+
+    std::vector<uint8_t> pixels;
+    RgbaImage image;
+
+    TargetFrame(int width, int height, int padding)
+        : pixels(static_cast<size_t>(width * 4 + padding) * height, SENTINEL) {
+        image.data = pixels.data();
+        image.width = width;
+        image.height = height;
+        image.stride = width * 4 + padding;
+    }
+};
+
+// 参数：源宽、源高、目标宽、目标高、布局、指令集级别
+using ConvertParam = std::tuple<int, int, int, int, YuvLayout, SimdLevel>;
+
+class YuvConvertTest : public ::testing::TestWithParam<ConvertParam> {};
+
+TEST_P(YuvConvertTest, MatchesReferenceBitExact) {
+    int src_w, src_h, dst_w, dst_h;
+    YuvLayout layout;
+    SimdLevel level;
+    std::tie(src_w, src_h, dst_w, dst_h, layout, level) = GetParam();
+    if (level > detectSimdLevel()) {
+        GTEST_SKIP() << "CPU不支持" << simdLevelName(level);
+    }
+
+    for (int padding : {0, 3, 64}) {
+        SCOPED_TRACE("padding=" + std::to_string(padding));
+        SourceFrame src(src_w, src_h, layout, padding);
+        TargetFrame expected(dst_w, dst_h, padding * 4);
+        TargetFrame actual(dst_w, dst_h, padding * 4);
+
+        YuvToRgbaConverter converter(level);
+        ASSERT_EQ(converter.level(), level);
+
+        convertYuvToRgbaReference(src.image, expected.image);
+        ASSERT_TRUE(converter.convert(src.image, actual.image));
+        EXPECT_EQ(actual.pixels, expected.pixels);
+
+        // 缓存的映射表在第二次转换时复用，结果不变
+        ASSERT_TRUE(converter.convert(src.image, actual.image));
+        EXPECT_EQ(actual.pixels, expected.pixels);
+    }
+}
+
+std::vector<ConvertParam> convertParams() {
+    const int sizes[][4] = {
+        {1, 1, 1, 1},
+        {2, 2, 7, 5},
+        {3, 5, 3, 5},
+        {33, 17, 860, 580},
+        {641, 479, 320, 240},
+        {640, 480, 861, 579},
+        {1280, 720, 1280, 720},
+        {1920, 1080, 860, 580},
+        {1921, 1081, 97, 1003},
+    };
+    std::vector<ConvertParam> params;
+    for (const auto& s : sizes) {
+        for (YuvLayout layout : {YuvLayout::I420, YuvLayout::NV12}) {
+            for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::Sse41, SimdLevel::Avx2}) {
+                params.emplace_back(s[0], s[1], s[2], s[3], layout, level);
+            }
+        }
+    }
+    return params;
+}
+
+std::string paramName(const ::testing::TestParamInfo<ConvertParam>& info) {
+    const ConvertParam& p = info.param;
+    std::string name = std::to_string(std::get<0>(p)) + "x" + std::to_string(std::get<1>(p)) + "_to_" +
+                       std::to_string(std::get<2>(p)) + "x" + std::to_string(std::get<3>(p));
+    name += std::get<4>(p) == YuvLayout::NV12 ? "_NV12_" : "_I420_";
+    switch (std::get<5>(p)) {
+        case SimdLevel::Avx2:  return name + "Avx2";
+        case SimdLevel::Sse41: return name + "Sse41";
+        default:               return name + "Scalar";
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(AllPaths, YuvConvertTest, ::testing::ValuesIn(convertParams()), paramName);
+
+TEST(YuvConvert, LetterboxesWithOpaqueBlack) {
+    // 4:3源放进16:9目标：左右两侧为黑边
+    SourceFrame src(64, 48, YuvLayout::I420, 0);
+    TargetFrame dst(128, 48, 0);
+    YuvToRgbaConverter converter;
+    ASSERT_TRUE(converter.convert(src.image, dst.image));
+
+    for (int row = 0; row < dst.image.height; ++row) {
+        const uint8_t* left = dst.pixels.data() + static_cast<size_t>(row) * dst.image.stride;
+        const uint8_t* right = left + (dst.image.width - 1) * 4;
+        EXPECT_EQ(left[0], 0);
+        EXPECT_EQ(left[3], 255);
+        EXPECT_EQ(right[2], 0);
+        EXPECT_EQ(right[3], 255);
+    }
+}
+
+TEST(YuvConvert, RejectsInvalidImages) {
+    SourceFrame src(16, 16, YuvLayout::I420, 0);
+    TargetFrame dst(16, 16, 0);
+    YuvToRgbaConverter converter;
+
+    YuvImage no_chroma = src.image;
+    no_chroma.planes[2] = nullptr;
+    EXPECT_FALSE(converter.convert(no_chroma, dst.image));
+
+    RgbaImage short_stride = dst.image;
+    short_stride.stride = dst.image.width * 4 - 1;
+    EXPECT_FALSE(converter.convert(src.image, short_stride));
+}
+
+} // namespace
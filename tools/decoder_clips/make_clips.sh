@@ -0,0 +1,23 @@
+#!/bin/sh
+# 生成解码器探测用的测试码流（res/decoder_clips/），需要带libx264/libx265/libvpx的ffmpeg
+# 用法: tools/decoder_clips/make_clips.sh [ffmpeg路径]
+# Mandelbrot缩放画面，每帧都有运动和细节，720p摄像头码率下每个文件约0.5 MB；
+# 参数须与decoder_probe.cpp中的CLIP_*常量一致
+set -e
+
+FFMPEG=${1:-ffmpeg}
+OUT=$(dirname "$0")/../../res/decoder_clips
+FRAMES=60
+SRC="-f lavfi -i mandelbrot=size=1280x720:rate=30 -frames:v $FRAMES -pix_fmt yuv420p"
+
+mkdir -p "$OUT"
+"$FFMPEG" -y -v error $SRC -c:v libx264 -preset ultrafast -tune zerolatency -g $FRAMES -crf 37 \
+    -bsf:v h264_mp4toannexb -f h264 "$OUT/clip.h264"
+"$FFMPEG" -y -v error $SRC -c:v libx265 -preset ultrafast -tune zerolatency -crf 35 \
+    -x265-params keyint=$FRAMES:info=0:log-level=error -f hevc "$OUT/clip.h265"
+"$FFMPEG" -y -v error $SRC -c:v libvpx -deadline realtime -cpu-used 16 -g $FRAMES -crf 30 -b:v 2M \
+    -f ivf "$OUT/clip.vp8.ivf"
+"$FFMPEG" -y -v error $SRC -c:v libvpx-vp9 -deadline realtime -cpu-used 8 -g $FRAMES -crf 48 -b:v 0 \
+    -f ivf "$OUT/clip.vp9.ivf"
+# MJPEG每帧独立编码，只保存一帧，探测时重复推入
+"$FFMPEG" -y -v error $SRC -frames:v 1 -pix_fmt yuvj420p -c:v mjpeg -q:v 5 -f mjpeg "$OUT/clip.jpg"
@@ -0,0 +1,104 @@
+/*
+file: tools/mock_server/main.cpp
+date: 2026/10/16
+*/
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include "mock_server.h"
+
+// 客户端一次最多接收16路，摄像头列表也须放得下其1024字节的缓冲
+static constexpr int MAX_CAMERAS = 16;
+
+// 各服务器的RTCP端口段间隔
+static constexpr int RTCP_PORT_STRIDE = 100;
+
+static std::atomic<bool> g_running{true};
+
+static void onSignal(int) {
+    g_running = false;
+}
+
+static void printUsage() {
+    std::cerr <<
+        "用法: video-client-mock-server [选项]\n"
+        "  --servers <数量>          模拟的服务器数量（默认1）\n"
+        "  --cameras <数量>          每台服务器的摄像头数量（默认2，最多16）\n"
+        "  --width <宽> --height <高> 测试码流分辨率（默认1280x720）\n"
+        "  --fps <帧率>              测试码流帧率（默认30）\n"
+        "  --bitrate <kbps>          x264enc码率（默认2000）\n"
+        "  --port <端口>             第一台服务器的控制端口，其余依次加1（默认8000）\n"
+        "  --rtcp-port <端口>        第一台服务器的RTCP端口段起点，其余依次加100（默认9000）\n"
+        "  --discovery-host <地址>   发现消息目标（默认127.0.0.1，局域网用255.255.255.255）\n"
+        "  --probe-port <端口>       接收客户端发现探测的端口（默认37021）" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    MockServerConfig base;
+    int servers = 1;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            printUsage();
+            return EXIT_FAILURE;
+        }
+        const std::string value = argv[++i];
+        const int number = std::atoi(value.c_str());
+        bool valid = number > 0;
+        if (arg == "--servers") {
+            servers = number;
+        } else if (arg == "--cameras") {
+            base.camera_count = number;
+            valid = valid && number <= MAX_CAMERAS;
+        } else if (arg == "--width") {
+            base.width = number;
+        } else if (arg == "--height") {
+            base.height = number;
+        } else if (arg == "--fps") {
+            base.fps = number;
+        } else if (arg == "--bitrate") {
+            base.bitrate_kbps = number;
+        } else if (arg == "--port") {
+            base.heartbeat_port = number;
+        } else if (arg == "--rtcp-port") {
+            base.rtcp_base_port = number;
+        } else if (arg == "--probe-port") {
+            base.probe_port = number;
+        } else if (arg == "--discovery-host") {
+            base.discovery_host = value;
+            valid = true;
+        } else {
+            valid = false;
+        }
+        if (!valid) {
+            std::cerr << "无效参数: " << arg << " " << value << std::endl;
+            printUsage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    std::vector<std::unique_ptr<MockServer>> instances;
+    for (int i = 0; i < servers; ++i) {
+        MockServerConfig config = base;
+        config.name = "mock-server-" + std::to_string(i);
+        config.heartbeat_port = base.heartbeat_port + i;
+        config.rtcp_base_port = base.rtcp_base_port + i * RTCP_PORT_STRIDE;
+        auto server = std::make_unique<MockServer>(config);
+        if (!server->start()) {
+            return EXIT_FAILURE;
+        }
+        instances.push_back(std::move(server));
+    }
+
+    while (g_running) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+    for (auto& server : instances) {
+        server->stop();
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,328 @@
+/*
+file: tools/mock_server/mock_server.cpp
+date: 2026/10/16
+*/
+#include "mock_server.h"
+#include <gst/video/video.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
+#include <algorithm>
+#include <iostream>
+
+// 各线程等待事件的上限，决定stop()的响应延迟
+static constexpr int POLL_TIMEOUT_MS = 100;
+
+// 各摄像头使用不同的测试图案，便于在网格中区分
+static const char* const PATTERNS[] = {"ball", "smpte", "pinwheel", "spokes", "gradient", "colors",
+                                       "zone-plate", "circular"};
+
+TestStreamSender::~TestStreamSender() {
+    stop();
+}
+
+bool TestStreamSender::start(const std::string& host, const Json::Value& entry, const Json::Value& request,
+                             const MockServerConfig& config) {
+    stop();
+    const int camera = entry["camera_index"].asInt();
+    const int port = entry["video_port"].asInt();
+    const int client_rtcp_port = entry.get("rtcp_port", port + 1).asInt();
+    const int rtx_payload_type = entry.get("rtx_payload_type", 0).asInt();
+    const std::string codec = entry.get("codec", "H264").asString();
+    if (codec != "H264") {
+        std::cerr << config.name << ": 只支持H264，忽略请求的" << codec << std::endl;
+    }
+
+    // 按客户端请求的上限缩小分辨率和帧率（保持宽高比，尺寸取偶数）
+    double scale = 1.0;
+    const int max_width = request.get("max_width", 0).asInt();
+    const int max_height = request.get("max_height", 0).asInt();
+    if (max_width > 0 && max_height > 0) {
+        scale = std::min({1.0, static_cast<double>(max_width) / config.width,
+                          static_cast<double>(max_height) / config.height});
+    }
+    const int width = std::max(2, static_cast<int>(config.width * scale) & ~1);
+    const int height = std::max(2, static_cast<int>(config.height * scale) & ~1);
+    const int max_fps = request.get("max_fps", 0).asInt();
+    const int fps = max_fps > 0 ? std::min(config.fps, max_fps) : config.fps;
+    const char* pattern = PATTERNS[camera % (sizeof(PATTERNS) / sizeof(PATTERNS[0]))];
+
+    std::string desc =
+        "rtpbin name=rtpbin rtp-profile=avpf "
+        "videotestsrc is-live=true pattern=" + std::string(pattern) + " ! "
+        "video/x-raw,width=" + std::to_string(width) + ",height=" + std::to_string(height) +
+        ",framerate=" + std::to_string(fps) + "/1 ! "
+        "x264enc name=encoder tune=zerolatency speed-preset=ultrafast bitrate=" +
+        std::to_string(config.bitrate_kbps) + " key-int-max=" + std::to_string(fps * 2) + " ! "
+        "rtph264pay pt=96 mtu=1200 config-interval=1 ! ";
+    if (rtx_payload_type > 0) {
+        desc += "rtprtxsend payload-type-map=\"application/x-rtp-pt-map,96=(uint)" +
+                std::to_string(rtx_payload_type) + "\" max-size-time=1000 ! ";
+    }
+    desc += "rtpbin.send_rtp_sink_0 "
+            "rtpbin.send_rtp_src_0 ! udpsink host=" + host + " port=" + std::to_string(port) +
+            " sync=false async=false "
+            "rtpbin.send_rtcp_src_0 ! udpsink host=" + host + " port=" + std::to_string(client_rtcp_port) +
+            " sync=false async=false "
+            "udpsrc port=" + std::to_string(config.rtcp_base_port + camera) +
+            " caps=application/x-rtcp ! rtpbin.recv_rtcp_sink_0";
+
+    GError* error = nullptr;
+    pipeline_ = gst_parse_launch(desc.c_str(), &error);
+    if (error) {
+        std::cerr << config.name << ": 无法创建发送管道: " << error->message << std::endl;
+        g_error_free(error);
+        if (pipeline_) gst_object_unref(pipeline_);
+        pipeline_ = nullptr;
+        return false;
+    }
+    encoder_ = gst_bin_get_by_name(GST_BIN(pipeline_), "encoder");
+    if (gst_element_set_state(pipeline_, GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE) {
+        std::cerr << config.name << ": 无法启动发送管道（RTCP端口"
+                  << config.rtcp_base_port + camera << "是否被占用？）" << std::endl;
+        stop();
+        return false;
+    }
+    std::cout << config.name << ": 摄像头" << camera << " -> " << host << ":" << port << " "
+              << width << "x" << height << "@" << fps << " " << config.bitrate_kbps << "kbps"
+              << (rtx_payload_type > 0 ? " RTX" : "") << std::endl;
+    return true;
+}
+
+void TestStreamSender::stop() {
+    if (!pipeline_) return;
+    gst_element_set_state(pipeline_, GST_STATE_NULL);
+    if (encoder_) gst_object_unref(encoder_);
+    gst_object_unref(pipeline_);
+    encoder_ = nullptr;
+    pipeline_ = nullptr;
+}
+
+void TestStreamSender::forceKeyframe() {
+    if (!encoder_) return;
+    GstPad* pad = gst_element_get_static_pad(encoder_, "src");
+    gst_pad_send_event(pad, gst_video_event_new_upstream_force_key_unit(GST_CLOCK_TIME_NONE, TRUE, 0));
+    gst_object_unref(pad);
+}
+
+MockServer::MockServer(const MockServerConfig& config) : config_(config) {
+    gst_init(nullptr, nullptr);
+}
+
+MockServer::~MockServer() {
+    stop();
+}
+
+bool MockServer::start() {
+    if (running_) return true;
+    listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) return false;
+    const int reuse = 1;
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(config_.heartbeat_port);
+    addr.sin_addr.s_addr = INADDR_ANY;
+    if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(listen_fd_, 8) != 0) {
+        std::cerr << config_.name << ": 无法监听端口" << config_.heartbeat_port << std::endl;
+        close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+
+    running_ = true;
+    discovery_thread_ = std::thread(&MockServer::discoveryLoop, this);
+    accept_thread_ = std::thread(&MockServer::acceptLoop, this);
+    std::cout << config_.name << ": 控制端口" << config_.heartbeat_port << "，" << config_.camera_count
+              << "路摄像头，发现消息发往" << config_.discovery_host << ":" << config_.discovery_port << std::endl;
+    return true;
+}
+
+void MockServer::stop() {
+    if (!running_.exchange(false)) return;
+    if (discovery_thread_.joinable()) discovery_thread_.join();
+    if (accept_thread_.joinable()) accept_thread_.join();
+
+    std::vector<std::thread> threads;
+    {
+        std::lock_guard<std::mutex> lock(clients_mutex_);
+        for (int fd : client_fds_) {
+            shutdown(fd, SHUT_RDWR);
+        }
+        threads.swap(client_threads_);
+        finished_clients_.clear();
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    close(listen_fd_);
+    listen_fd_ = -1;
+}
+
+// 摄像头列表（客户端一次recv读取，须小于其1024字节的缓冲）
+std::string MockServer::cameraList() const {
+    Json::Value cameras(Json::arrayValue);
+    for (int i = 0; i < config_.camera_count; ++i) {
+        Json::Value camera;
+        camera["index"] = i;
+        camera["codecs"].append("H264");
+        camera["rtcp_port"] = config_.rtcp_base_port + i;
+        cameras.append(camera);
+    }
+    Json::Value list;
+    list["cameras"] = cameras;
+    return Json::FastWriter().write(list);
+}
+
+void MockServer::discoveryLoop() {
+    const int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock < 0) return;
+    const int broadcast = 1;
+    setsockopt(sock, SOL_SOCKET, SO_BROADCAST, &broadcast, sizeof(broadcast));
+
+    sockaddr_in target{};
+    target.sin_family = AF_INET;
+    target.sin_port = htons(config_.discovery_port);
+    inet_pton(AF_INET, config_.discovery_host.c_str(), &target.sin_addr);
+
+    Json::Value info;
+    info["name"] = config_.name;
+    info["heartbeat_port"] = config_.heartbeat_port;
+    info["cameras"] = config_.camera_count;
+    const std::string message = Json::FastWriter().write(info);
+
+    // 探测端口：同机的多台服务器都要收到广播探测，因此允许共用
+    const int probe_sock = socket(AF_INET, SOCK_DGRAM, 0);
+    const int reuse = 1;
+    setsockopt(probe_sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    sockaddr_in probe_addr{};
+    probe_addr.sin_family = AF_INET;
+    probe_addr.sin_port = htons(config_.probe_port);
+    probe_addr.sin_addr.s_addr = INADDR_ANY;
+    if (bind(probe_sock, reinterpret_cast<sockaddr*>(&probe_addr), sizeof(probe_addr)) != 0) {
+        std::cerr << config_.name << ": 无法绑定探测端口" << config_.probe_port << "，只定期广播" << std::endl;
+    }
+
+    auto next_send = std::chrono::steady_clock::now();
+    char buffer[512];
+    while (running_) {
+        if (std::chrono::steady_clock::now() >= next_send) {
+            sendto(sock, message.c_str(), message.size(), 0, reinterpret_cast<sockaddr*>(&target), sizeof(target));
+            next_send += config_.discovery_interval;
+        }
+
+        // 发现探测：立即把发现消息发回探测的来源地址和端口
+        pollfd pfd{probe_sock, POLLIN, 0};
+        if (poll(&pfd, 1, POLL_TIMEOUT_MS) <= 0) continue;
+        sockaddr_in from{};
+        socklen_t from_len = sizeof(from);
+        const ssize_t n = recvfrom(probe_sock, buffer, sizeof(buffer), 0, reinterpret_cast<sockaddr*>(&from), &from_len);
+        Json::Value probe;
+        if (n > 0 && Json::Reader().parse(buffer, buffer + n, probe) && probe["request"].asString() == "discover") {
+            sendto(sock, message.c_str(), message.size(), 0, reinterpret_cast<sockaddr*>(&from), from_len);
+        }
+    }
+    close(probe_sock);
+    close(sock);
+}
+
+// join已断开的客户端线程，长时间运行时线程对象不随重连次数累积
+void MockServer::reapClients() {
+    std::vector<std::thread> finished;
+    {
+        std::lock_guard<std::mutex> lock(clients_mutex_);
+        for (const std::thread::id id : finished_clients_) {
+            auto it = std::find_if(client_threads_.begin(), client_threads_.end(),
+                                   [id](const std::thread& thread) { return thread.get_id() == id; });
+            if (it == client_threads_.end()) continue;
+            finished.push_back(std::move(*it));
+            client_threads_.erase(it);
+        }
+        finished_clients_.clear();
+    }
+    for (auto& thread : finished) {
+        thread.join();
+    }
+}
+
+void MockServer::acceptLoop() {
+    while (running_) {
+        reapClients();
+        pollfd pfd{listen_fd_, POLLIN, 0};
+        if (poll(&pfd, 1, POLL_TIMEOUT_MS) <= 0) continue;
+
+        sockaddr_in peer{};
+        socklen_t peer_len = sizeof(peer);
+        const int fd = accept(listen_fd_, reinterpret_cast<sockaddr*>(&peer), &peer_len);
+        if (fd < 0) continue;
+        char ip[INET_ADDRSTRLEN] = {0};
+        inet_ntop(AF_INET, &peer.sin_addr, ip, sizeof(ip));
+
+        std::lock_guard<std::mutex> lock(clients_mutex_);
+        client_fds_.push_back(fd);
+        client_threads_.emplace_back(&MockServer::serveClient, this, fd, std::string(ip));
+    }
+}
+
+// 一个客户端连接：发送摄像头列表，定期发送心跳，处理按行分隔的JSON消息
+// （选择消息、关键帧请求；心跳回复中的接收指标不需要处理）
+void MockServer::serveClient(int fd, const std::string& ip) {
+    std::cout << config_.name << ": 客户端" << ip << "已连接" << std::endl;
+    std::map<int, std::unique_ptr<TestStreamSender>> senders;  // 按客户端视频端口
+
+    const std::string list = cameraList();
+    bool alive = send(fd, list.c_str(), list.size(), MSG_NOSIGNAL) > 0;
+
+    // 首个心跳晚一个周期发出，避免与摄像头列表合并在客户端的同一次recv中
+    auto next_heartbeat = std::chrono::steady_clock::now() + config_.heartbeat_interval;
+    std::string pending;
+    char buffer[4096];
+    while (alive && running_) {
+        pollfd pfd{fd, POLLIN, 0};
+        if (poll(&pfd, 1, POLL_TIMEOUT_MS) > 0) {
+            const ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+            if (n <= 0) break;
+            pending.append(buffer, static_cast<size_t>(n));
+        }
+
+        size_t end;
+        while ((end = pending.find('\n')) != std::string::npos) {
+            Json::Value message;
+            const bool parsed = Json::Reader().parse(pending.substr(0, end), message);
+            pending.erase(0, end + 1);
+            if (!parsed || !message.isObject()) continue;
+
+            if (message["request"].asString() == "keyframe") {
+                auto it = senders.find(message["video_port"].asInt());
+                if (it != senders.end()) it->second->forceKeyframe();
+            } else if (message.isMember("video_port") && !message.isMember("status")) {
+                // 选择消息：新格式带streams数组，旧格式只有一路
+                senders.clear();
+                Json::Value streams = message["streams"];
+                if (!message.isMember("streams")) streams.append(message);
+                for (const auto& entry : streams) {
+                    auto sender = std::make_unique<TestStreamSender>();
+                    if (sender->start(ip, entry, message, config_)) {
+                        senders[entry["video_port"].asInt()] = std::move(sender);
+                    }
+                }
+            }
+        }
+
+        if (std::chrono::steady_clock::now() >= next_heartbeat) {
+            static const char HEARTBEAT[] = "HEARTBEAT";
+            alive = send(fd, HEARTBEAT, sizeof(HEARTBEAT) - 1, MSG_NOSIGNAL) > 0;
+            next_heartbeat += config_.heartbeat_interval;
+        }
+    }
+
+    senders.clear();
+    std::cout << config_.name << ": 客户端" << ip << "已断开" << std::endl;
+    std::lock_guard<std::mutex> lock(clients_mutex_);
+    client_fds_.erase(std::remove(client_fds_.begin(), client_fds_.end(), fd), client_fds_.end());
+    finished_clients_.push_back(std::this_thread::get_id());
+    close(fd);
+}
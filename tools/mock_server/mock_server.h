@@ -0,0 +1,92 @@
+/*
+file: tools/mock_server/mock_server.h
+date: 2026/10/16
+*/
+#ifndef MOCK_SERVER_H
+#define MOCK_SERVER_H
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gst/gst.h>
+#include <json/json.h>
+
+// 模拟服务器参数
+struct MockServerConfig {
+    std::string name = "mock-server";
+    std::string discovery_host = "127.0.0.1";  // 发现广播目标，局域网测试时用255.255.255.255
+    int discovery_port = 37020;
+    int probe_port = 37021;        // 接收客户端发现探测的端口（同机多台服务器共用，单播探测只有一台收到）
+    int heartbeat_port = 8000;     // TCP控制端口（即发现消息中的heartbeat_port）
+    int rtcp_base_port = 9000;     // 接收客户端RTCP的端口：rtcp_base_port + 摄像头序号
+    int camera_count = 2;
+    int width = 1280;
+    int height = 720;
+    int fps = 30;
+    int bitrate_kbps = 2000;
+    std::chrono::milliseconds discovery_interval{1000};
+    std::chrono::milliseconds heartbeat_interval{1000};
+};
+
+// 一路测试码流：videotestsrc ! x264enc ! rtph264pay [! rtprtxsend] -> rtpbin -> udpsink
+// rtpbin处理客户端的接收报告、NACK（经rtprtxsend重传）和PLI（转为编码器的强制关键帧）
+class TestStreamSender {
+public:
+    TestStreamSender() = default;
+    ~TestStreamSender();
+
+    TestStreamSender(const TestStreamSender&) = delete;
+    TestStreamSender& operator=(const TestStreamSender&) = delete;
+
+    // entry为选择消息中的一路（camera_index/video_port/rtcp_port/rtx_payload_type），request为整条选择消息
+    bool start(const std::string& host, const Json::Value& entry, const Json::Value& request,
+               const MockServerConfig& config);
+    void stop();
+
+    // 控制通道上的关键帧请求
+    void forceKeyframe();
+
+private:
+    GstElement* pipeline_ = nullptr;
+    GstElement* encoder_ = nullptr;
+};
+
+// 模拟摄像头服务器
+// 定期向discovery_port发送发现消息，收到客户端的发现探测时立即向其应答；客户端连接控制端口后发送摄像头列表并定期发送心跳，
+// 按客户端的选择消息向其各路端口推送RTP测试码流，响应关键帧请求。每个客户端连接一个线程，断开后由接受线程join。
+class MockServer {
+public:
+    explicit MockServer(const MockServerConfig& config);
+    ~MockServer();
+
+    MockServer(const MockServer&) = delete;
+    MockServer& operator=(const MockServer&) = delete;
+
+    bool start();
+    void stop();
+
+private:
+    void discoveryLoop();
+    void acceptLoop();
+    void serveClient(int fd, const std::string& ip);
+    void reapClients();
+    std::string cameraList() const;
+
+    MockServerConfig config_;
+    std::atomic<bool> running_{false};
+    int listen_fd_ = -1;
+    std::thread discovery_thread_;
+    std::thread accept_thread_;
+
+    std::mutex clients_mutex_;             // 保护以下成员
+    std::vector<std::thread> client_threads_;
+    std::vector<std::thread::id> finished_clients_;  // 已退出、待join的客户端线程
+    std::vector<int> client_fds_;
+};
+
+#endif // MOCK_SERVER_H